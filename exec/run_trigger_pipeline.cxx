@@ -0,0 +1,125 @@
+/**
+ * @file run_trigger_pipeline.cxx
+ *
+ * Runs a TP → TA → TC → TD chain on TriggerPipeline, fed with fake TPs (noise
+ * plus tracks), and reports the rates reached. The TDs are dumped in a csv.
+ *
+ * Usage: run_trigger_pipeline [config.json] [n_seconds] [block_size]
+ *
+ * The json holds the TriggerPipeline configuration; without it the
+ * ADCSimpleWindow TA and TC makers are used. The TPs are pushed as fast as
+ * the pipeline takes them, so the rates are the pipeline's throughput.
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/TriggerPipeline.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace triggeralgs;
+
+namespace {
+
+// Blocks of TPs, in time order: noise over 2560 channels, with a track
+// crossing 100 adjacent channels now and then.
+class TPSource
+{
+public:
+  void fill(std::vector<TriggerPrimitive>& tps, size_t n_tps)
+  {
+    tps.clear();
+    while (tps.size() < n_tps) {
+      m_time += 1 + m_rng() % 4;
+      TriggerPrimitive tp;
+      tp.type = TriggerPrimitive::Type::kTPC;
+      tp.algorithm = TriggerPrimitive::Algorithm::kSimpleThreshold;
+      tp.time_start = m_time;
+      tp.time_over_threshold = 32 * (1 + m_rng() % 20);
+      tp.time_peak = m_time + tp.time_over_threshold / 2;
+      tp.adc_integral = 20 + m_rng() % 400;
+      tp.adc_peak = tp.adc_integral / 4;
+      if (m_rng() % 10000 == 0) {
+        channel_t first = m_rng() % 2400;
+        for (channel_t idx = 0; idx < 100; ++idx) {
+          tp.channel = first + idx;
+          tp.adc_integral = 2000;
+          tps.push_back(tp);
+        }
+      } else {
+        tp.channel = m_rng() % 2560;
+        tps.push_back(tp);
+      }
+    }
+  }
+
+private:
+  std::mt19937 m_rng{ 1234 };
+  timestamp_t m_time = 1'000'000;
+};
+
+void
+dump(std::ofstream& file_out, const std::vector<TriggerDecision>& tds)
+{
+  for (const TriggerDecision& td : tds) {
+    file_out << td.time_start << "," << td.time_end << "," << td.time_trigger << "," << td.tc_list.size() << "\n";
+  }
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  nlohmann::json config = { { "ta_algorithm", "TAMakerADCSimpleWindowAlgorithm" },
+                            { "tc_algorithm", "TCMakerADCSimpleWindowAlgorithm" },
+                            { "ta_config", { { "window_length", 10000 }, { "adc_threshold", 300000 } } } };
+  if (argc > 1) {
+    std::ifstream config_file(argv[1]);
+    config = nlohmann::json::parse(config_file);
+  }
+  int n_seconds = argc > 2 ? std::atoi(argv[2]) : 2;
+  size_t block_size = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1024;
+
+  TriggerPipeline pipeline;
+  pipeline.configure(config);
+
+  std::ofstream file_out("decision_dump.csv");
+  file_out << "tstart,tend,ttrigger,n_tcs\n";
+
+  TPSource source;
+  std::vector<TriggerPrimitive> tps;
+  std::vector<TriggerDecision> tds;
+
+  auto start_time = std::chrono::steady_clock::now();
+  auto end_time = start_time + std::chrono::seconds(n_seconds);
+  while (std::chrono::steady_clock::now() < end_time) {
+    source.fill(tps, block_size);
+    pipeline.push(tps);
+    pipeline.drain(tds);
+    dump(file_out, tds);
+    tds.clear();
+  }
+  pipeline.stop(tds);
+  dump(file_out, tds);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+
+  auto stats = pipeline.stats();
+  TLOG() << "TPs: " << stats.n_tps << ", TAs: " << stats.n_tas << ", TCs: " << stats.n_tcs << ", TDs: " << stats.n_tds;
+  TLOG() << "Average TP rate: " << stats.n_tps / elapsed.count() * 1e-6 << " MHz";
+  TLOG() << "Input queue full " << stats.n_input_full << " times, stage queues full " << stats.n_stage_full << " times";
+  TLOG() << "Overloaded " << stats.shedding.n_overloads << " times, shed " << stats.shedding.n_tps_dropped
+         << " TPs in dropped batches, " << stats.shedding.n_tps_below_floor << " TPs under the floor and "
+         << stats.shedding.n_tps_in_shed_slices << " TPs in " << stats.shedding.n_slices_shed << " time slices";
+
+  return 0;
+}
@@ -19,11 +19,13 @@ class TAMakerBundleNAlgorithm : public TriggerActivityMaker
 {
   public:
     void process(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_tas);
+    void flush(timestamp_t until, std::vector<TriggerActivity>& output_tas) override;
     void configure(const nlohmann::json& config);
     bool bundle_condition();
 
   private:
       uint64_t m_bundle_size = 1;
+      bool m_flush_partial_bundles = false; // flush() sends out a partial bundle
       TriggerActivity m_current_ta;
       void set_ta_attributes();
 };
@@ -19,6 +19,7 @@ class TCMakerBundleNAlgorithm: public TriggerCandidateMaker
 {
   public:
     void process(const TriggerActivity& input_ta, std::vector<TriggerCandidate>& output_tcs);
+    void process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& output_tcs) override;
     void configure(const nlohmann::json& config);
     bool bundle_condition();
 
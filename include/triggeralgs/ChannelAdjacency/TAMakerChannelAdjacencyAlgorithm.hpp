@@ -19,14 +19,21 @@ class TAMakerChannelAdjacencyAlgorithm : public TriggerActivityMaker
 {
 public:
   void process(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta);
+  void flush(timestamp_t until, std::vector<TriggerActivity>& output_ta) override;
   void configure(const nlohmann::json& config);
 
 private:
-  TriggerActivity construct_ta(TPWindow) const;
+  TriggerActivity construct_ta(TPWindow&);
+
+  // Makes a TA from every track in the (complete) current window, returns
+  // whether any was found. The window is left as it was if none was.
+  bool extract_tracks(std::vector<TriggerActivity>& output_ta);
 
   TPWindow check_adjacency();
 
   TPWindow m_current_window;
+  // The window being rebuilt by extract_tracks(), swapped with the current one
+  TPWindow m_previous_window;
 
   // Configurable parameters.
   bool m_print_tp_info = false;        // Prints out some information on every TP received
@@ -22,11 +22,16 @@ class TCMakerChannelAdjacencyAlgorithm : public TriggerCandidateMaker
 public:
   // The function that gets called when there is a new activity
   void process(const TriggerActivity&, std::vector<TriggerCandidate>&);
+  void process(TriggerActivity&&, std::vector<TriggerCandidate>&) override;
+  void process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& output_tc) override;
+  void flush(timestamp_t until, std::vector<TriggerCandidate>& output_tc) override;
   void configure(const nlohmann::json& config);
 
 private:
+  template<class Activity>
+  void process_activity(Activity&& activity, std::vector<TriggerCandidate>& output_tc);
 
-  TriggerCandidate construct_tc() const;
+  TriggerCandidate construct_tc();
 
   TAWindow m_current_window;
   uint64_t m_activity_count = 0; // NOLINT(build/unsigned)
@@ -9,6 +9,8 @@
 #ifndef TRIGGERALGS_CHANNELDISTANCE_TRIGGERACTIVITYMAKERCHANNELDISTANCE_HPP_
 #define TRIGGERALGS_CHANNELDISTANCE_TRIGGERACTIVITYMAKERCHANNELDISTANCE_HPP_
 
+#include "triggeralgs/SlicedTriggerActivity.hpp"
+#include "triggeralgs/TPArena.hpp"
 #include "triggeralgs/TriggerActivityFactory.hpp"
 #include <algorithm>
 
@@ -17,12 +19,36 @@ namespace triggeralgs {
 class TAMakerChannelDistanceAlgorithm : public TriggerActivityMaker {
   public:
     void process(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_tas);
+    void process_accepted(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_tas) override;
+    void flush(timestamp_t until, std::vector<TriggerActivity>& output_tas) override;
     void configure(const nlohmann::json& config);
     void set_ta_attributes();
 
+    /**
+     * @brief Same as process_batch(), making SlicedTriggerActivity objects
+     *
+     * The window appends its TPs straight into the maker's TPArena and each TA
+     * gets the slice of them, so the TPs are copied once and copies of a TA
+     * share them. A maker is run through either this path or the
+     * TriggerActivity one, not both. The TAs go through the configured
+     * post-processing stages.
+     */
+    void process_batch_sliced(span<const TriggerPrimitive> input_tps,
+                              std::vector<SlicedTriggerActivity>& output_tas);
+    /// @brief Same as flush(), for the process_batch_sliced() path
+    void flush_sliced(timestamp_t until, std::vector<SlicedTriggerActivity>& output_tas);
+
+    const TPArena& tp_arena() const { return m_tp_arena; }
+
   private:
-    void set_new_ta(const TriggerPrimitive& input_tp);
+    // What a TP does to the window holding window_tps. Shared by both paths.
+    enum class Step { kStart, kClose, kSkip, kAdd };
+    Step step(const TriggerPrimitive& input_tp, span<const TriggerPrimitive> window_tps);
+    void set_ta_attributes(dunedaq::trgdataformats::TriggerActivityData& ta, span<const TriggerPrimitive> tps) const;
+    void close_sliced(std::vector<SlicedTriggerActivity>& output_tas);
+
     TriggerActivity m_current_ta;
+    TPArena m_tp_arena;
     uint32_t m_max_channel_distance = 50;
     uint64_t m_window_length = 8000;
     uint16_t m_min_tps = 20; // AEO: Type is arbitrary. Surprised even asking for 2^8 TPs.
@@ -17,6 +17,7 @@ namespace triggeralgs {
 class TCMakerChannelDistanceAlgorithm : public TriggerCandidateMaker {
   public:
     void process(const TriggerActivity& input_ta, std::vector<TriggerCandidate>& output_tcs);
+    void process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& output_tcs) override;
     void configure(const nlohmann::json& config);
     void set_tc_attributes();
 
@@ -0,0 +1,154 @@
+/**
+ * @file ChannelOccupancy.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_CHANNELOCCUPANCY_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_CHANNELOCCUPANCY_HPP_
+
+#include "triggeralgs/Types.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Hit count per channel of a window, and the number of channels hit
+ *
+ * The counts are kept in a flat array over a contiguous channel range, so
+ * adding or removing a hit is an index and an increment, and
+ * n_channels_hit() is a counter. The range is set up front with
+ * set_range(), eg from the "n_channels" of the maker's configuration;
+ * a channel outside it grows the range to cover it, so once every channel
+ * seen is covered no more memory is allocated.
+ */
+class ChannelOccupancy
+{
+public:
+  ChannelOccupancy() = default;
+  ChannelOccupancy(const ChannelOccupancy&) = default;
+  ChannelOccupancy& operator=(const ChannelOccupancy&) = default;
+  // A moved-from occupancy is left with no range and no hits
+  ChannelOccupancy(ChannelOccupancy&& other) noexcept
+    : m_first_channel(other.m_first_channel)
+    , m_counts(std::move(other.m_counts))
+    , m_n_channels_hit(std::exchange(other.m_n_channels_hit, 0))
+  {
+    other.m_counts.clear();
+  }
+  ChannelOccupancy& operator=(ChannelOccupancy&& other) noexcept
+  {
+    m_first_channel = other.m_first_channel;
+    m_counts = std::move(other.m_counts);
+    m_n_channels_hit = std::exchange(other.m_n_channels_hit, 0);
+    other.m_counts.clear();
+    return *this;
+  }
+
+  /// @brief Cover channels [first_channel, first_channel + n_channels), keeping the counts
+  void set_range(channel_t first_channel, uint32_t n_channels)
+  {
+    if (n_channels == 0) {
+      return;
+    }
+    if (m_counts.empty()) {
+      m_first_channel = first_channel;
+      m_counts.assign(n_channels, 0);
+      return;
+    }
+    grow(first_channel);
+    grow(first_channel + static_cast<channel_t>(n_channels) - 1);
+  }
+
+  /// @brief Add n_hits (at least 1) hits on channel
+  void add(channel_t channel, uint16_t n_hits = 1)
+  {
+    uint16_t& count = count_of(channel);
+    m_n_channels_hit += count == 0;
+    count += n_hits;
+  }
+
+  /// @brief Remove n_hits hits on channel, which must have been added
+  void remove(channel_t channel, uint16_t n_hits = 1)
+  {
+    uint16_t& count = m_counts[channel - m_first_channel];
+    count -= n_hits;
+    m_n_channels_hit -= count == 0;
+  }
+
+  uint16_t count(channel_t channel) const
+  {
+    int64_t idx = static_cast<int64_t>(channel) - m_first_channel;
+    return idx >= 0 && idx < static_cast<int64_t>(m_counts.size()) ? m_counts[idx] : 0;
+  }
+
+  uint32_t n_channels_hit() const { return m_n_channels_hit; }
+
+  /**
+   * @brief Zero all the counts, keeping the range
+   *
+   * Goes over the whole range: a window that knows its hits clears them
+   * with remove() instead.
+   */
+  void clear()
+  {
+    if (m_n_channels_hit > 0) {
+      std::fill(m_counts.begin(), m_counts.end(), 0);
+      m_n_channels_hit = 0;
+    }
+  }
+
+  channel_t first_channel() const { return m_first_channel; }
+  uint32_t n_channels() const { return m_counts.size(); }
+
+private:
+  uint16_t& count_of(channel_t channel)
+  {
+    int64_t idx = static_cast<int64_t>(channel) - m_first_channel;
+    if (idx < 0 || idx >= static_cast<int64_t>(m_counts.size())) {
+      grow(channel);
+      idx = static_cast<int64_t>(channel) - m_first_channel;
+    }
+    return m_counts[idx];
+  }
+
+  // Extend the range to cover channel, with as much room again on that side
+  // so that channels walking out of the range only reallocate a few times.
+  void grow(channel_t channel)
+  {
+    if (m_counts.empty()) {
+      m_first_channel = channel;
+      m_counts.assign(min_growth, 0);
+      return;
+    }
+    int64_t first = m_first_channel;
+    int64_t last = first + static_cast<int64_t>(m_counts.size()) - 1;
+    if (channel >= first && channel <= last) {
+      return;
+    }
+    int64_t room = std::max<int64_t>(m_counts.size(), min_growth);
+    int64_t new_first = channel < first ? static_cast<int64_t>(channel) - room : first;
+    int64_t new_last = channel > last ? static_cast<int64_t>(channel) + room : last;
+
+    std::vector<uint16_t> counts(new_last - new_first + 1, 0);
+    std::copy(m_counts.begin(), m_counts.end(), counts.begin() + (first - new_first));
+    m_counts.swap(counts);
+    m_first_channel = static_cast<channel_t>(new_first);
+  }
+
+  static constexpr int64_t min_growth = 64;
+
+  channel_t m_first_channel = 0;
+  std::vector<uint16_t> m_counts;
+  uint32_t m_n_channels_hit = 0;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_CHANNELOCCUPANCY_HPP_
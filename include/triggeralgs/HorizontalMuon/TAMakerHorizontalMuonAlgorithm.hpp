@@ -19,13 +19,20 @@ class TAMakerHorizontalMuonAlgorithm : public TriggerActivityMaker
 {
 public:
   void process(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta);
+  void process_accepted(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta) override;
+  void flush(timestamp_t until, std::vector<TriggerActivity>& output_ta) override;
   void configure(const nlohmann::json& config);
 
 private:
-  TriggerActivity construct_ta() const;
+  // The window also keeps its TPs in columns, which check_adjacency() scans
+  // on every TP and construct_ta() reduces.
+  using Window =
+    SlidingWindow<TriggerPrimitive, window_stats::ADCSum, window_stats::ChannelCounts, window_stats::Columns>;
+
+  TriggerActivity construct_ta();
   uint16_t check_adjacency() const; // Returns longest string of adjacent collection hits in window
 
-  TPWindow m_current_window; // Holds collection hits only
+  Window m_current_window; // Holds collection hits only
   int check_tot() const;
 
   // Configurable parameters.
@@ -46,10 +53,10 @@ private:
   timestamp_t m_window_length = 8000; // Shouldn't exceed the max drift which is ~9375 62.5 MHz ticks for VDCB
 
   // For debugging and performance study purposes.
-  void add_window_to_record(TPWindow window);
+  void add_window_to_record(Window window);
   void dump_window_record();
   void dump_tp(TriggerPrimitive const& input_tp);
-  std::vector<TPWindow> m_window_record;
+  std::vector<Window> m_window_record;
 };
 } // namespace triggeralgs
 #endif // TRIGGERALGS_HORIZONTALMUON_TRIGGERACTIVITYMAKERHORIZONTALMUON_HPP_
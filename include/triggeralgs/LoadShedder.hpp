@@ -0,0 +1,137 @@
+/**
+ * @file LoadShedder.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_LOADSHEDDER_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_LOADSHEDDER_HPP_
+
+#include "triggeralgs/TriggerActivityMaker.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Overload policies for the input of a TA maker running behind
+ *
+ * The input of the maker is overloaded once its queue holds
+ * "max_queue_depth" batches, or a batch waited "max_latency_us"
+ * microseconds in it (a threshold of 0 is disabled). It stops being
+ * overloaded once both are back to half their threshold, so the policies
+ * do not flap on and off with every batch.
+ *
+ * While overloaded, the "policies" configured apply:
+ *  - "drop_newest": admit() refuses the batches pushed, leaving the ones
+ *    already queued to be processed
+ *  - "adc_floor": shed() drops the TPs under "min_adc_integral" or
+ *    "min_time_over_threshold"
+ *  - "degrade": the maker is put in its degraded mode, see
+ *    TriggerActivityMaker::set_degraded()
+ *  - "shed_slices": shed() drops whole time slices of "slice_length"
+ *    ticks: a slice starting while overloaded is dropped to its end
+ *
+ * admit() is called by the thread pushing the batches, update() and
+ * shed() by the thread running the maker. Every TP and batch shed is
+ * counted by policy in stats().
+ */
+class LoadShedder
+{
+public:
+  void configure(const nlohmann::json& config);
+
+  /// @return true if a policy and a threshold are configured
+  bool enabled() const { return m_policies != 0 && (m_max_queue_depth > 0 || m_max_latency_us > 0); }
+
+  /**
+   * @brief Whether to queue a batch of n_tps TPs, for the "drop_newest" policy
+   *
+   * @param queue_depth[in] Batches already in the queue
+   * @return false if the batch is to be dropped
+   */
+  bool admit(size_t n_tps, size_t queue_depth);
+
+  /**
+   * @brief Update the overload state with the input queue as a batch is taken
+   *
+   * Switches the maker in or out of its degraded mode with the state.
+   *
+   * @param queue_depth[in] Batches still in the queue
+   * @param latency[in] Time the batch taken waited in the queue
+   * @param maker[in,out] Maker the queue feeds
+   */
+  void update(size_t queue_depth, std::chrono::microseconds latency, TriggerActivityMaker& maker);
+
+  /**
+   * @brief Drop the TPs of a batch shed by the "adc_floor" and "shed_slices" policies
+   *
+   * @param input_tps[in,out] Batch of TPs, time ordered, filtered in place
+   */
+  void shed(std::vector<TriggerPrimitive>& input_tps);
+
+  bool overloaded() const { return m_overloaded.load(std::memory_order_relaxed); }
+
+  /// @brief Counts of what was shed, by policy
+  struct Stats
+  {
+    /// Times the input became overloaded
+    uint64_t n_overloads = 0;
+    /// Batches, and their TPs, refused by admit()
+    uint64_t n_batches_dropped = 0;
+    uint64_t n_tps_dropped = 0;
+    /// TPs under the ADC or ToT floor
+    uint64_t n_tps_below_floor = 0;
+    /// Time slices shed, and the TPs in them
+    uint64_t n_slices_shed = 0;
+    uint64_t n_tps_in_shed_slices = 0;
+    /// Batches processed by the maker in its degraded mode
+    uint64_t n_degraded_batches = 0;
+  };
+
+  Stats stats() const;
+
+private:
+  enum Policy : uint32_t
+  {
+    kDropNewest = 1 << 0,
+    kADCFloor = 1 << 1,
+    kDegrade = 1 << 2,
+    kShedSlices = 1 << 3
+  };
+
+  bool has(Policy policy) const { return (m_policies & policy) != 0; }
+
+  uint32_t m_policies = 0;
+  size_t m_max_queue_depth = 0;
+  uint64_t m_max_latency_us = 0;
+  uint32_t m_min_adc_integral = 0;
+  uint32_t m_min_time_over_threshold = 0;
+  timestamp_t m_slice_length = 62500;
+
+  // Set by the maker's thread, read by admit()
+  std::atomic<bool> m_overloaded = false;
+  // Slice of the last TP seen by shed(), and whether it is shed
+  timestamp_t m_current_slice = 0;
+  bool m_shedding_slice = false;
+
+  std::atomic<uint64_t> m_n_overloads = 0;
+  std::atomic<uint64_t> m_n_batches_dropped = 0;
+  std::atomic<uint64_t> m_n_tps_dropped = 0;
+  std::atomic<uint64_t> m_n_tps_below_floor = 0;
+  std::atomic<uint64_t> m_n_slices_shed = 0;
+  std::atomic<uint64_t> m_n_tps_in_shed_slices = 0;
+  std::atomic<uint64_t> m_n_degraded_batches = 0;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_LOADSHEDDER_HPP_
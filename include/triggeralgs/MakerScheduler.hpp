@@ -0,0 +1,275 @@
+/**
+ * @file MakerScheduler.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_MAKERSCHEDULER_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_MAKERSCHEDULER_HPP_
+
+#include "triggeralgs/OutputSink.hpp"
+#include "triggeralgs/SPSCQueue.hpp"
+#include "triggeralgs/ThreadPlacement.hpp"
+#include "triggeralgs/TriggerActivityMaker.hpp"
+#include "triggeralgs/TriggerCandidateMaker.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Runs many TA and TC makers on a fixed pool of worker threads
+ *
+ * Each maker added gets a mailbox, a bounded SPSCQueue of input batches,
+ * filled by submit(). A maker with work in its mailbox is scheduled, once,
+ * as a task on a worker's deque: a worker runs its own tasks newest first,
+ * and when it has none takes the tasks submitted from outside the pool,
+ * then steals the oldest task of another worker. A task runs up to
+ * "batch_budget" batches of its maker before going to the back of the line,
+ * so a maker hit by a burst does not hold a worker for long, and its
+ * backlog spreads to the idle workers.
+ *
+ * A maker is only ever run by one worker at a time, and the runs are
+ * ordered, so the algorithms need no locks. Its output goes to the
+ * OutputSink given with it, from whichever worker runs it: a QueueSink
+ * works, as the runs never overlap.
+ *
+ * The makers and sinks are not owned, and must outlive the scheduler. The
+ * batches of a maker are submitted from one thread. Every maker is added
+ * before start(), so the submitting threads read a fixed set of makers.
+ */
+class MakerScheduler
+{
+public:
+  using handle_t = size_t;
+
+  MakerScheduler() = default;
+  MakerScheduler(const MakerScheduler&) = delete;
+  MakerScheduler& operator=(const MakerScheduler&) = delete;
+  /// @brief Stops the workers; batches not yet run are dropped
+  ~MakerScheduler();
+
+  /**
+   * @brief Set the number of workers, "n_workers" (default one per core)
+   *
+   * Also sets the "mailbox_size" (batches, default 64) of the makers added
+   * after, and the "batch_budget" of a task (default 4). Stops the workers
+   * and drops the makers added before.
+   *
+   * The workers are named "maker-worker-<n>", and worker n is placed on
+   * CPUs and NUMA nodes with entry n (modulo the length) of the
+   * "placement" list, see ThreadPlacement. A worker places itself as it
+   * starts; the makers run by any worker, so their buffers grow on the
+   * node of whichever worker needs them first.
+   */
+  void configure(const nlohmann::json& config);
+
+  /**
+   * @brief Add a TA maker, emitting its TAs into sink
+   *
+   * Only before start(): throws BadConfiguration once the workers run.
+   */
+  handle_t add_maker(TriggerActivityMaker& maker, OutputSink<TriggerActivity>& sink);
+  /**
+   * @brief Add a TC maker, emitting its TCs into sink, only before start()
+   *
+   * @param ta_source[in] Maker the submitted TAs come from, if any: the TAs
+   * the TC maker is done with go back to its pool
+   */
+  handle_t add_maker(TriggerCandidateMaker& maker,
+                     OutputSink<TriggerCandidate>& sink,
+                     TriggerActivityMaker* ta_source = nullptr);
+
+  /// @brief Start the workers, once every maker is added
+  void start();
+
+  /**
+   * @brief Queue a batch of TPs for a TA maker, or TAs for a TC maker
+   *
+   * @return false if the maker's mailbox is full, in which case inputs is left untouched
+   */
+  bool submit(handle_t handle, std::vector<TriggerPrimitive>&& inputs);
+  bool submit(handle_t handle, std::vector<TriggerActivity>&& inputs);
+
+  /// @brief Queue a flush of the maker up to until, see TriggerActivityMaker::flush()
+  bool submit_flush(handle_t handle, timestamp_t until);
+
+  /// @brief Wait until every batch submitted so far has been run
+  void wait();
+
+  size_t n_workers() const { return m_n_workers; }
+  size_t n_makers() const { return m_tasks.size(); }
+
+  /// @brief Counts of the work done by the pool
+  struct Stats
+  {
+    /// Batches run
+    uint64_t n_batches = 0;
+    /// Times a task was taken by a worker
+    uint64_t n_runs = 0;
+    /// Runs of a task stolen from another worker's deque
+    uint64_t n_steals = 0;
+    /// Batches refused because the mailbox was full
+    uint64_t n_mailbox_full = 0;
+  };
+
+  Stats stats() const;
+
+private:
+  // A maker with its mailbox, scheduled on the workers when it has work
+  class Task
+  {
+  public:
+    virtual ~Task() = default;
+    // Run up to budget batches, returning the number run
+    virtual size_t run(size_t budget) = 0;
+    virtual bool has_work() const = 0;
+    // Queue a flush, false if the mailbox is full
+    virtual bool push_flush(timestamp_t until) = 0;
+
+    // Set while the task is on a deque or running
+    std::atomic<bool> scheduled = false;
+  };
+
+  template<class Maker, class Input, class Output>
+  class MakerTask : public Task
+  {
+  public:
+    struct Batch
+    {
+      std::vector<Input> inputs;
+      timestamp_t until = 0;
+      bool flush = false;
+    };
+
+    MakerTask(Maker& maker, OutputSink<Output>& sink, size_t mailbox_size, TriggerActivityMaker* ta_source = nullptr)
+      : mailbox(mailbox_size)
+      , m_maker(maker)
+      , m_sink(sink)
+      , m_ta_source(ta_source)
+    {}
+
+    size_t run(size_t budget) override
+    {
+      size_t n_run = 0;
+      while (n_run < budget && mailbox.try_pop(m_batch)) {
+        if (!m_batch.inputs.empty()) {
+          process_inputs();
+        }
+        if (m_batch.flush) {
+          m_maker.flush(m_batch.until, m_staging);
+          m_maker.emit_output(m_staging, m_sink);
+        }
+        ++n_run;
+      }
+      return n_run;
+    }
+
+    bool has_work() const override { return !mailbox.empty(); }
+
+    bool push_flush(timestamp_t until) override
+    {
+      Batch batch;
+      batch.until = until;
+      batch.flush = true;
+      return mailbox.try_push(std::move(batch));
+    }
+
+    SPSCQueue<Batch> mailbox;
+
+  private:
+    // A TC maker takes over the TAs of the batch, which the task owns: the
+    // windowed makers move them in rather than copying them and their TPs.
+    // What the maker leaves of them goes back to the TA maker they came from.
+    void process_inputs()
+    {
+      if constexpr (std::is_same_v<Input, TriggerActivity>) {
+        for (TriggerActivity& ta : m_batch.inputs) {
+          m_maker(std::move(ta), m_sink);
+          if (m_ta_source != nullptr && ta.inputs.capacity() > 0) {
+            m_ta_source->recycle_from_any_thread(std::move(ta));
+          }
+        }
+      } else {
+        m_maker.process_batch_to(m_batch.inputs, m_sink);
+      }
+    }
+
+    Maker& m_maker;
+    OutputSink<Output>& m_sink;
+    TriggerActivityMaker* m_ta_source;
+    Batch m_batch;
+    std::vector<Output> m_staging;
+  };
+
+  using TATask = MakerTask<TriggerActivityMaker, TriggerPrimitive, TriggerActivity>;
+  using TCTask = MakerTask<TriggerCandidateMaker, TriggerActivity, TriggerCandidate>;
+
+  struct Worker
+  {
+    std::mutex mutex;
+    std::deque<Task*> tasks;
+    std::thread thread;
+    std::atomic<uint64_t> n_runs = 0;
+    std::atomic<uint64_t> n_steals = 0;
+  };
+
+  handle_t add_task(std::unique_ptr<Task> task);
+  // Queue a batch in the task's mailbox and schedule the task if it is idle
+  template<class TaskType, class Input>
+  bool submit_batch(handle_t handle, std::vector<Input>&& inputs);
+  // Count the batch queued and schedule the task if it is idle
+  void activate(Task* task);
+
+  void run_worker(size_t worker_idx);
+  // Put a task on a deque: the running worker's own, else the shared one
+  void schedule(Task* task, bool at_front = false);
+  Task* pop_own(Worker& worker);
+  Task* pop_shared();
+  Task* steal(size_t thief_idx);
+  void run_task(Task* task);
+  void stop_workers();
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  // One per worker, read by the worker as it starts
+  std::vector<ThreadPlacement> m_placements;
+  // Fixed once the workers start, so read by the submitters without a lock
+  std::vector<std::unique_ptr<Task>> m_tasks;
+
+  // Tasks scheduled from outside the pool
+  std::mutex m_shared_mutex;
+  std::deque<Task*> m_shared_tasks;
+
+  // Idle workers sleep until a task is scheduled
+  std::mutex m_sleep_mutex;
+  std::condition_variable m_wake;
+  std::atomic<size_t> m_n_queued = 0;
+  std::atomic<size_t> m_n_sleeping = 0;
+  std::atomic<bool> m_stop = false;
+
+  // Batches submitted and not yet run
+  std::atomic<uint64_t> m_n_pending = 0;
+  std::atomic<uint64_t> m_n_batches = 0;
+  // Counted by any submitting thread
+  std::atomic<uint64_t> m_n_mailbox_full = 0;
+
+  size_t m_n_workers = 1;
+  size_t m_mailbox_size = 64;
+  size_t m_batch_budget = 4;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_MAKERSCHEDULER_HPP_
@@ -0,0 +1,153 @@
+/**
+ * @file ObjectPool.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_OBJECTPOOL_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_OBJECTPOOL_HPP_
+
+#include "triggeralgs/TriggerActivity.hpp"
+#include "triggeralgs/TriggerCandidate.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Recycling pool for trigger objects (TriggerActivity, TriggerCandidate)
+ *
+ * A maker draws the objects it emits from its pool with acquire(), and the
+ * objects come back, with the capacity of their inputs vector, once they are
+ * no longer needed:
+ *  - release() from the thread running the maker goes straight to the
+ *    maker's freelist,
+ *  - release_from_any_thread() is for consumers on other threads. Objects
+ *    are queued under a lock and moved to the freelist in one go when the
+ *    freelist runs dry.
+ *
+ * Objects come out of acquire() with default trigger data and empty inputs.
+ * acquire_inputs() hands out just the inputs vector of a spare object, for
+ * a maker that needs a buffer rather than an object.
+ */
+template<class Object>
+class ObjectPool
+{
+public:
+  using inputs_t = decltype(Object::inputs);
+
+  /// @return an object to fill, recycled if possible
+  Object acquire()
+  {
+    if (m_free.empty() && m_n_returned.load(std::memory_order_relaxed) > 0) {
+      collect_returned();
+    }
+    if (m_free.empty()) {
+      m_n_misses.fetch_add(1, std::memory_order_relaxed);
+      return Object();
+    }
+    m_n_hits.fetch_add(1, std::memory_order_relaxed);
+    Object object = std::move(m_free.back());
+    m_free.pop_back();
+    return object;
+  }
+
+  /**
+   * @brief Take the inputs vector of a spare object, which is dropped
+   *
+   * Not counted in n_hits() or n_misses(), which only count the objects
+   * handed out.
+   *
+   * @return an empty vector, with the capacity of a recycled one if there is any
+   */
+  inputs_t acquire_inputs()
+  {
+    if (m_free.empty() && m_n_returned.load(std::memory_order_relaxed) > 0) {
+      collect_returned();
+    }
+    if (m_free.empty()) {
+      return inputs_t();
+    }
+    inputs_t inputs = std::move(m_free.back().inputs);
+    m_free.pop_back();
+    return inputs;
+  }
+
+  /// Give back an object, from the thread running the maker
+  void release(Object&& object)
+  {
+    if (m_free.size() >= m_max_free) {
+      return;
+    }
+    m_free.push_back(std::move(object));
+    reset(m_free.back());
+  }
+
+  /// Give back an object, from any thread
+  void release_from_any_thread(Object&& object)
+  {
+    std::lock_guard<std::mutex> lock(m_returned_mutex);
+    if (m_returned.size() >= m_max_free) {
+      return;
+    }
+    m_returned.push_back(std::move(object));
+    m_n_returned.store(m_returned.size(), std::memory_order_relaxed);
+  }
+
+  /// Maximum number of spare objects kept on each of the two return paths
+  void set_max_free(size_t max_free) { m_max_free = max_free; }
+
+  size_t n_free() const { return m_free.size(); }
+  /// Number of acquire() calls served by a recycled object
+  uint64_t n_hits() const { return m_n_hits.load(std::memory_order_relaxed); }
+  /// Number of acquire() calls that had to make a new object
+  uint64_t n_misses() const { return m_n_misses.load(std::memory_order_relaxed); }
+
+private:
+  static void reset(TriggerActivity& ta)
+  {
+    static_cast<dunedaq::trgdataformats::TriggerActivityData&>(ta) = dunedaq::trgdataformats::TriggerActivityData();
+    ta.inputs.clear();
+  }
+  static void reset(TriggerCandidate& tc)
+  {
+    static_cast<dunedaq::trgdataformats::TriggerCandidateData&>(tc) = dunedaq::trgdataformats::TriggerCandidateData();
+    tc.inputs.clear();
+  }
+
+  void collect_returned()
+  {
+    std::vector<Object> returned;
+    {
+      std::lock_guard<std::mutex> lock(m_returned_mutex);
+      returned.swap(m_returned);
+      m_n_returned.store(0, std::memory_order_relaxed);
+    }
+    for (Object& object : returned) {
+      reset(object);
+      m_free.push_back(std::move(object));
+    }
+  }
+
+  size_t m_max_free = 256;
+
+  /// Only touched by the thread running the maker
+  std::vector<Object> m_free;
+
+  std::mutex m_returned_mutex;
+  std::vector<Object> m_returned;
+  std::atomic<size_t> m_n_returned = 0;
+
+  std::atomic<uint64_t> m_n_hits = 0;
+  std::atomic<uint64_t> m_n_misses = 0;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_OBJECTPOOL_HPP_
@@ -0,0 +1,141 @@
+/**
+ * @file OutputSink.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_OUTPUTSINK_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_OUTPUTSINK_HPP_
+
+#include "triggeralgs/SPSCQueue.hpp"
+#include "triggeralgs/TriggerObjectOverlay.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Destination for the TAs/TCs made by a maker
+ *
+ * Makers hand each object they output to emit() as soon as it has passed
+ * postprocessing, so it goes straight to the next stage instead of waiting
+ * in a vector for the caller to drain.
+ *
+ * @tparam Object TriggerActivity or TriggerCandidate
+ */
+template<class Object>
+class OutputSink
+{
+public:
+  virtual ~OutputSink() = default;
+
+  /**
+   * @brief Take an output object
+   *
+   * @return false if the sink cannot take it (eg it is full), in which case
+   * object is left untouched
+   */
+  virtual bool emit(Object&& object) = 0;
+};
+
+/**
+ * @brief Sink calling a function on each object
+ *
+ * @tparam Callback Callable as callback(Object&&), returning void or bool
+ */
+template<class Object, class Callback>
+class CallbackSink : public OutputSink<Object>
+{
+public:
+  explicit CallbackSink(Callback callback)
+    : m_callback(std::move(callback))
+  {}
+
+  bool emit(Object&& object) override
+  {
+    if constexpr (std::is_same_v<decltype(m_callback(std::move(object))), bool>) {
+      return m_callback(std::move(object));
+    } else {
+      m_callback(std::move(object));
+      return true;
+    }
+  }
+
+private:
+  Callback m_callback;
+};
+
+template<class Object, class Callback>
+CallbackSink<Object, Callback>
+make_callback_sink(Callback callback)
+{
+  return CallbackSink<Object, Callback>(std::move(callback));
+}
+
+/**
+ * @brief Sink pushing the objects onto a bounded lock-free SPSCQueue
+ *
+ * The maker is the producer; the next stage pops the objects from the queue
+ * on its own thread. emit() fails when the queue is full.
+ */
+template<class Object>
+class QueueSink : public OutputSink<Object>
+{
+public:
+  explicit QueueSink(SPSCQueue<Object>& queue)
+    : m_queue(queue)
+  {}
+
+  bool emit(Object&& object) override { return m_queue.try_push(std::move(object)); }
+
+private:
+  SPSCQueue<Object>& m_queue;
+};
+
+/**
+ * @brief Sink serialising the objects, in the overlay format, into one buffer
+ *
+ * The overlays are stored back to back, each starting on an 8-byte
+ * boundary, at the offsets given by offsets(). The buffer keeps its
+ * capacity across clear().
+ */
+template<class Object>
+class OverlaySink : public OutputSink<Object>
+{
+public:
+  bool emit(Object&& object) override
+  {
+    size_t offset = m_buffer.size();
+    size_t n_bytes = get_overlay_nbytes(object);
+    m_buffer.resize(offset + ((n_bytes + s_alignment - 1) & ~(s_alignment - 1)));
+    write_overlay(object, m_buffer.data() + offset);
+    m_offsets.push_back(offset);
+    return true;
+  }
+
+  const uint8_t* data() const { return m_buffer.data(); }
+  size_t size_bytes() const { return m_buffer.size(); }
+  size_t n_objects() const { return m_offsets.size(); }
+  const std::vector<size_t>& offsets() const { return m_offsets; }
+
+  void clear()
+  {
+    m_buffer.clear();
+    m_offsets.clear();
+  }
+
+private:
+  static constexpr size_t s_alignment = 8;
+
+  std::vector<uint8_t> m_buffer;
+  std::vector<size_t> m_offsets;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_OUTPUTSINK_HPP_
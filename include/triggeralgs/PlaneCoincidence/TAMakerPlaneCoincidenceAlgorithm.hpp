@@ -27,21 +27,28 @@ class TAMakerPlaneCoincidenceAlgorithm : public TriggerActivityMaker
 {
 public:
   void process(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta);
+  void flush(timestamp_t until, std::vector<TriggerActivity>& output_ta) override;
   void configure(const nlohmann::json& config);
 
 private:
-  TriggerActivity construct_ta(TPWindow m_current_window) const;
-  uint16_t check_adjacency(TPWindow window) const; // Returns longest string of adjacent collection hits in window
+  // The collection window also keeps the hit channels and the ToT sum recorded
+  // with it, the induction windows only need their ADC sum.
+  using CollectionWindow =
+    SlidingWindow<TriggerPrimitive, window_stats::ADCSum, window_stats::ChannelCounts, window_stats::ToTSum>;
+  using InductionWindow = SlidingWindow<TriggerPrimitive, window_stats::ADCSum>;
+
+  TriggerActivity construct_ta(CollectionWindow& m_current_window);
+  uint16_t check_adjacency(const CollectionWindow& window) const; // Returns longest string of adjacent collection hits in window
 
   TPWindow m_current_window;             // Possibly redundant for this alg?
   uint64_t m_primitive_count = 0;
-  int check_tot(TPWindow m_current_window) const;
+  int check_tot(const CollectionWindow& m_current_window) const;
   //void clearWindows(TriggerPrimitive const input_tp); // Function to clear or reset all windows, according to TP channel 
  
   // Make 3 instances of the Window class. One for each view plane.
-  TPWindow m_collection_window; // Z
-  TPWindow m_induction1_window; // U
-  TPWindow m_induction2_window; // Y
+  CollectionWindow m_collection_window; // Z
+  InductionWindow m_induction1_window;  // U
+  InductionWindow m_induction2_window;  // Y
 
   // Configurable parameters.
   std::string m_channel_map_name = "VDColdboxChannelMap";  // Default is coldbox
@@ -59,10 +66,10 @@ private:
   std::shared_ptr<dunedaq::detchannelmaps::TPCChannelMap> channelMap = dunedaq::detchannelmaps::make_map(m_channel_map_name);
 
   // For debugging and performance study purposes.
-  void add_window_to_record(TPWindow window);
+  void add_window_to_record(CollectionWindow window);
   void dump_window_record();
   void dump_tp(TriggerPrimitive const& input_tp);
-  std::vector<TPWindow> m_window_record;
+  std::vector<CollectionWindow> m_window_record;
 };
 } // namespace triggeralgs
 #endif // TRIGGERALGS_PLANECOINCIDENCE_TRIGGERACTIVITYMAKERPLANECOINCIDENCE_HPP_
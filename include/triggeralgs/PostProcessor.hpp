@@ -0,0 +1,149 @@
+/**
+ * @file PostProcessor.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_POSTPROCESSOR_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_POSTPROCESSOR_HPP_
+
+#include "triggeralgs/Issues.hpp"
+#include "triggeralgs/SlicedTriggerActivity.hpp"
+#include "triggeralgs/TriggerActivity.hpp"
+#include "triggeralgs/TriggerCandidate.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Post-processing stages applied to the TAs/TCs made by a maker
+ *
+ * Stages, in the order they are applied, with their configuration keys:
+ *  - minimum number of inputs (TPs of a TA, TAs of a TC): "output_min_inputs"
+ *  - ADC floor (for a TC, the sum over its TAs): "output_min_adc_integral"
+ *  - time-span ceiling, time_end - time_start: "output_max_time_span"
+ *  - prescale of the objects passing the stages above: "prescale"
+ *
+ * All stages are applied in one stable pass over the output vector, which
+ * moves each kept object at most once and erases the tail at the end.
+ *
+ * The stages also take the objects of the sliced paths, eg
+ * SlicedTriggerActivity for a TriggerActivity post-processor.
+ *
+ * @tparam Object TriggerActivity or TriggerCandidate
+ */
+template<class Object>
+class PostProcessor
+{
+public:
+  void configure(const nlohmann::json& config)
+  {
+    if (!config.is_object()) {
+      return;
+    }
+
+    if (config.contains("prescale"))
+      m_prescale = config["prescale"];
+    if (config.contains("output_min_inputs"))
+      m_min_inputs = config["output_min_inputs"];
+    if (config.contains("output_min_adc_integral"))
+      m_min_adc_integral = config["output_min_adc_integral"];
+    if (config.contains("output_max_time_span"))
+      m_max_time_span = config["output_max_time_span"];
+
+    if (m_prescale == 0)
+      throw BadConfiguration(ERS_HERE, "PostProcessor");
+  }
+
+  /// @return true if none of the stages can remove anything
+  bool is_pass_through() const
+  {
+    return m_prescale <= 1 && m_min_inputs == 0 && m_min_adc_integral == 0 &&
+           m_max_time_span == std::numeric_limits<timestamp_t>::max();
+  }
+
+  /// Apply the stages to the objects of output, keeping the survivors in order
+  template<class Output>
+  void operator()(std::vector<Output>& output)
+  {
+    (*this)(output, [](Output&&) {});
+  }
+
+  /**
+   * @brief Apply the stages, handing each rejected object to discard
+   *
+   * discard(Output&&) is called on the rejected objects before they are
+   * overwritten, eg to recycle their input buffers.
+   */
+  template<class Output, class Discard>
+  void operator()(std::vector<Output>& output, Discard&& discard)
+  {
+    if (output.empty() || is_pass_through()) {
+      return;
+    }
+
+    size_t n_kept = 0;
+    for (size_t idx = 0; idx < output.size(); ++idx) {
+      if (!keep(output[idx])) {
+        discard(std::move(output[idx]));
+        continue;
+      }
+      if (n_kept != idx) {
+        output[n_kept] = std::move(output[idx]);
+      }
+      ++n_kept;
+    }
+    output.erase(output.begin() + n_kept, output.end());
+  }
+
+  uint64_t prescale() const { return m_prescale; }
+  /// Number of objects that reached the prescale stage
+  uint64_t prescale_count() const { return m_count; }
+
+private:
+  static uint64_t adc_integral(const dunedaq::trgdataformats::TriggerActivityData& ta) { return ta.adc_integral; }
+  static uint64_t adc_integral(const TriggerCandidate& tc)
+  {
+    uint64_t sum = 0;
+    for (const auto& ta : tc.inputs)
+      sum += ta.adc_integral;
+    return sum;
+  }
+
+  template<class Output>
+  bool keep(const Output& object)
+  {
+    if (object.inputs.size() < m_min_inputs)
+      return false;
+    if (m_min_adc_integral != 0 && adc_integral(object) < m_min_adc_integral)
+      return false;
+    if (object.time_end > object.time_start && object.time_end - object.time_start > m_max_time_span)
+      return false;
+
+    // Keep every m_prescale-th of the objects that get this far
+    if (m_prescale > 1) {
+      ++m_count;
+      return m_count % m_prescale == 0;
+    }
+    return true;
+  }
+
+  uint64_t m_prescale = 1;
+  uint64_t m_count = 0;
+  size_t m_min_inputs = 0;
+  uint64_t m_min_adc_integral = 0;
+  timestamp_t m_max_time_span = std::numeric_limits<timestamp_t>::max();
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_POSTPROCESSOR_HPP_
@@ -0,0 +1,193 @@
+/**
+ * @file SPSCQueue.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_SPSCQUEUE_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_SPSCQUEUE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Bounded lock-free queue for one producer thread and one consumer thread
+ *
+ * The capacity is rounded up to a power of two. The slots are allocated up
+ * front and reused, so objects keep their own allocations (eg the inputs
+ * vector of a TA) as they are moved in and out.
+ *
+ * push() and pop() wait for room or for an object: after a short spin the
+ * waiting side sleeps on a condition variable until the other side's next
+ * push or pop, so an idle worker costs no CPU. The try_ forms never wait,
+ * and both forms can be mixed on either side.
+ */
+template<class T>
+class SPSCQueue
+{
+public:
+  explicit SPSCQueue(size_t capacity)
+    : m_slots(round_up(capacity))
+    , m_mask(m_slots.size() - 1)
+  {}
+
+  SPSCQueue(const SPSCQueue&) = delete;
+  SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+  /**
+   * @brief Add an object at the back, producer side only
+   *
+   * @return false if the queue is full, in which case object is left untouched
+   */
+  bool try_push(T&& object)
+  {
+    if (!push_slot(object)) {
+      return false;
+    }
+    wake(m_consumer_waiting);
+    return true;
+  }
+
+  /**
+   * @brief Take the object at the front, consumer side only
+   *
+   * @return false if the queue is empty
+   */
+  bool try_pop(T& object)
+  {
+    if (!pop_slot(object)) {
+      return false;
+    }
+    wake(m_producer_waiting);
+    return true;
+  }
+
+  /// @brief Same as try_push(), but sleeps until there is room
+  void push(T&& object)
+  {
+    wait(m_producer_waiting, [&] { return push_slot(object); });
+    wake(m_consumer_waiting);
+  }
+
+  /// @brief Same as try_pop(), but sleeps until there is an object
+  void pop(T& object)
+  {
+    wait(m_consumer_waiting, [&] { return pop_slot(object); });
+    wake(m_producer_waiting);
+  }
+
+  size_t capacity() const { return m_slots.size(); }
+
+  /// Number of queued objects, exact only when neither side is active
+  size_t size_approx() const
+  {
+    return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+  }
+
+  bool empty() const { return size_approx() == 0; }
+
+private:
+  static size_t round_up(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    return size;
+  }
+
+  bool push_slot(T& object)
+  {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head_cache == m_slots.size()) {
+      m_head_cache = m_head.load(std::memory_order_acquire);
+      if (tail - m_head_cache == m_slots.size()) {
+        return false;
+      }
+    }
+    m_slots[tail & m_mask] = std::move(object);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop_slot(T& object)
+  {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail_cache) {
+      m_tail_cache = m_tail.load(std::memory_order_acquire);
+      if (head == m_tail_cache) {
+        return false;
+      }
+    }
+    object = std::move(m_slots[head & m_mask]);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Retry attempt until it succeeds, sleeping between the tries once the spin is over
+  template<class Attempt>
+  void wait(std::atomic<bool>& waiting, Attempt&& attempt)
+  {
+    for (int spin = 0; spin < s_spins; ++spin) {
+      if (attempt()) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+      waiting.store(true, std::memory_order_relaxed);
+      // Pairs with the fence in wake(): either the attempt sees the other
+      // side's push or pop, or the other side sees the flag and notifies.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (attempt()) {
+        break;
+      }
+      m_wake.wait(lock);
+    }
+    waiting.store(false, std::memory_order_relaxed);
+  }
+
+  // Wake the other side if it sleeps in wait()
+  void wake(std::atomic<bool>& waiting)
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_wake.notify_all();
+    }
+  }
+
+  static constexpr size_t s_cache_line = 64;
+  // Tries before a waiting side goes to sleep
+  static constexpr int s_spins = 64;
+
+  std::vector<T> m_slots;
+  size_t m_mask;
+
+  // Producer and consumer indices on their own cache lines, each with a
+  // cached copy of the other side's index to avoid reloading it every call.
+  alignas(s_cache_line) std::atomic<size_t> m_tail = 0;
+  size_t m_head_cache = 0;
+  alignas(s_cache_line) std::atomic<size_t> m_head = 0;
+  size_t m_tail_cache = 0;
+
+  // Sleeping sides, off the index cache lines as they are rarely written
+  alignas(s_cache_line) std::atomic<bool> m_producer_waiting = false;
+  std::atomic<bool> m_consumer_waiting = false;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_SPSCQUEUE_HPP_
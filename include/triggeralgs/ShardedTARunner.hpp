@@ -0,0 +1,207 @@
+/**
+ * @file ShardedTARunner.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_SHARDEDTARUNNER_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_SHARDEDTARUNNER_HPP_
+
+#include "triggeralgs/SPSCQueue.hpp"
+#include "triggeralgs/Span.hpp"
+#include "triggeralgs/ThreadPlacement.hpp"
+#include "triggeralgs/TriggerActivity.hpp"
+#include "triggeralgs/TriggerActivityMaker.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Runs N instances of a TA maker in parallel, each on a part of the channels
+ *
+ * configure() builds "n_shards" instances of the factory-registered TA maker
+ * "algorithm", each configured with the "maker" object, and splits the
+ * channels between them by "shard_by":
+ *  - "channel": "n_channels" channels in contiguous ranges of equal size,
+ *  - "apa": whole APAs of "channels_per_apa" channels, dealt out in turn,
+ *  - "plane": by the plane of the channel in "channel_map", which is required
+ *    (shard plane % n_shards).
+ * Channels at or above "n_channels" (and negative ones) go to shard 0.
+ *
+ * Each shard runs its maker on its own thread, which sleeps while it has
+ * no input. push() splits a time ordered block of TPs into per-shard
+ * blocks and hands them over through a bounded lock-free SPSCQueue per
+ * shard, waiting for room when a shard falls behind. The shards send their TAs back through another SPSCQueue,
+ * and drain() merges them into one stream ordered by time_start: a TA is
+ * output once every shard has processed its TPs up to "merge_lag" ticks
+ * after its start (the lag allows for the TA windows still open in the
+ * other shards). A TA made later than that, ie starting before a TA
+ * already output, is output straight away and counted as late. The queues
+ * hold "queue_size" blocks.
+ *
+ * The shard threads are named "ta-shard-<n>". Shard n is placed on CPUs
+ * and NUMA nodes with entry n (modulo the length) of the "placement" list,
+ * see ThreadPlacement, eg to keep the makers on the socket of the readout.
+ * Each shard thread places itself before building and configuring its
+ * maker and allocating its queues, so they live on its node.
+ *
+ * One thread calls push(), heartbeat(), drain() and stop().
+ */
+class ShardedTARunner
+{
+public:
+  static constexpr timestamp_t s_default_merge_lag = 62500; // 1 ms of 62.5 MHz ticks
+
+  ShardedTARunner() = default;
+  ShardedTARunner(const ShardedTARunner&) = delete;
+  ShardedTARunner& operator=(const ShardedTARunner&) = delete;
+  /// @brief Stops the shard threads, dropping the TAs not yet drained
+  ~ShardedTARunner();
+
+  /// @brief Build and configure the makers, and start the shard threads
+  void configure(const nlohmann::json& config);
+
+  /**
+   * @brief Hand a block of TPs over to the shards
+   *
+   * Every shard is sent a (possibly empty) block, so the shards that got no
+   * TP also move on to the time of the last TP.
+   *
+   * @param input_tps[in] Block of input TPs, time ordered across blocks
+   */
+  void push(span<const TriggerPrimitive> input_tps);
+
+  /**
+   * @brief Have every shard flush its maker up to until
+   *
+   * See TriggerActivityMaker::flush(): no TP earlier than until is to come.
+   */
+  void heartbeat(timestamp_t until);
+
+  /**
+   * @brief Output, in time_start order, the TAs of the shards that are ready
+   *
+   * @param output_ta[out] Vector the TAs are appended to
+   */
+  void drain(std::vector<TriggerActivity>& output_ta);
+
+  /**
+   * @brief Flush the makers to the end, stop the shard threads and output all of the TAs
+   *
+   * The runner takes no more TPs until configured again.
+   *
+   * @param output_ta[out] Vector the TAs are appended to
+   */
+  void stop(std::vector<TriggerActivity>& output_ta);
+
+  /**
+   * @brief Give back a TA output by the runner once done with it
+   *
+   * The TA, with its TP buffer, goes back to the pool of the maker of the
+   * shard its first channel belongs to, see
+   * TriggerActivityMaker::recycle_from_any_thread(). Only while configured.
+   */
+  void recycle(TriggerActivity&& ta);
+
+  size_t n_shards() const { return m_shards.size(); }
+  /// Time up to which every shard had processed its TPs, as of the last drain()
+  timestamp_t watermark() const { return m_watermark; }
+  /// Shard the TPs of channel go to
+  size_t shard_of(channel_t channel) const
+  {
+    return channel >= 0 && static_cast<size_t>(channel) < m_shard_of_channel.size() ? m_shard_of_channel[channel] : 0;
+  }
+
+  /// @brief Counts of the TPs and TAs through the runner
+  struct Stats
+  {
+    uint64_t n_tps = 0;
+    /// TPs of channels outside the configured channel range, sent to shard 0
+    uint64_t n_out_of_range = 0;
+    /// Times push() or heartbeat() found a shard's input queue full
+    uint64_t n_input_full = 0;
+    uint64_t n_tas = 0;
+    /// TAs starting before a TA already output
+    uint64_t n_late = 0;
+  };
+
+  const Stats& stats() const { return m_stats; }
+
+private:
+  // What the runner sends a shard: a block of TPs, and/or a flush
+  struct ShardInput
+  {
+    std::vector<TriggerPrimitive> tps;
+    // Time up to which the shard has all of its TPs once it has this block
+    timestamp_t watermark = 0;
+    bool flush = false;
+    bool stop = false;
+  };
+
+  // What a shard sends back after each input: the TAs made, and how far it got
+  struct ShardOutput
+  {
+    std::vector<TriggerActivity> tas;
+    timestamp_t watermark = 0;
+    // The shard's last output, the thread is done
+    bool stopped = false;
+  };
+
+  // The maker and queues are made by the shard thread, see configure()
+  struct Shard
+  {
+    std::unique_ptr<TriggerActivityMaker> maker;
+    std::unique_ptr<SPSCQueue<ShardInput>> input;
+    std::unique_ptr<SPSCQueue<ShardOutput>> output;
+    // TP blocks the shard is done with, back to the runner for reuse
+    std::unique_ptr<SPSCQueue<std::vector<TriggerPrimitive>>> free_blocks;
+    ThreadPlacement placement;
+    std::thread thread;
+
+    // Runner side: the block being filled, the latest watermark received and
+    // whether the last output was received
+    std::vector<TriggerPrimitive> pending;
+    timestamp_t watermark = 0;
+    bool stopped = false;
+  };
+
+  // Shard thread: run the maker over the inputs until the stop input
+  static void run_shard(Shard& shard);
+
+  void build_shard_table(const nlohmann::json& config,
+                         const std::string& shard_by,
+                         size_t n_shards,
+                         size_t n_channels);
+  // Send a shard an input, collecting the shards' outputs while its queue is full
+  void send(Shard& shard, ShardInput&& input);
+  // Move the shards' outputs into the merge heap
+  void collect();
+  void receive(Shard& shard, ShardOutput& output);
+  void output_top(std::vector<TriggerActivity>& output_ta);
+  void stop_threads();
+
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  std::vector<uint16_t> m_shard_of_channel;
+
+  // Min-heap, on time_start, of the TAs received from the shards
+  std::vector<TriggerActivity> m_heap;
+  timestamp_t m_output_time = 0;
+  timestamp_t m_watermark = 0;
+  timestamp_t m_merge_lag = s_default_merge_lag;
+
+  Stats m_stats;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_SHARDEDTARUNNER_HPP_
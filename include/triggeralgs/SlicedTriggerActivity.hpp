@@ -0,0 +1,61 @@
+/**
+ * @file SlicedTriggerActivity.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_SLICEDTRIGGERACTIVITY_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_SLICEDTRIGGERACTIVITY_HPP_
+
+#include "trgdataformats/TriggerActivityData.hpp"
+#include "triggeralgs/TPArena.hpp"
+#include "triggeralgs/TriggerActivity.hpp"
+#include "triggeralgs/TriggerObjectOverlay.hpp"
+
+#include <algorithm>
+
+namespace triggeralgs {
+
+/**
+ * @brief TriggerActivity whose input TPs are a slice of a TPArena
+ *
+ * Copies share the TPs rather than duplicating them. The TriggerActivity
+ * struct and the overlay format are only produced on demand, with
+ * to_trigger_activity() and write_overlay().
+ */
+struct SlicedTriggerActivity : public dunedaq::trgdataformats::TriggerActivityData
+{
+  TPSlice inputs;
+
+  TriggerActivity to_trigger_activity() const
+  {
+    TriggerActivity ta;
+    static_cast<dunedaq::trgdataformats::TriggerActivityData&>(ta) = *this;
+    ta.inputs = inputs.to_vector();
+    return ta;
+  }
+};
+
+template<>
+struct TypeToOverlayType<SlicedTriggerActivity>
+{
+  using overlay_t = dunedaq::trgdataformats::TriggerActivity;
+  using data_t = dunedaq::trgdataformats::TriggerActivityData;
+};
+
+// Same as the generic write_overlay(), with the TPs copied in one go from
+// the arena. The buffer size is given by get_overlay_nbytes() as usual.
+inline void
+write_overlay(const SlicedTriggerActivity& object, void* buffer)
+{
+  auto* overlay = reinterpret_cast<dunedaq::trgdataformats::TriggerActivity*>(buffer);
+  overlay->data = static_cast<const dunedaq::trgdataformats::TriggerActivityData&>(object);
+  overlay->n_inputs = object.inputs.size();
+  std::copy(object.inputs.begin(), object.inputs.end(), overlay->inputs);
+}
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_SLICEDTRIGGERACTIVITY_HPP_
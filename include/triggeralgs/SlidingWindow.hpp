@@ -0,0 +1,157 @@
+/**
+ * @file SlidingWindow.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_SLIDINGWINDOW_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_SLIDINGWINDOW_HPP_
+
+#include "triggeralgs/Types.hpp"
+#include "triggeralgs/WindowBuffer.hpp"
+#include "triggeralgs/WindowStats.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Sliding time window of TPs or TAs, with the running statistics Stats
+ *
+ * The elements are moved into a WindowBuffer and kept ordered by
+ * time_start: an element later than all the others is appended, others
+ * are inserted by binary search after the elements with the same
+ * time_start; the window start follows an element inserted first.
+ * Expiring elements from the front moves none of the others.
+ *
+ * Each of Stats (see WindowStats.hpp) is a base class, updated as elements
+ * are added and expire, so a window only pays for the statistics it is
+ * given, eg
+ *   SlidingWindow<TriggerPrimitive, window_stats::ADCSum>
+ * keeps the ADC sum in adc_integral and nothing else.
+ *
+ * The inputs are only to be changed through the window.
+ */
+template<class Element, class... Stats>
+class SlidingWindow : public Stats...
+{
+public:
+  bool is_empty() const { return inputs.empty(); }
+
+  /// @brief Add the element to the window. Pass an rvalue to hand it over without a copy.
+  void add(Element input)
+  {
+    size_t position = inputs.size();
+    if (!inputs.empty() && input.time_start < inputs.back().time_start) {
+      position = std::upper_bound(inputs.begin(),
+                                  inputs.end(),
+                                  input.time_start,
+                                  [](timestamp_t time_start, const Element& element) {
+                                    return time_start < element.time_start;
+                                  }) -
+                 inputs.begin();
+    }
+    (Stats::on_add(input, position), ...);
+    if (position == 0)
+      time_start = input.time_start;
+    if (position == inputs.size())
+      inputs.push_back(std::move(input));
+    else
+      inputs.insert(inputs.begin() + position, std::move(input));
+  }
+
+  /// @brief Clear all inputs
+  void clear()
+  {
+    (Stats::on_clear(inputs), ...);
+    inputs.clear();
+    time_start = 0;
+  }
+
+  /**
+   * @brief Expire the elements that input could not share the window with, then add it
+   *
+   * The window is reset on input if no element is left.
+   */
+  void move(Element input, timestamp_t const& window_length)
+  {
+    expire(input.time_start, window_length);
+    if (!inputs.empty())
+      add(std::move(input));
+    else
+      reset(std::move(input));
+  }
+
+  /**
+   * @brief Remove the elements that an element starting at until could not share the window with
+   *
+   * The window start becomes the start of the first element left, and the
+   * window is cleared if none is left.
+   */
+  void expire(timestamp_t until, timestamp_t const& window_length)
+  {
+    size_t n_to_expire = 0;
+    for (const Element& element : inputs) {
+      // Elements are time ordered: stop at the first one still in the window.
+      if (element.time_start > until || until - element.time_start < window_length)
+        break;
+      (Stats::on_expire(element), ...);
+      n_to_expire++;
+    }
+    inputs.pop_front(n_to_expire);
+    if (inputs.empty()) {
+      clear();
+      return;
+    }
+    if (n_to_expire > 0) {
+      (Stats::on_expired(inputs), ...);
+    }
+    time_start = inputs.front().time_start;
+  }
+
+  /// @brief Reset window content on the input
+  void reset(Element input)
+  {
+    clear();
+    time_start = input.time_start;
+    add(std::move(input));
+  }
+
+  /**
+   * @brief Hand the elements of the window over to destination, leaving the window empty
+   *
+   * The window's buffer is swapped with destination, so no element is
+   * copied; the window gets the previous buffer of destination, cleared.
+   */
+  void take_inputs(std::vector<Element>& destination)
+  {
+    (Stats::on_clear(inputs), ...);
+    destination.clear();
+    destination.swap(inputs.storage());
+    time_start = 0;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const SlidingWindow& window)
+  {
+    if (window.is_empty()) {
+      os << "Window is empty!\n";
+    } else {
+      os << "Window start: " << window.time_start << ", end: " << window.inputs.back().time_start << ", with "
+         << window.inputs.size() << " inputs.\n";
+      (window.Stats::describe(os), ...);
+    }
+    return os;
+  }
+
+  timestamp_t time_start = 0;
+  WindowBuffer<Element> inputs;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_SLIDINGWINDOW_HPP_
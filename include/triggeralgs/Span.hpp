@@ -0,0 +1,86 @@
+/**
+ * @file Span.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_SPAN_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_SPAN_HPP_
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace triggeralgs {
+
+/**
+ * @brief Non-owning view over a contiguous block of objects
+ *
+ * A minimal stand-in for C++20's std::span, used to hand blocks of trigger
+ * objects (eg the TPs of a received fragment) to the makers without copying.
+ */
+template<class T>
+class span
+{
+public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using size_type = std::size_t;
+  using pointer = T*;
+  using reference = T&;
+  using iterator = T*;
+
+  constexpr span() noexcept = default;
+
+  constexpr span(T* data, size_type size) noexcept
+    : m_data(data)
+    , m_size(size)
+  {}
+
+  constexpr span(T* first, T* last) noexcept
+    : m_data(first)
+    , m_size(static_cast<size_type>(last - first))
+  {}
+
+  /// Construct from any contiguous container with data() and size(), eg std::vector
+  template<class Container,
+           class = std::enable_if_t<!std::is_same_v<std::decay_t<Container>, span> &&
+                                    std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>>
+  constexpr span(Container& container) noexcept // NOLINT(runtime/explicit)
+    : m_data(container.data())
+    , m_size(container.size())
+  {}
+
+  /// Allow span<T> -> span<const T>
+  template<class U, class = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+  constexpr span(const span<U>& other) noexcept // NOLINT(runtime/explicit)
+    : m_data(other.data())
+    , m_size(other.size())
+  {}
+
+  constexpr iterator begin() const noexcept { return m_data; }
+  constexpr iterator end() const noexcept { return m_data + m_size; }
+
+  constexpr reference operator[](size_type idx) const { return m_data[idx]; }
+  constexpr reference front() const { return m_data[0]; }
+  constexpr reference back() const { return m_data[m_size - 1]; }
+
+  constexpr pointer data() const noexcept { return m_data; }
+  constexpr size_type size() const noexcept { return m_size; }
+  constexpr bool empty() const noexcept { return m_size == 0; }
+
+  constexpr span first(size_type count) const { return span(m_data, count); }
+  constexpr span last(size_type count) const { return span(m_data + m_size - count, count); }
+  constexpr span subspan(size_type offset, size_type count) const { return span(m_data + offset, count); }
+  constexpr span subspan(size_type offset) const { return span(m_data + offset, m_size - offset); }
+
+private:
+  T* m_data = nullptr;
+  size_type m_size = 0;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_SPAN_HPP_
@@ -0,0 +1,180 @@
+/**
+ * @file StaticTriggerActivityMaker.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_STATICTRIGGERACTIVITYMAKER_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_STATICTRIGGERACTIVITYMAKER_HPP_
+
+#include "triggeralgs/OutputSink.hpp"
+#include "triggeralgs/Span.hpp"
+#include "triggeralgs/TriggerActivity.hpp"
+#include "triggeralgs/TriggerActivityMaker.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+
+#include <type_traits>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Default TP filter: the maker's own non-virtual filtering
+ */
+struct DefaultTPFilter
+{
+  bool operator()(const TriggerActivityMaker& maker, const TriggerPrimitive& input_tp) const
+  {
+    return maker.accept_tp(input_tp);
+  }
+};
+
+/**
+ * @brief Default TA post-filter: the base class postprocess (prescale)
+ */
+struct DefaultTAPostFilter
+{
+  void operator()(TriggerActivityMaker& maker, std::vector<TriggerActivity>& output_ta) const
+  {
+    maker.TriggerActivityMaker::postprocess(output_ta);
+  }
+};
+
+/**
+ * @brief CRTP base running the preprocess -> process -> postprocess chain
+ * without virtual dispatch
+ *
+ * The derived class provides filter_tp(), process_tp(), process_run() and
+ * post_filter_ta(), which this base calls on the concrete type, so the
+ * whole chain is visible to the compiler and can be inlined.
+ */
+template<class Derived>
+class StaticTriggerActivityMakerBase
+{
+public:
+  void operator()(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta)
+  {
+    Derived& self = derived();
+    if (!self.filter_tp(input_tp)) {
+      return;
+    }
+    self.process_tp(input_tp, output_ta);
+    self.post_filter_ta(output_ta);
+  }
+
+  /// @brief Static counterpart of operator() emitting into an OutputSink
+  void operator()(const TriggerPrimitive& input_tp, OutputSink<TriggerActivity>& sink)
+  {
+    Derived& self = derived();
+    (*this)(input_tp, self.m_output_staging);
+    self.emit_output(self.m_output_staging, sink);
+  }
+
+  /**
+   * @brief Static counterpart of TriggerActivityMaker::process_batch
+   *
+   * As there, the runs of TPs passing filter_tp() go to process_run() in
+   * one call each, and the TAs are post-filtered once per block.
+   */
+  void process_span(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta)
+  {
+    Derived& self = derived();
+    size_t run_start = 0;
+    for (size_t idx = 0; idx < input_tps.size(); ++idx) {
+      if (self.filter_tp(input_tps[idx])) {
+        continue;
+      }
+      if (idx > run_start) {
+        self.process_run(input_tps.subspan(run_start, idx - run_start), output_ta);
+      }
+      run_start = idx + 1;
+    }
+    if (run_start < input_tps.size()) {
+      self.process_run(input_tps.subspan(run_start), output_ta);
+    }
+    self.post_filter_ta(output_ta);
+  }
+
+private:
+  Derived& derived() { return static_cast<Derived&>(*this); }
+};
+
+/**
+ * @brief TA maker with its filter, algorithm and post-filter bound at compile time
+ *
+ * Wraps one of the TA maker algorithms. It is still a TriggerActivityMaker,
+ * so it is configured the same way and can be used through the base class,
+ * but calls made on the concrete type go straight to Algorithm::process with
+ * no virtual call per TP. Blocks go to Algorithm::process_accepted, run by
+ * run, when the algorithm has its own.
+ *
+ * @tparam Algorithm  TA maker algorithm, eg TAMakerHorizontalMuonAlgorithm
+ * @tparam Filter     Functor (const TriggerActivityMaker&, const TriggerPrimitive&) -> bool
+ * @tparam PostFilter Functor (TriggerActivityMaker&, std::vector<TriggerActivity>&)
+ */
+template<class Algorithm, class Filter = DefaultTPFilter, class PostFilter = DefaultTAPostFilter>
+class StaticTriggerActivityMaker final
+  : public Algorithm
+  , public StaticTriggerActivityMakerBase<StaticTriggerActivityMaker<Algorithm, Filter, PostFilter>>
+{
+  static_assert(std::is_base_of_v<TriggerActivityMaker, Algorithm>,
+                "StaticTriggerActivityMaker needs a TriggerActivityMaker algorithm");
+
+  using StaticBase = StaticTriggerActivityMakerBase<StaticTriggerActivityMaker<Algorithm, Filter, PostFilter>>;
+  friend StaticBase;
+
+  // Inherited, &Algorithm::process_accepted is a member of TriggerActivityMaker
+  static constexpr bool s_own_process_accepted =
+    !std::is_same_v<decltype(&Algorithm::process_accepted), decltype(&TriggerActivityMaker::process_accepted)>;
+
+public:
+  using StaticBase::operator();
+
+  bool preprocess(const TriggerPrimitive& input_tp) override { return filter_tp(input_tp); }
+  void postprocess(std::vector<TriggerActivity>& output_ta) override { post_filter_ta(output_ta); }
+
+  void process_batch(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta) override
+  {
+    this->process_span(input_tps, output_ta);
+  }
+
+  void process_buffer(span<TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta) override
+  {
+    // The in-place compaction only knows the default filtering
+    if constexpr (std::is_same_v<Filter, DefaultTPFilter>) {
+      this->TriggerActivityMaker::process_buffer(input_tps, output_ta);
+    } else {
+      this->process_span(input_tps, output_ta);
+    }
+  }
+
+  Filter& filter() { return m_filter; }
+  PostFilter& post_filter() { return m_post_filter; }
+
+private:
+  bool filter_tp(const TriggerPrimitive& input_tp) const { return m_filter(*this, input_tp); }
+  void process_tp(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta)
+  {
+    this->Algorithm::process(input_tp, output_ta);
+  }
+  void process_run(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta)
+  {
+    if constexpr (s_own_process_accepted) {
+      this->Algorithm::process_accepted(input_tps, output_ta);
+    } else {
+      for (const TriggerPrimitive& input_tp : input_tps) {
+        process_tp(input_tp, output_ta);
+      }
+    }
+  }
+  void post_filter_ta(std::vector<TriggerActivity>& output_ta) { m_post_filter(*this, output_ta); }
+
+  Filter m_filter;
+  PostFilter m_post_filter;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_STATICTRIGGERACTIVITYMAKER_HPP_
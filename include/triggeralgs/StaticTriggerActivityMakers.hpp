@@ -0,0 +1,46 @@
+/**
+ * @file StaticTriggerActivityMakers.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_STATICTRIGGERACTIVITYMAKERS_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_STATICTRIGGERACTIVITYMAKERS_HPP_
+
+#include "triggeralgs/StaticTriggerActivityMaker.hpp"
+
+#include "triggeralgs/ADCSimpleWindow/TAMakerADCSimpleWindowAlgorithm.hpp"
+#include "triggeralgs/ChannelAdjacency/TAMakerChannelAdjacencyAlgorithm.hpp"
+#include "triggeralgs/ChannelDistance/TAMakerChannelDistanceAlgorithm.hpp"
+#include "triggeralgs/HorizontalMuon/TAMakerHorizontalMuonAlgorithm.hpp"
+#include "triggeralgs/dbscan/TAMakerDBSCANAlgorithm.hpp"
+
+namespace triggeralgs {
+
+/// Devirtualised forms of the TA makers on the hot path. These are
+/// instantiated in the library, next to the algorithms, so that the
+/// algorithm's process() can be inlined into the TP loop at link time.
+/// The factory keeps handing out the plain polymorphic makers.
+using StaticTAMakerADCSimpleWindow = StaticTriggerActivityMaker<TAMakerADCSimpleWindowAlgorithm>;
+using StaticTAMakerChannelAdjacency = StaticTriggerActivityMaker<TAMakerChannelAdjacencyAlgorithm>;
+using StaticTAMakerChannelDistance = StaticTriggerActivityMaker<TAMakerChannelDistanceAlgorithm>;
+using StaticTAMakerHorizontalMuon = StaticTriggerActivityMaker<TAMakerHorizontalMuonAlgorithm>;
+using StaticTAMakerDBSCAN = StaticTriggerActivityMaker<TAMakerDBSCANAlgorithm>;
+
+extern template class StaticTriggerActivityMaker<TAMakerADCSimpleWindowAlgorithm>;
+extern template class StaticTriggerActivityMaker<TAMakerChannelAdjacencyAlgorithm>;
+extern template class StaticTriggerActivityMaker<TAMakerChannelDistanceAlgorithm>;
+extern template class StaticTriggerActivityMaker<TAMakerHorizontalMuonAlgorithm>;
+extern template class StaticTriggerActivityMaker<TAMakerDBSCANAlgorithm>;
+
+extern template class StaticTriggerActivityMakerBase<StaticTAMakerADCSimpleWindow>;
+extern template class StaticTriggerActivityMakerBase<StaticTAMakerChannelAdjacency>;
+extern template class StaticTriggerActivityMakerBase<StaticTAMakerChannelDistance>;
+extern template class StaticTriggerActivityMakerBase<StaticTAMakerHorizontalMuon>;
+extern template class StaticTriggerActivityMakerBase<StaticTAMakerDBSCAN>;
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_STATICTRIGGERACTIVITYMAKERS_HPP_
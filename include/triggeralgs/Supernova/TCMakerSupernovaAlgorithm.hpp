@@ -26,6 +26,7 @@ class TCMakerSupernovaAlgorithm : public TriggerCandidateMaker
 public:
   /// The function that gets call when there is a new activity
   void process(const TriggerActivity&, std::vector<TriggerCandidate>&);
+  void process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& output_tc) override;
 
 protected:
   std::vector<TriggerActivity::TriggerActivityData> m_activity;
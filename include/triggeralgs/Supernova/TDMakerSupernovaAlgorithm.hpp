@@ -9,7 +9,7 @@
 #ifndef TRIGGERALGS_SRC_TRIGGERALGS_SUPERNOVA_TRIGGERDECISIONMAKERSUPERNOVA_HPP_
 #define TRIGGERALGS_SRC_TRIGGERALGS_SUPERNOVA_TRIGGERDECISIONMAKERSUPERNOVA_HPP_
 
-#include "triggeralgs/TriggerDecisionMaker.hpp"
+#include "triggeralgs/TriggerDecisionFactory.hpp"
 #include "trgdataformats/Types.hpp"
 
 #include <algorithm>
@@ -8,52 +8,21 @@
 #ifndef TRIGGERALGS_TAWINDOW_HPP_
 #define TRIGGERALGS_TAWINDOW_HPP_
 
+#include "triggeralgs/SlidingWindow.hpp"
 #include "triggeralgs/TriggerActivity.hpp"
-#include "triggeralgs/Types.hpp"
-
-#include <ostream>
-#include <unordered_map>
+#include "triggeralgs/WindowStats.hpp"
 
 namespace triggeralgs {
 
-class TAWindow
-{
-public:
-  bool is_empty() const { return inputs.empty(); };
-
-  /// @brief
-  /// Add the input TA's contribution to the total ADC, increase the hit count of 
-  /// all of the channels which feature and add it to the TA list keeping the TA
-  /// list time ordered by time_start. Preserving time order makes moving easier.
-  /// @param input_ta
-  void add(const TriggerActivity& input_ta);
-
-  /// @brief Clear all inputs
-  void clear();
-
-  uint16_t n_channels_hit() { return channel_states.size(); };
-
-  /// @brief 
-  /// Find all of the TAs in the window that need to be removed
-  /// if the input_ta is to be added and the size of the window
-  /// is to be conserved.
-  /// Subtract those TAs' contribution from the total window ADC and remove their
-  /// contributions to the hit counts.
-  /// @param input_ta 
-  /// @param window_length 
-  void move(TriggerActivity const& input_ta, timestamp_t const& window_length);
-
-  /// @brief Reset window content on the input
-  /// @param input_ta 
-  void reset(TriggerActivity const& input_ta);
-
-  friend std::ostream& operator<<(std::ostream& os, const TAWindow& window);
-
-  timestamp_t time_start;
-  uint64_t adc_integral;
-  std::unordered_map<channel_t, uint16_t> channel_states;
-  std::vector<TriggerActivity> inputs;
-};
+/**
+ * @brief Sliding time window of TAs, with its ADC sum and hit count per channel
+ *
+ * See SlidingWindow: TAs are moved in and kept time ordered, late ones
+ * inserted by binary search, and each TA's distinct channels are
+ * summarised as it is added, so expiring it costs one update per channel
+ * rather than per TP (see window_stats::ChannelCounts).
+ */
+using TAWindow = SlidingWindow<TriggerActivity, window_stats::ADCSum, window_stats::ChannelCounts>;
 
 } // namespace triggeralgs
 
@@ -0,0 +1,152 @@
+/**
+ * @file TPArena.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_TPARENA_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_TPARENA_HPP_
+
+#include "triggeralgs/Span.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Reference-counted, read-only run of TPs stored in a TPArena
+ *
+ * Copying a slice only bumps a reference count: the TPs stay where the
+ * arena put them for as long as any slice refers to their block. Slices
+ * can be handed to, and released from, other threads.
+ */
+class TPSlice
+{
+public:
+  using iterator = const TriggerPrimitive*;
+
+  TPSlice() = default;
+
+  iterator begin() const { return m_data; }
+  iterator end() const { return m_data + m_size; }
+
+  const TriggerPrimitive& operator[](size_t idx) const { return m_data[idx]; }
+  const TriggerPrimitive& front() const { return m_data[0]; }
+  const TriggerPrimitive& back() const { return m_data[m_size - 1]; }
+
+  const TriggerPrimitive* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  operator span<const TriggerPrimitive>() const { return { m_data, m_size }; } // NOLINT(runtime/explicit)
+
+  /// @return a copy of the TPs, eg for a TriggerActivity
+  std::vector<TriggerPrimitive> to_vector() const { return { begin(), end() }; }
+
+private:
+  friend class TPArena;
+
+  TPSlice(std::shared_ptr<const void> block, const TriggerPrimitive* data, size_t size)
+    : m_block(std::move(block))
+    , m_data(data)
+    , m_size(size)
+  {}
+
+  std::shared_ptr<const void> m_block;
+  const TriggerPrimitive* m_data = nullptr;
+  size_t m_size = 0;
+};
+
+/**
+ * @brief Append-only store of TPs, handing out TPSlice references
+ *
+ * TPs are appended in blocks of block_size TPs. A run of TPs appended in one
+ * go is never split across blocks (a run that does not fit the room left
+ * starts a new block, and runs longer than block_size get a block of their
+ * own), so every slice is contiguous.
+ *
+ * The arena only holds on to the block it is filling: full blocks are kept
+ * alive by the slices pointing into them and freed with the last one.
+ *
+ * Appending is not thread safe: an arena belongs to one maker.
+ */
+class TPArena
+{
+public:
+  static constexpr size_t s_default_block_size = 4096;
+
+  explicit TPArena(size_t block_size = s_default_block_size)
+    : m_block_size(block_size)
+  {}
+
+  /**
+   * @brief Copy a run of TPs into the arena
+   *
+   * @param input_tps[in] TPs to store
+   * @return TPSlice referring to the stored copies
+   */
+  TPSlice append(span<const TriggerPrimitive> input_tps);
+
+  /**
+   * @brief Copy a TP onto the end of the open run
+   *
+   * The open run is built up one TP at a time, eg by a maker's window, and
+   * closed with take_run() or drop_run(). It is kept contiguous: a run that
+   * outgrows the room left in its block is moved to a new one. append() is
+   * not to be called while a run is open.
+   */
+  void push(const TriggerPrimitive& input_tp);
+
+  /// TPs of the open run
+  span<const TriggerPrimitive> run() const
+  {
+    if (m_run_size == 0)
+      return {};
+    return { m_block->tps.get() + m_block->size - m_run_size, m_run_size };
+  }
+
+  /// Close the open run, returning the slice referring to its TPs
+  TPSlice take_run();
+
+  /// Close the open run without keeping it: its room is reused
+  void drop_run();
+
+  size_t block_size() const { return m_block_size; }
+  /// Total number of TPs appended
+  uint64_t n_appended() const { return m_n_appended; }
+  /// Number of blocks allocated so far
+  uint64_t n_blocks() const { return m_n_blocks; }
+  /// Number of TPs copied again to move an open run to a new block
+  uint64_t n_moved() const { return m_n_moved; }
+
+private:
+  struct Block
+  {
+    explicit Block(size_t capacity)
+      : tps(new TriggerPrimitive[capacity])
+      , capacity(capacity)
+    {}
+
+    std::unique_ptr<TriggerPrimitive[]> tps;
+    size_t capacity;
+    size_t size = 0;
+  };
+
+  size_t m_block_size;
+  std::shared_ptr<Block> m_block;
+  uint64_t m_n_appended = 0;
+  uint64_t m_n_blocks = 0;
+  uint64_t m_n_moved = 0;
+  // The open run is the last m_run_size TPs of m_block.
+  size_t m_run_size = 0;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_TPARENA_HPP_
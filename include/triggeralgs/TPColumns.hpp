@@ -0,0 +1,93 @@
+/**
+ * @file TPColumns.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_TPCOLUMNS_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_TPCOLUMNS_HPP_
+
+#include "triggeralgs/Span.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+#include "triggeralgs/Types.hpp"
+#include "triggeralgs/WindowBuffer.hpp"
+
+#include <cstdint>
+#include <limits>
+
+namespace triggeralgs {
+
+/**
+ * @brief The TP fields that TA attributes are computed from, one column per field
+ *
+ * Structure-of-arrays copy of the time_start, time_over_threshold,
+ * time_peak, channel, adc_integral and adc_peak of a sequence of TPs, kept
+ * in step with it (see window_stats::Columns). Each column is contiguous,
+ * so reduce() runs over them 8 TPs at a time with AVX2, and a column, eg
+ * the channels, can be copied out without touching the rest of the TPs.
+ *
+ * The TPs themselves are not kept: a window still hands its TPs over to a
+ * TA by swapping buffers, so none is rebuilt from the columns.
+ */
+class TPColumns
+{
+public:
+  bool empty() const { return m_time_start.empty(); }
+  size_t size() const { return m_time_start.size(); }
+
+  void push_back(const TriggerPrimitive& tp);
+  /// @brief Insert before the TP at position, moving the later ones along
+  void insert(size_t position, const TriggerPrimitive& tp);
+  /// @brief Drop the n oldest TPs
+  void pop_front(size_t n = 1);
+  void clear();
+
+  const WindowBuffer<timestamp_t>& time_start() const { return m_time_start; }
+  const WindowBuffer<timestamp_t>& time_over_threshold() const { return m_time_over_threshold; }
+  const WindowBuffer<timestamp_t>& time_peak() const { return m_time_peak; }
+  const WindowBuffer<channel_t>& channel() const { return m_channel; }
+  const WindowBuffer<uint32_t>& adc_integral() const { return m_adc_integral; }
+  const WindowBuffer<uint32_t>& adc_peak() const { return m_adc_peak; }
+
+private:
+  WindowBuffer<timestamp_t> m_time_start;
+  WindowBuffer<timestamp_t> m_time_over_threshold;
+  WindowBuffer<timestamp_t> m_time_peak;
+  WindowBuffer<channel_t> m_channel;
+  WindowBuffer<uint32_t> m_adc_integral;
+  WindowBuffer<uint32_t> m_adc_peak;
+};
+
+/**
+ * @brief Extremes and sums of a set of TPs, from which the makers fill in their TA
+ *
+ * Of an empty set, the minima are the largest values and the maxima the
+ * smallest.
+ */
+struct TPReduction
+{
+  timestamp_t time_start_min = std::numeric_limits<timestamp_t>::max();
+  timestamp_t time_start_max = 0;
+  /// Largest time_start + time_over_threshold
+  timestamp_t time_end_max = 0;
+  channel_t channel_min = std::numeric_limits<channel_t>::max();
+  channel_t channel_max = std::numeric_limits<channel_t>::min();
+  uint64_t adc_integral = 0;
+  uint32_t adc_peak = 0;
+  /// Index of the first TP with the highest adc_peak
+  size_t peak_index = 0;
+};
+
+/// @brief Reduce the TPs of the columns, with AVX2 if the CPU has it
+TPReduction
+reduce(const TPColumns& columns);
+
+/// @brief Reduce TPs stored as such, eg the inputs of a TA
+TPReduction
+reduce(span<const TriggerPrimitive> tps);
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_TPCOLUMNS_HPP_
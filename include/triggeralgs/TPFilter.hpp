@@ -0,0 +1,162 @@
+/**
+ * @file TPFilter.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_TPFILTER_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_TPFILTER_HPP_
+
+#include "triggeralgs/Span.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Chain of TP filters compiled into a single predicate
+ *
+ * The chain is set up from the maker configuration:
+ *  - "min_time_over_threshold", "max_time_over_threshold"
+ *  - "min_adc_integral", "max_adc_integral"
+ *  - "min_adc_peak", "max_adc_peak"
+ *  - "channel_mask": list of channels whose TPs are dropped (eg hot channels)
+ *  - "planes": list of planes to keep, looked up with the "channel_map"
+ *    over channels [0, "n_channels"); both are required with "planes"
+ *  - "detids": list of detids to keep
+ *
+ * configure() folds the enabled filters into one function: ranges become a
+ * single unsigned comparison each, the channel mask and plane selection
+ * become one lookup table, and the results are combined without branching.
+ * Disabled filters cost nothing, and with no filters the predicate is a
+ * constant true.
+ *
+ * Blocks of TPs are filtered with compact(), which evaluates the filters
+ * over 8 (AVX2) or 4 (SSE4.1) TPs at a time, with a scalar fallback, and
+ * keeps count of the TPs rejected by each filter.
+ */
+class TPFilter
+{
+public:
+  void configure(const nlohmann::json& config);
+
+  /// @return true if the TP passes all of the configured filters
+  bool operator()(const TriggerPrimitive& input_tp) const { return m_predicate(*this, input_tp); }
+
+  /// @return true if no filter is configured, ie every TP is accepted
+  bool accepts_all() const { return m_enabled == 0; }
+
+  /**
+   * @brief Filter a block of TPs in place
+   *
+   * The TPs that pass the filters are moved, in order, to the front of the
+   * block.
+   *
+   * @param[in,out] input_tps block of TPs to filter
+   * @return size_t number of TPs kept at the front of the block
+   */
+  size_t compact(span<TriggerPrimitive> input_tps);
+
+  /// @brief Counts of TPs seen and rejected by compact()
+  struct Stats
+  {
+    uint64_t n_tps = 0;
+    uint64_t n_rejected = 0;
+    /// A TP failing several filters is counted by each of them
+    uint64_t n_rejected_time_over_threshold = 0;
+    uint64_t n_rejected_adc_integral = 0;
+    uint64_t n_rejected_adc_peak = 0;
+    uint64_t n_rejected_channel = 0;
+    uint64_t n_rejected_detid = 0;
+  };
+
+  const Stats& stats() const { return m_stats; }
+  void reset_stats() { m_stats = Stats(); }
+
+private:
+  using predicate_t = bool (*)(const TPFilter&, const TriggerPrimitive&);
+
+  enum Enabled : unsigned
+  {
+    kToT = 1u << 0,
+    kADCIntegral = 1u << 1,
+    kADCPeak = 1u << 2,
+    kChannel = 1u << 3,
+    kDetID = 1u << 4,
+    kAll = (1u << 5) - 1
+  };
+
+  /// One instantiation per combination of enabled filters (bits of Enabled)
+  template<unsigned kFilters>
+  static bool predicate_for(const TPFilter& filter, const TriggerPrimitive& input_tp);
+
+  template<unsigned... kFilters>
+  static std::array<predicate_t, sizeof...(kFilters)> make_predicate_table(std::integer_sequence<unsigned, kFilters...>);
+  static predicate_t select_predicate(unsigned filters);
+
+  size_t compact_scalar(TriggerPrimitive* tps, size_t n_tps, size_t start);
+#if defined(__x86_64__)
+  size_t compact_sse41(TriggerPrimitive* tps, size_t n_tps);
+  size_t compact_avx2(TriggerPrimitive* tps, size_t n_tps);
+#endif
+
+  /// True if lo <= value <= hi, with span = hi - lo, in a single comparison
+  static bool in_range(uint64_t value, uint64_t lo, uint64_t span) { return value - lo <= span; }
+
+  unsigned m_enabled = 0;
+  predicate_t m_predicate = &TPFilter::predicate_for<0>;
+
+  uint64_t m_tot_lo = 0;
+  uint64_t m_tot_span = std::numeric_limits<uint64_t>::max();
+  uint64_t m_adc_integral_lo = 0;
+  uint64_t m_adc_integral_span = std::numeric_limits<uint64_t>::max();
+  uint64_t m_adc_peak_lo = 0;
+  uint64_t m_adc_peak_span = std::numeric_limits<uint64_t>::max();
+
+  /// Accept flag per channel in [0, m_n_channels), and for the rest. The
+  /// tables have kTablePadding spare bytes so they can be read 32 bits at a time.
+  static constexpr size_t kTablePadding = 3;
+  std::vector<uint8_t> m_channel_accept;
+  uint32_t m_n_channels = 0;
+  uint8_t m_channel_accept_default = 1;
+
+  /// Accept flag per detid
+  std::vector<uint8_t> m_detid_accept;
+
+  Stats m_stats;
+};
+
+template<unsigned kFilters>
+inline bool
+TPFilter::predicate_for(const TPFilter& filter, const TriggerPrimitive& input_tp)
+{
+  // Each term is evaluated unconditionally and combined with '&', so the
+  // compiler can emit straight-line code for the enabled filters.
+  bool keep = true;
+  if constexpr ((kFilters & kToT) != 0)
+    keep &= in_range(input_tp.time_over_threshold, filter.m_tot_lo, filter.m_tot_span);
+  if constexpr ((kFilters & kADCIntegral) != 0)
+    keep &= in_range(input_tp.adc_integral, filter.m_adc_integral_lo, filter.m_adc_integral_span);
+  if constexpr ((kFilters & kADCPeak) != 0)
+    keep &= in_range(input_tp.adc_peak, filter.m_adc_peak_lo, filter.m_adc_peak_span);
+  if constexpr ((kFilters & kChannel) != 0) {
+    uint32_t channel = static_cast<uint32_t>(input_tp.channel);
+    keep &= (channel < filter.m_n_channels ? filter.m_channel_accept[channel] : filter.m_channel_accept_default) != 0;
+  }
+  if constexpr ((kFilters & kDetID) != 0)
+    keep &= filter.m_detid_accept[input_tp.detid] != 0;
+  return keep;
+}
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_TPFILTER_HPP_
@@ -8,37 +8,21 @@
 #ifndef TRIGGERALGS_TPWINDOW_HPP_
 #define TRIGGERALGS_TPWINDOW_HPP_
 
+#include "triggeralgs/SlidingWindow.hpp"
 #include "triggeralgs/TriggerPrimitive.hpp"
-#include "triggeralgs/Types.hpp"
-
-#include <ostream>
-#include <unordered_map>
-#include <vector>
+#include "triggeralgs/WindowStats.hpp"
 
 namespace triggeralgs {
 
-class TPWindow
-{
-public:
-  bool is_empty() const;
-
-  void add(TriggerPrimitive const& input_tp);
-
-  void clear();
-
-  uint16_t n_channels_hit();
-
-  void move(TriggerPrimitive const& input_tp, timestamp_t const& window_length);
-
-  void reset(TriggerPrimitive const& input_tp);
-
-  friend std::ostream& operator<<(std::ostream& os, const TPWindow& window);
+/**
+ * @brief Sliding time window of TPs, with its ADC sum and hit count per channel
+ *
+ * See SlidingWindow: sliding the window with move() only touches the TPs
+ * that expire, and the hit counts are a ChannelOccupancy, sized with
+ * set_channel_range().
+ */
+using TPWindow = SlidingWindow<TriggerPrimitive, window_stats::ADCSum, window_stats::ChannelCounts>;
 
-  timestamp_t time_start;
-  uint32_t adc_integral;
-  std::unordered_map<channel_t, uint16_t> channel_states;
-  std::vector<TriggerPrimitive> inputs;
-};
 } // namespace triggeralgs
 
 #endif // TRIGGERALGS_TPWINDOW_HPP_
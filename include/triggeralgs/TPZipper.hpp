@@ -0,0 +1,169 @@
+/**
+ * @file TPZipper.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_TPZIPPER_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_TPZIPPER_HPP_
+
+#include "triggeralgs/Span.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Merges the TP streams of several links into one time ordered stream
+ *
+ * Each link's TPs are buffered, in time order, and a heap over the links'
+ * earliest buffered TPs picks the next TP to output. A TP is output once no
+ * link can still send an earlier one, ie once every link has sent a TP (or a
+ * heartbeat) at or after it. So a quiet link does not hold the output back
+ * forever, a TP is also output once it is more than "max_lateness" ticks
+ * behind the latest TP seen on any link, and flush_on_timeout() outputs
+ * everything buffered when no TP arrived for "timeout_ms".
+ *
+ * A TP earlier than the last TP (or heartbeat) of its own link is inserted
+ * in order and counted as late. A TP earlier than the last TP output can no longer be
+ * output in order, so is dropped (and counted).
+ *
+ * Not thread safe: one thread adds the TPs and drains the output.
+ */
+class TPZipper
+{
+public:
+  static constexpr timestamp_t s_default_max_lateness = 62500; // 1 ms of 62.5 MHz ticks
+  static constexpr std::chrono::milliseconds s_default_timeout{ 100 };
+
+  explicit TPZipper(size_t n_links);
+
+  /// @brief Set "max_lateness" (ticks) and "timeout_ms" from the configuration
+  void configure(const nlohmann::json& config);
+
+  /**
+   * @brief Add a TP received on a link
+   *
+   * @param link[in] Index of the link, below n_links()
+   * @param input_tp[in] TP to add
+   * @return false if the TP was dropped, being too late to be output in order
+   */
+  bool add(size_t link, const TriggerPrimitive& input_tp);
+
+  /// @brief Add a block of TPs received on a link, see add()
+  void add(size_t link, span<const TriggerPrimitive> input_tps);
+
+  /**
+   * @brief Tell the zipper a link will send no TP earlier than time
+   *
+   * Lets the other links' TPs out while the link has nothing to send.
+   */
+  void heartbeat(size_t link, timestamp_t time);
+
+  /**
+   * @brief Output, in time order, the buffered TPs that are ready
+   *
+   * @param output_tps[out] Vector the TPs are appended to
+   */
+  void drain(std::vector<TriggerPrimitive>& output_tps);
+
+  /// @brief Output the buffered TPs up to until, whether they are ready or not
+  void flush(timestamp_t until, std::vector<TriggerPrimitive>& output_tps);
+
+  /// @brief Output all of the buffered TPs
+  void flush(std::vector<TriggerPrimitive>& output_tps)
+  {
+    flush(std::numeric_limits<timestamp_t>::max(), output_tps);
+  }
+
+  /**
+   * @brief Output all of the buffered TPs if no TP was added for the timeout
+   *
+   * @return true if the timeout had passed
+   */
+  bool flush_on_timeout(std::vector<TriggerPrimitive>& output_tps,
+                        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+  size_t n_links() const { return m_links.size(); }
+  /// Number of TPs waiting in the zipper
+  size_t n_buffered() const { return m_n_buffered; }
+  timestamp_t max_lateness() const { return m_max_lateness; }
+
+  /// @brief Counts of the TPs through the zipper
+  struct Stats
+  {
+    uint64_t n_added = 0;
+    uint64_t n_output = 0;
+    /// TPs earlier than the previous TP or heartbeat of their link, still output in order
+    uint64_t n_late = 0;
+    /// TPs earlier than the last TP output, not output
+    uint64_t n_dropped = 0;
+    /// TPs output by the max lateness rule, ahead of a quiet link
+    uint64_t n_forced = 0;
+    uint64_t n_timeouts = 0;
+  };
+
+  const Stats& stats() const { return m_stats; }
+
+private:
+  // Number of output TPs a link buffer holds on to before they are erased
+  static constexpr size_t s_compact_threshold = 1024;
+
+  // Buffered TPs of a link, in time order from head
+  struct Link
+  {
+    std::vector<TriggerPrimitive> tps;
+    size_t head = 0;
+    // Latest time the link sent a TP or heartbeat for
+    timestamp_t watermark = 0;
+
+    bool empty() const { return head == tps.size(); }
+    timestamp_t head_time() const { return tps[head].time_start; }
+  };
+
+  // Heap entry for a non-empty link, keyed by its earliest TP
+  struct HeapEntry
+  {
+    timestamp_t time;
+    size_t link;
+    bool operator>(const HeapEntry& other) const { return time > other.time; }
+  };
+
+  void advance_watermark(Link& link, timestamp_t time);
+  // Move the earliest buffered TP into output_tps
+  void output_front(std::vector<TriggerPrimitive>& output_tps);
+  // Restore the heap order after the key of m_heap[idx] grew
+  void sift_down(size_t idx);
+
+  std::vector<Link> m_links;
+  std::vector<HeapEntry> m_heap;
+  // Lowest (possibly out of date, so only ever too low) and highest
+  // watermark over the links
+  timestamp_t m_min_watermark = 0;
+  timestamp_t m_max_watermark = 0;
+  // Time of the last TP output
+  timestamp_t m_output_time = 0;
+  size_t m_n_buffered = 0;
+
+  timestamp_t m_max_lateness = s_default_max_lateness;
+  std::chrono::milliseconds m_timeout = s_default_timeout;
+  // When flush_on_timeout() last saw TPs added (checked by count rather than
+  // reading the clock on every add())
+  std::chrono::steady_clock::time_point m_last_progress_time = std::chrono::steady_clock::now();
+  uint64_t m_n_added_at_last_check = 0;
+
+  Stats m_stats;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_TPZIPPER_HPP_
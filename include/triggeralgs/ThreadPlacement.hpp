@@ -0,0 +1,69 @@
+/**
+ * @file ThreadPlacement.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_THREADPLACEMENT_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_THREADPLACEMENT_HPP_
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Where a worker thread runs and allocates, and what it is called
+ *
+ * Set up from a placement object:
+ *  - "cpus": list of the CPUs the thread may run on
+ *  - "numa_node": NUMA node the thread allocates from, and runs on if no
+ *    "cpus" are given
+ *  - "name": thread name, shown by top -H and perf (15 characters at most)
+ *
+ * apply() is called by the thread itself as it starts, before it touches
+ * the buffers it works on: ShardedTARunner and TriggerPipeline threads
+ * then build and configure their makers and allocate their queues, so
+ * these are first touched, and allocated, on the thread's node. Anything
+ * left out of the configuration is left to the OS. Placement is only supported on Linux; elsewhere only the
+ * name is set.
+ */
+class ThreadPlacement
+{
+public:
+  /**
+   * @brief Read a placement object
+   *
+   * @param config[in] Placement object, or null for none
+   * @param default_name[in] Name of the thread if the config gives none
+   */
+  void configure(const nlohmann::json& config, const std::string& default_name);
+
+  /**
+   * @brief Place and name the calling thread
+   *
+   * @return false if the OS refused part of the placement, which is logged
+   */
+  bool apply() const;
+
+  const std::vector<int>& cpus() const { return m_cpus; }
+  int numa_node() const { return m_numa_node; }
+  const std::string& name() const { return m_name; }
+
+  /// @return the number of NUMA nodes of the host, 1 if unknown
+  static int n_numa_nodes();
+  /// @return the CPUs of a NUMA node, empty if unknown
+  static std::vector<int> cpus_of_node(int node);
+
+private:
+  std::vector<int> m_cpus;
+  int m_numa_node = -1;
+  std::string m_name;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_THREADPLACEMENT_HPP_
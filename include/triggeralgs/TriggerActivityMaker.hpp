@@ -11,6 +11,12 @@
 
 #include "triggeralgs/Issues.hpp"
 #include "triggeralgs/Logging.hpp"
+#include "triggeralgs/ObjectPool.hpp"
+#include "triggeralgs/OutputSink.hpp"
+#include "triggeralgs/PostProcessor.hpp"
+#include "triggeralgs/SlidingWindow.hpp"
+#include "triggeralgs/Span.hpp"
+#include "triggeralgs/TPFilter.hpp"
 #include "triggeralgs/TriggerActivity.hpp"
 #include "triggeralgs/TriggerPrimitive.hpp"
 #include "triggeralgs/Types.hpp"
@@ -43,6 +49,110 @@ public:
     postprocess(output_ta);
   }
 
+  /// @brief Same as operator()(input_tp, output_ta), emitting the TAs into a sink
+  void operator()(const TriggerPrimitive& input_tp, OutputSink<TriggerActivity>& sink)
+  {
+    (*this)(input_tp, m_output_staging);
+    emit_output(m_output_staging, sink);
+  }
+
+  /// @brief Same as process_batch(input_tps, output_ta), emitting the TAs into a sink
+  void process_batch_to(span<const TriggerPrimitive> input_tps, OutputSink<TriggerActivity>& sink)
+  {
+    process_batch(input_tps, m_output_staging);
+    emit_output(m_output_staging, sink);
+  }
+
+  /**
+   * @brief Move the TAs of output_ta into sink, leaving output_ta empty
+   *
+   * TAs the sink refuses are counted in m_n_output_rejected and recycled.
+   */
+  void emit_output(std::vector<TriggerActivity>& output_ta, OutputSink<TriggerActivity>& sink)
+  {
+    for (TriggerActivity& ta : output_ta) {
+      if (!sink.emit(std::move(ta))) {
+        ++m_n_output_rejected;
+        recycle(std::move(ta));
+      }
+    }
+    output_ta.clear();
+  }
+
+  /**
+   * @brief Batch TP processing over a contiguous block of TPs
+   *
+   * Equivalent to calling operator() on every TP of the block, except that
+   * the TAs made are postprocessed once per block. As with operator(), the
+   * output vector is expected to only hold the TAs made by this call.
+   *
+   * The TPs are filtered with accept_tp(), ie the default preprocess(), and
+   * the runs of accepted TPs are handed to process_accepted(). Makers
+   * customising preprocess() should override this too.
+   *
+   * @param input_tps[in] Block of input TPs, time ordered
+   * @param output_ta[out] Output vector of TAs to fill by the algorithm
+   */
+  virtual void process_batch(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta)
+  {
+    size_t run_start = 0;
+    for (size_t idx = 0; idx < input_tps.size(); ++idx) {
+      if (accept_tp(input_tps[idx])) {
+        continue;
+      }
+      if (idx > run_start) {
+        process_accepted(input_tps.subspan(run_start, idx - run_start), output_ta);
+      }
+      run_start = idx + 1;
+    }
+    if (run_start < input_tps.size()) {
+      process_accepted(input_tps.subspan(run_start), output_ta);
+    }
+
+    postprocess(output_ta);
+  }
+
+  /**
+   * @brief Batch TP processing over a received TP buffer, filtered in place
+   *
+   * The TP filter chain is run over the whole buffer first (vectorised where
+   * the CPU allows, see TPFilter::compact), which moves the accepted TPs to
+   * the front of the buffer. Only those reach process_accepted(). The
+   * contents of the buffer are overwritten.
+   *
+   * As with process_batch(), this is the default preprocess() filtering:
+   * makers customising preprocess() should override this too.
+   *
+   * @param input_tps[in,out] Buffer of input TPs, time ordered
+   * @param output_ta[out] Output vector of TAs to fill by the algorithm
+   */
+  virtual void process_buffer(span<TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta)
+  {
+    size_t n_accepted = m_tp_filter.compact(input_tps);
+    if (n_accepted > 0) {
+      process_accepted(span<const TriggerPrimitive>(input_tps.data(), n_accepted), output_ta);
+    }
+
+    postprocess(output_ta);
+  }
+
+  /**
+   * @brief Processing of a run of TPs that already passed the TP filters
+   *
+   * The default implementation calls process() on each TP. Algorithms on the
+   * hot path override it to run their window logic over the whole run
+   * without the per-TP virtual dispatch. No postprocessing is done here.
+   *
+   * @param input_tps[in] Accepted input TPs, time ordered
+   * @param output_ta[out] Output vector of TAs to fill by the algorithm
+   */
+  virtual void process_accepted(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta)
+  {
+    for (const TriggerPrimitive& input_tp : input_tps) {
+      process(input_tp, output_ta);
+    }
+  }
+
   /**
    * @brief TP processing function that creates & fills TAs
    *
@@ -55,57 +165,74 @@ public:
    * @brief TP pre-processing/filtering
    *
    * Takes a TP and returns true or false depending whether we want to process
-   * that TP into a TA algorithm.
-   *
-   * @todo: Implement tp-filtering, e.g. TOT, plane, channel and whatnot
-   * @todo: Implement something smarter & more efficient if no filtering: vector of functions, or c-o-c
+   * that TP into a TA algorithm. By default applies the TP filter chain set
+   * up in configure(), see TPFilter.
    *
    * @param[in] intput_tp input TP reference for filtering
    * @return bool true if we want to keep the TP
    */
   virtual bool preprocess(const TriggerPrimitive& input_tp)
   {
-    if (input_tp.time_over_threshold > m_max_time_over_threshold) {
-      return false;
-    }
-
-    return true;
+    return accept_tp(input_tp);
   }
 
   /**
    * @brief Post-processing/filtering of the TAs, e.g. prescale
    *
    * Takes a vector of TAs and removes ones that we want to filter out, e.g.
-   * based on prescaling.
-   *
-   * @todo: Like in preprocessing: implement something more efficient, e.g. vec of tasks
+   * based on prescaling. By default applies the configured PostProcessor
+   * stages in a single in-place pass.
    *
    * @param output_ta[out] output triggeractivity vector
    */
   virtual void postprocess(std::vector<TriggerActivity>& output_ta)
   {
-    // Don't post-process TAs if there's no TAs made.
-    if (output_ta.size() == 0) {
-      return;
-    }
+    m_post_processor(output_ta, [this](TriggerActivity&& ta) { recycle(std::move(ta)); });
+  }
 
-    // Apply prescale by erasing TAs
-    if (m_prescale > 1) {
-      for (std::vector<TriggerActivity>::iterator iter = output_ta.begin(); iter != output_ta.end();) {
-        m_ta_count++;
+  /**
+   * @brief Give back a TA that is no longer needed
+   *
+   * The TA, with its TP buffer, goes back to the maker's pool and is reused
+   * for a later TA. Only to be called from the thread running the maker;
+   * other threads use recycle_from_any_thread().
+   *
+   * @param ta[in] TA to recycle
+   */
+  void recycle(TriggerActivity&& ta) { m_ta_pool.release(std::move(ta)); }
 
-        if (m_ta_count % m_prescale != 0) {
-          iter = output_ta.erase(iter);
-          continue;
-        }
+  /// @brief Thread-safe form of recycle(), for consumers of the TAs
+  void recycle_from_any_thread(TriggerActivity&& ta) { m_ta_pool.release_from_any_thread(std::move(ta)); }
 
-        TLOG(TLVL_DEBUG_10) << "Emitting prescaled TriggerActivity " << (m_ta_count-1);
-        ++iter;
-      }
-    }
-  }
+  /**
+   * @brief Close the windows that no TP at or after until can extend
+   *
+   * Called by the owner of the maker on a heartbeat or watermark, when it
+   * knows no TP earlier than until is still to come. The algorithm
+   * evaluates its windows that end before until, outputs the TAs they make
+   * (postprocessed as in operator()) and drops them, so a stall on the input
+   * does not hold back TAs already complete. Flushing never makes a TA
+   * that the next TP at or after until would not have made. The one
+   * exception is TAMakerBundleNAlgorithm configured with
+   * "flush_partial_bundles", which then sends out its partial bundle.
+   *
+   * @param until[in] Time up to which the input is complete
+   * @param output_ta[out] Output vector of TAs to fill by the algorithm
+   */
+  virtual void flush(timestamp_t /* until */, std::vector<TriggerActivity>& /* output_ta */) {}
+
+  /**
+   * @brief Switch the algorithm in or out of its degraded mode
+   *
+   * Called by LoadShedder while the input of the maker is overloaded.
+   * Algorithms with a cheaper, less selective form of their checks use it
+   * while m_degraded is set; the others carry on as normal.
+   *
+   * @param degraded[in] Whether to run degraded
+   */
+  virtual void set_degraded(bool degraded) { m_degraded = degraded; }
+  bool is_degraded() const { return m_degraded; }
 
-  virtual void flush(timestamp_t /* until */, std::vector<TriggerActivity>&) {}
   virtual void configure(const nlohmann::json& config) 
   {
     // Don't do anyting if the config does not exist
@@ -113,25 +240,85 @@ public:
       return;
     }
 
-    if (config.contains("prescale"))
-      m_prescale = config["prescale"];
     if (config.contains("max_time_over_threshold"))
       m_max_time_over_threshold = config["max_time_over_threshold"];
 
+    m_tp_filter.configure(config);
+    m_post_processor.configure(config);
+
     TLOG() << "[TAM]: max tot   : " << m_max_time_over_threshold;
-    TLOG() << "[TAM]: prescale  : " << m_prescale;
+    TLOG() << "[TAM]: prescale  : " << m_post_processor.prescale();
   }
   
+  /**
+   * @brief Non-virtual form of the default TP filtering in preprocess()
+   *
+   * Used by the process_batch() overrides, which filter TPs inline rather
+   * than through a virtual call per TP.
+   *
+   * @param[in] input_tp input TP reference for filtering
+   * @return bool true if we want to keep the TP
+   */
+  bool accept_tp(const TriggerPrimitive& input_tp) const
+  {
+    return m_tp_filter(input_tp);
+  }
+
   std::atomic<uint64_t> m_data_vs_system_time = 0;
   std::atomic<uint64_t> m_initial_offset = 0;
 
-  /// @brief Configurable prescale factor
-  uint64_t m_prescale = 1;
-  /// @brief TA made count for prescaling
-  uint64_t m_ta_count = 0;
+  /// @brief Post-processing stages (prescale, input count, ADC, time span)
+  PostProcessor<TriggerActivity> m_post_processor;
 
-  /// @brief Time-over-threshold TP filtering
+  /// @brief Time-over-threshold TP filtering, applied as part of m_tp_filter
   uint32_t m_max_time_over_threshold = std::numeric_limits<uint32_t>::max();
+
+  /// @brief TP filter chain (ToT, ADC, channel, plane, detid)
+  TPFilter m_tp_filter;
+
+  /// @brief Recycled TAs, with their TP buffers, for the TAs made by the algorithms
+  ObjectPool<TriggerActivity> m_ta_pool;
+
+  /// @brief Number of TAs refused by an OutputSink, see emit_output()
+  uint64_t m_n_output_rejected = 0;
+
+protected:
+  /// TAs made for a sink, before they are handed on.
+  /// Only ever holds the output of one call, and keeps its capacity.
+  std::vector<TriggerActivity> m_output_staging;
+
+  /// Set while the maker runs in its degraded mode, see set_degraded()
+  bool m_degraded = false;
+
+  /**
+   * @brief Hand a window's TPs over to the TA being emitted
+   *
+   * The window's buffer is moved into ta.inputs, without copying any TP,
+   * and the window is left with an empty buffer: the previous one of
+   * ta.inputs if it had any capacity, else a recycled one from the pool
+   * (see ObjectPool::acquire_inputs()). The window is expected to be reset or cleared straight after.
+   *
+   * @param window_inputs[in,out] TP buffer of the window
+   * @param ta[out] TA being emitted
+   */
+  void move_window_inputs(std::vector<TriggerPrimitive>& window_inputs, TriggerActivity& ta)
+  {
+    ta.inputs.clear();
+    if (ta.inputs.capacity() == 0) {
+      ta.inputs = m_ta_pool.acquire_inputs();
+    }
+    ta.inputs.swap(window_inputs);
+  }
+
+  /// @brief Same as move_window_inputs(vector, ta), for the TPs of a SlidingWindow, which is left empty
+  template<class... Stats>
+  void move_window_inputs(SlidingWindow<TriggerPrimitive, Stats...>& window, TriggerActivity& ta)
+  {
+    if (ta.inputs.capacity() == 0) {
+      ta.inputs = m_ta_pool.acquire_inputs();
+    }
+    window.take_inputs(ta.inputs);
+  }
 };
 
 } // namespace triggeralgs
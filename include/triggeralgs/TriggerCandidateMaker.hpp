@@ -11,6 +11,10 @@
 
 #include "triggeralgs/Issues.hpp"
 #include "triggeralgs/Logging.hpp"
+#include "triggeralgs/ObjectPool.hpp"
+#include "triggeralgs/OutputSink.hpp"
+#include "triggeralgs/PostProcessor.hpp"
+#include "triggeralgs/Span.hpp"
 #include "triggeralgs/TriggerActivity.hpp"
 #include "triggeralgs/TriggerCandidate.hpp"
 #include "triggeralgs/Types.hpp"
@@ -43,6 +47,85 @@ public:
     postprocess(output_tc);
   }
 
+  /**
+   * @brief Same as operator()(const TriggerActivity&, ...), taking over the TA
+   *
+   * For callers that own their TAs: makers keeping TAs in a window move the
+   * TA, and its TPs, in rather than copying it.
+   */
+  void operator()(TriggerActivity&& input_ta, std::vector<TriggerCandidate>& output_tc)
+  {
+    if (!preprocess(input_ta)) {
+      return;
+    }
+
+    process(std::move(input_ta), output_tc);
+
+    postprocess(output_tc);
+  }
+
+  /// @brief Same as operator()(input_ta, output_tc), emitting the TCs into a sink
+  void operator()(const TriggerActivity& input_ta, OutputSink<TriggerCandidate>& sink)
+  {
+    (*this)(input_ta, m_output_staging);
+    emit_output(m_output_staging, sink);
+  }
+
+  /// @brief Same as operator()(input_ta, output_tc), taking over the TA and emitting the TCs into a sink
+  void operator()(TriggerActivity&& input_ta, OutputSink<TriggerCandidate>& sink)
+  {
+    (*this)(std::move(input_ta), m_output_staging);
+    emit_output(m_output_staging, sink);
+  }
+
+  /// @brief Same as process_batch(input_tas, output_tc), emitting the TCs into a sink
+  void process_batch_to(span<const TriggerActivity> input_tas, OutputSink<TriggerCandidate>& sink)
+  {
+    process_batch(input_tas, m_output_staging);
+    emit_output(m_output_staging, sink);
+  }
+
+  /**
+   * @brief Move the TCs of output_tc into sink, leaving output_tc empty
+   *
+   * TCs the sink refuses are counted in m_n_output_rejected and recycled.
+   */
+  void emit_output(std::vector<TriggerCandidate>& output_tc, OutputSink<TriggerCandidate>& sink)
+  {
+    for (TriggerCandidate& tc : output_tc) {
+      if (!sink.emit(std::move(tc))) {
+        ++m_n_output_rejected;
+        recycle(std::move(tc));
+      }
+    }
+    output_tc.clear();
+  }
+
+  /**
+   * @brief Batch TA processing over a contiguous block of TAs
+   *
+   * Equivalent to calling operator() on every TA of the block, except that
+   * the TCs made are postprocessed once per block.
+   *
+   * The default implementation loops over the block. The windowed makers
+   * override it so that a block landing inside their current window has its
+   * thresholds evaluated once rather than per TA.
+   *
+   * @param input_tas[in] Block of input TAs
+   * @param output_tc[out] Output vector of TCs to fill by the algorithm
+   */
+  virtual void process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& output_tc)
+  {
+    for (const TriggerActivity& input_ta : input_tas) {
+      if (!preprocess(input_ta)) {
+        continue;
+      }
+      process(input_ta, output_tc);
+    }
+
+    postprocess(output_tc);
+  }
+
   /**
    * @brief TA processing function that creates & fills TCs
    *
@@ -51,6 +134,20 @@ public:
    */
   virtual void process(const TriggerActivity& input_ta, std::vector<TriggerCandidate>& output_tc) = 0;
 
+  /**
+   * @brief TA processing taking over the input TA
+   *
+   * The default forwards to process(const TriggerActivity&, ...). Makers
+   * storing the TAs they are given override it to move them instead.
+   *
+   * @param input_ta[in] Input TA for the triggering algorithm, left in a valid but unspecified state
+   * @param output_tc[out] Output vector of TCs to fill by the algorithm
+   */
+  virtual void process(TriggerActivity&& input_ta, std::vector<TriggerCandidate>& output_tc)
+  {
+    process(static_cast<const TriggerActivity&>(input_ta), output_tc);
+  }
+
   /**
    * @brief TA pre-processing/filtering
    *
@@ -60,44 +157,74 @@ public:
    * @param[in] intput_tp input TP reference for filtering
    * @return bool true if we want to keep the TP
    */
-  virtual bool preprocess(const TriggerActivity&)
+  virtual bool preprocess(const TriggerActivity& input_ta)
   {
-    return true;
+    return accept_ta(input_ta);
   }
 
   /**
    * @brief Post-processing/filtering of the TCs, e.g. prescale
    *
    * Takes a vector of TCs and removes ones that we want to filter out, e.g.
-   * based on prescaling.
-   *
-   * @todo: Like in preprocessing: implement something more efficient, e.g. vec of tasks
+   * based on prescaling. By default applies the configured PostProcessor
+   * stages in a single in-place pass.
    *
    * @param output_tc[out] output trigger candidate vector
    */
   virtual void postprocess(std::vector<TriggerCandidate>& output_tc)
   {
-    // Don't post-process TCs if there's no TCs made.
-    if (output_tc.size() == 0) {
-      return;
-    }
+    m_post_processor(output_tc, [this](TriggerCandidate&& tc) { recycle(std::move(tc)); });
+  }
 
-    // Apply prescale by erasing TCs
-    if (m_prescale > 1) {
-      for (std::vector<TriggerCandidate>::iterator iter = output_tc.begin(); iter != output_tc.end();) {
-        m_tc_count++;
+  /**
+   * @brief Give back a TC that is no longer needed
+   *
+   * The TC, with its TA buffer, goes back to the maker's pool and is reused
+   * for a later TC. Only to be called from the thread running the maker;
+   * other threads use recycle_from_any_thread().
+   *
+   * @param tc[in] TC to recycle
+   */
+  void recycle(TriggerCandidate&& tc) { m_tc_pool.release(std::move(tc)); }
 
-        if (m_tc_count % m_prescale != 0) {
-          iter = output_tc.erase(iter);
-          continue;
-        }
+  /// @brief Thread-safe form of recycle(), for consumers of the TCs
+  void recycle_from_any_thread(TriggerCandidate&& tc) { m_tc_pool.release_from_any_thread(std::move(tc)); }
 
-        TLOG_DEBUG(TLVL_DEBUG_10) << "Emitting prescaled TriggerCandidate " << (m_tc_count-1);
-        ++iter;
-      }
+  /**
+   * @brief Close the windows that no TA starting at or after until can extend
+   *
+   * Same contract as TriggerActivityMaker::flush(): the windows ending
+   * before until are evaluated with the algorithm's thresholds, the TCs they
+   * make are output (postprocessed) and the windows dropped, so no TC is
+   * output twice. Usually called through advance_watermark().
+   *
+   * @param until[in] Start time up to which the input TAs are complete
+   * @param output_tc[out] Output vector of TCs to fill by the algorithm
+   */
+  virtual void flush(timestamp_t /* until */, std::vector<TriggerCandidate>& /* output_tc */) {}
+
+  /**
+   * @brief Flush the windows up to watermark - m_watermark_lag
+   *
+   * watermark is the time up to which the TA maker upstream has seen its
+   * input (eg the until it was flushed with). A TA starts at the start of
+   * the TA window it was made from, so it can still arrive with a start time
+   * up to the TA window length before the watermark: m_watermark_lag should
+   * cover that. The TC latency is then bounded by the TC window length plus
+   * the lag. The watermark never moves backwards.
+   *
+   * @param watermark[in] Time up to which the TP input is complete
+   * @param output_tc[out] Output vector of TCs to fill by the algorithm
+   */
+  void advance_watermark(timestamp_t watermark, std::vector<TriggerCandidate>& output_tc)
+  {
+    if (watermark <= m_watermark_lag || watermark - m_watermark_lag <= m_watermark) {
+      return;
     }
+    m_watermark = watermark - m_watermark_lag;
+    flush(m_watermark, output_tc);
   }
-  virtual void flush(timestamp_t /* until */, std::vector<TriggerCandidate>& /* output_tc */) {}
+
   virtual void configure(const nlohmann::json& config)
   {
     // Don't do anyting if the config does not exist
@@ -105,19 +232,45 @@ public:
       return;
     }
 
-    if (config.contains("prescale"))
-      m_prescale = config["prescale"];
+    if (config.contains("watermark_lag"))
+      m_watermark_lag = config["watermark_lag"];
+
+    m_post_processor.configure(config);
 
-    TLOG() << "[TCM]: prescale  : " << m_prescale;
+    TLOG() << "[TCM]: prescale  : " << m_post_processor.prescale();
+    TLOG() << "[TCM]: watermark lag : " << m_watermark_lag;
+  }
+
+  /**
+   * @brief Non-virtual form of the default TA filtering in preprocess(), for
+   * use in the process_batch() overrides
+   */
+  bool accept_ta(const TriggerActivity&) const
+  {
+    return true;
   }
 
   std::atomic<uint64_t> m_data_vs_system_time = 0;
   std::atomic<uint64_t> m_initial_offset = 0;  
 
-  /// @brief Configurable prescale factor
-  uint64_t m_prescale = 1;
-  /// @brief TC made count for prescaling
-  uint64_t m_tc_count = 0;
+  /// @brief Configurable lag of the flush time behind the watermark, see advance_watermark()
+  timestamp_t m_watermark_lag = 0;
+  /// @brief Time the windows were last flushed up to by advance_watermark()
+  timestamp_t m_watermark = 0;
+
+  /// @brief Post-processing stages (prescale, input count, ADC, time span)
+  PostProcessor<TriggerCandidate> m_post_processor;
+
+  /// @brief Recycled TCs, with their TA buffers, for the TCs made by the algorithms
+  ObjectPool<TriggerCandidate> m_tc_pool;
+
+  /// @brief Number of TCs refused by an OutputSink, see emit_output()
+  uint64_t m_n_output_rejected = 0;
+
+protected:
+  /// TCs made for a sink, before they are handed on. Only ever holds the
+  /// output of one call, and keeps its capacity.
+  std::vector<TriggerCandidate> m_output_staging;
 };
 
 } // namespace triggeralgs
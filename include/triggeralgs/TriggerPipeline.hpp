@@ -0,0 +1,204 @@
+/**
+ * @file TriggerPipeline.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_TRIGGERPIPELINE_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_TRIGGERPIPELINE_HPP_
+
+#include "triggeralgs/LoadShedder.hpp"
+#include "triggeralgs/SPSCQueue.hpp"
+#include "triggeralgs/Span.hpp"
+#include "triggeralgs/ThreadPlacement.hpp"
+#include "triggeralgs/TriggerActivityMaker.hpp"
+#include "triggeralgs/TriggerCandidateMaker.hpp"
+#include "triggeralgs/TriggerDecisionMaker.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Runs the TP → TA → TC → TD chain, one thread per stage
+ *
+ * configure() builds the makers from the factories: the TA maker
+ * "ta_algorithm", the TC maker "tc_algorithm" and the TD maker
+ * "td_algorithm" (default "TDMakerSupernovaAlgorithm"), configured with
+ * "ta_config", "tc_config" and "td_config". Each maker runs on its own
+ * thread, and the stages hand their output on in batches through bounded
+ * lock-free SPSCQueues of "queue_size" batches. A stage with no input
+ * sleeps until the next batch comes.
+ *
+ * The TC and TD stages give the TAs and TCs they are done with back to the
+ * pool of the maker that made them, see recycle_from_any_thread().
+ *
+ * A stage whose downstream queue is full waits for room, so a slow stage
+ * holds back the ones before it, up to push(): the caller is held back
+ * too, or told with try_push(). heartbeat() flushes the TA maker and
+ * advances the watermark of the TC maker (see
+ * TriggerCandidateMaker::advance_watermark()) once the stages before have
+ * caught up. stop() drains the pipeline: every stage flushes its maker
+ * to the end before passing the end of the input on.
+ *
+ * A TA maker falling behind can shed load with the "load_shedding"
+ * policies, see LoadShedder: push() applies "drop_newest", and the TA
+ * stage the other policies on the batches it takes.
+ *
+ * The stage threads are named "pipeline-ta", "pipeline-tc" and
+ * "pipeline-td", and can be placed on CPUs and NUMA nodes with the "ta",
+ * "tc" and "td" objects of "placement", see ThreadPlacement. Each stage
+ * thread places itself before building and configuring its maker and
+ * allocating its input queue, so they live on its node.
+ *
+ * One thread calls push(), heartbeat(), drain() and stop().
+ */
+class TriggerPipeline
+{
+public:
+  TriggerPipeline() = default;
+  TriggerPipeline(const TriggerPipeline&) = delete;
+  TriggerPipeline& operator=(const TriggerPipeline&) = delete;
+  /// @brief Stops the stage threads, dropping the TDs not yet drained
+  ~TriggerPipeline();
+
+  /// @brief Build and configure the makers, and start the stage threads
+  void configure(const nlohmann::json& config);
+
+  /**
+   * @brief Hand a block of TPs to the TA stage, waiting for room if need be
+   *
+   * Only between configure() and stop(): throws BadConfiguration otherwise,
+   * as do try_push() and heartbeat().
+   *
+   * @param input_tps[in] Block of input TPs, time ordered across blocks
+   */
+  void push(span<const TriggerPrimitive> input_tps);
+
+  /// @brief Same as push(), but gives up if the TA stage has no room
+  /// @return false if the TPs were not taken; TPs dropped by the load shedding count as taken
+  bool try_push(span<const TriggerPrimitive> input_tps);
+
+  /// @brief Tell the pipeline no TP earlier than until is still to come
+  void heartbeat(timestamp_t until);
+
+  /**
+   * @brief Take the TDs made so far
+   *
+   * @param output_td[out] Vector the TDs are appended to
+   */
+  void drain(std::vector<TriggerDecision>& output_td);
+
+  /**
+   * @brief Flush every stage, stop the threads and take the remaining TDs
+   *
+   * The pipeline takes no more TPs until configured again.
+   *
+   * @param output_td[out] Vector the TDs are appended to
+   */
+  void stop(std::vector<TriggerDecision>& output_td);
+
+  /// @brief Counts of the objects through the pipeline
+  struct Stats
+  {
+    uint64_t n_tps = 0;
+    uint64_t n_tas = 0;
+    uint64_t n_tcs = 0;
+    uint64_t n_tds = 0;
+    /// Times push() found the TA stage's queue full
+    uint64_t n_input_full = 0;
+    /// Times a stage found the queue to the next stage full
+    uint64_t n_stage_full = 0;
+    /// TAs and TCs made from an object the next stage gave back
+    uint64_t n_ta_reused = 0;
+    uint64_t n_tc_reused = 0;
+    /// What the load shedding policies dropped
+    LoadShedder::Stats shedding;
+  };
+
+  /// @brief Counts so far; the stage counts may lag behind while running
+  Stats stats() const;
+
+private:
+  // A batch of objects handed from one stage to the next
+  template<class Object>
+  struct Batch
+  {
+    std::vector<Object> objects;
+    // Time up to which the input is complete, set on a heartbeat
+    timestamp_t watermark = 0;
+    bool heartbeat = false;
+    // Last batch: the stage has flushed its maker to the end
+    bool end = false;
+    // When push() queued the batch, with load shedding on
+    std::chrono::steady_clock::time_point pushed;
+  };
+
+  template<class Object>
+  using BatchQueue = SPSCQueue<Batch<Object>>;
+
+  // Start a stage thread: placed, it runs setup, then run once every stage is set up
+  template<class Setup>
+  std::thread start_stage(const ThreadPlacement& placement,
+                          Setup&& setup,
+                          void (TriggerPipeline::*run)(),
+                          std::vector<std::future<void>>& ready,
+                          std::shared_future<bool> started);
+  void run_ta_stage();
+  void run_tc_stage();
+  void run_td_stage();
+  // Hand a batch to the next stage, waiting while its queue is full
+  template<class Object>
+  void forward(BatchQueue<Object>& queue, Batch<Object>&& batch);
+  void send(Batch<TriggerPrimitive>&& batch);
+  // Take the TDs of a batch out of the TD stage
+  void receive(Batch<TriggerDecision>& batch, std::vector<TriggerDecision>& output_td);
+  // Make a batch of TPs for the TA stage, false if the load shedding drops it
+  bool make_batch(span<const TriggerPrimitive> input_tps, Batch<TriggerPrimitive>& batch);
+  // Throw BadConfiguration unless the stage threads are running
+  void check_running() const;
+  void stop_threads();
+
+  std::unique_ptr<TriggerActivityMaker> m_ta_maker;
+  std::unique_ptr<TriggerCandidateMaker> m_tc_maker;
+  std::unique_ptr<TriggerDecisionMaker> m_td_maker;
+  LoadShedder m_load_shedder;
+  ThreadPlacement m_ta_placement;
+  ThreadPlacement m_tc_placement;
+  ThreadPlacement m_td_placement;
+
+  std::unique_ptr<BatchQueue<TriggerPrimitive>> m_tp_queue;
+  std::unique_ptr<BatchQueue<TriggerActivity>> m_ta_queue;
+  std::unique_ptr<BatchQueue<TriggerCandidate>> m_tc_queue;
+  std::unique_ptr<BatchQueue<TriggerDecision>> m_td_queue;
+
+  std::thread m_ta_thread;
+  std::thread m_tc_thread;
+  std::thread m_td_thread;
+  // TDs taken out by push() while waiting for room, for the next drain()
+  std::vector<TriggerDecision> m_drained;
+  // Whether the end batch came out of the TD stage
+  bool m_ended = false;
+
+  uint64_t m_n_tps = 0;
+  uint64_t m_n_tds = 0;
+  uint64_t m_n_input_full = 0;
+  std::atomic<uint64_t> m_n_tas = 0;
+  std::atomic<uint64_t> m_n_tcs = 0;
+  std::atomic<uint64_t> m_n_stage_full = 0;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_TRIGGERPIPELINE_HPP_
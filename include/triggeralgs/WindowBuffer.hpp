@@ -0,0 +1,129 @@
+/**
+ * @file WindowBuffer.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_WINDOWBUFFER_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_WINDOWBUFFER_HPP_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace triggeralgs {
+
+/**
+ * @brief Time ordered contents of a sliding window, added at the back and expired from the front
+ *
+ * A growable buffer in which push_back() and pop_front() are amortised
+ * O(1): expiring objects only moves the head of the live range along. The
+ * expired objects are dropped in one go once they outnumber the live ones,
+ * so each is moved at most once, and the buffer never holds more than about
+ * twice the live objects.
+ *
+ * Unlike a wrapping ring buffer the live objects stay contiguous, so they
+ * can be iterated over as a plain range, and storage() hands the buffer
+ * itself over to a trigger object without copying (see
+ * TriggerActivityMaker::move_window_inputs()).
+ */
+template<class Object>
+class WindowBuffer
+{
+public:
+  using value_type = Object;
+  using iterator = typename std::vector<Object>::iterator;
+  using const_iterator = typename std::vector<Object>::const_iterator;
+
+  WindowBuffer() = default;
+  WindowBuffer(const WindowBuffer&) = default;
+  WindowBuffer& operator=(const WindowBuffer&) = default;
+  // A moved-from buffer is left empty
+  WindowBuffer(WindowBuffer&& other) noexcept
+    : m_objects(std::move(other.m_objects))
+    , m_head(std::exchange(other.m_head, 0))
+  {
+    other.m_objects.clear();
+  }
+  WindowBuffer& operator=(WindowBuffer&& other) noexcept
+  {
+    m_objects = std::move(other.m_objects);
+    m_head = std::exchange(other.m_head, 0);
+    other.m_objects.clear();
+    return *this;
+  }
+
+  bool empty() const { return m_head == m_objects.size(); }
+  size_t size() const { return m_objects.size() - m_head; }
+
+  iterator begin() { return m_objects.begin() + m_head; }
+  iterator end() { return m_objects.end(); }
+  const_iterator begin() const { return m_objects.begin() + m_head; }
+  const_iterator end() const { return m_objects.end(); }
+
+  Object& front() { return m_objects[m_head]; }
+  const Object& front() const { return m_objects[m_head]; }
+  Object& back() { return m_objects.back(); }
+  const Object& back() const { return m_objects.back(); }
+  /// Pointer to the oldest live object, the live objects being contiguous
+  const Object* data() const { return m_objects.data() + m_head; }
+  Object& operator[](size_t idx) { return m_objects[m_head + idx]; }
+  const Object& operator[](size_t idx) const { return m_objects[m_head + idx]; }
+
+  void push_back(const Object& object) { m_objects.push_back(object); }
+  void push_back(Object&& object) { m_objects.push_back(std::move(object)); }
+
+  /// @brief Insert before position, moving the later objects along
+  iterator insert(const_iterator position, Object&& object) { return m_objects.insert(position, std::move(object)); }
+
+  /// @brief Expire the n oldest objects
+  void pop_front(size_t n = 1)
+  {
+    m_head += n;
+    if (m_head == m_objects.size()) {
+      clear();
+    } else if (m_head > m_objects.size() - m_head) {
+      compact();
+    }
+  }
+
+  /// @brief Empty the buffer, keeping its capacity
+  void clear()
+  {
+    m_objects.clear();
+    m_head = 0;
+  }
+
+  void reserve(size_t capacity) { m_objects.reserve(capacity); }
+
+  /**
+   * @brief The underlying vector, holding only the live objects
+   *
+   * The buffer may be modified through it, eg swapped with another vector.
+   */
+  std::vector<Object>& storage()
+  {
+    compact();
+    return m_objects;
+  }
+
+private:
+  // Drop the expired objects at the front of the vector
+  void compact()
+  {
+    if (m_head > 0) {
+      m_objects.erase(m_objects.begin(), m_objects.begin() + m_head);
+      m_head = 0;
+    }
+  }
+
+  std::vector<Object> m_objects;
+  // Index of the oldest live object
+  size_t m_head = 0;
+};
+
+} // namespace triggeralgs
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_WINDOWBUFFER_HPP_
@@ -0,0 +1,341 @@
+/**
+ * @file WindowStats.hpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef TRIGGERALGS_INCLUDE_TRIGGERALGS_WINDOWSTATS_HPP_
+#define TRIGGERALGS_INCLUDE_TRIGGERALGS_WINDOWSTATS_HPP_
+
+#include "triggeralgs/ChannelOccupancy.hpp"
+#include "triggeralgs/TPColumns.hpp"
+#include "triggeralgs/TriggerActivity.hpp"
+#include "triggeralgs/TriggerPrimitive.hpp"
+#include "triggeralgs/Types.hpp"
+#include "triggeralgs/WindowBuffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Running statistics of a SlidingWindow, chosen at compile time
+ *
+ * A SlidingWindow<Element, Stats...> derives from each of its Stats, so
+ * their members are members of the window, and calls on each of them:
+ *  - on_add(element, position): element is inserted at position
+ *  - on_expire(element): element, the oldest, is expiring
+ *  - on_expired(elements): after expiry, with the elements left (non empty)
+ *  - on_clear(elements): the elements are all about to be dropped
+ *  - describe(os): print the statistic for operator<<
+ *
+ * Stat provides do-nothing defaults. The elements are TriggerPrimitive or
+ * TriggerActivity objects.
+ */
+namespace triggeralgs::window_stats {
+
+class Stat
+{
+public:
+  template<class Element>
+  void on_add(const Element&, size_t)
+  {
+  }
+  template<class Element>
+  void on_expire(const Element&)
+  {
+  }
+  template<class Element>
+  void on_expired(const WindowBuffer<Element>&)
+  {
+  }
+  template<class Element>
+  void on_clear(const WindowBuffer<Element>&)
+  {
+  }
+  void describe(std::ostream&) const {}
+};
+
+inline timestamp_t
+time_over_threshold_of(const TriggerPrimitive& tp)
+{
+  return tp.time_over_threshold;
+}
+
+/// Summed over the TPs of the TA, so O(TPs) per TA added or expired
+inline timestamp_t
+time_over_threshold_of(const TriggerActivity& ta)
+{
+  timestamp_t time_over_threshold = 0;
+  for (const TriggerPrimitive& tp : ta.inputs)
+    time_over_threshold += tp.time_over_threshold;
+  return time_over_threshold;
+}
+
+inline channel_t
+first_channel_of(const TriggerPrimitive& tp)
+{
+  return tp.channel;
+}
+
+inline channel_t
+last_channel_of(const TriggerPrimitive& tp)
+{
+  return tp.channel;
+}
+
+inline channel_t
+first_channel_of(const TriggerActivity& ta)
+{
+  return ta.channel_start;
+}
+
+inline channel_t
+last_channel_of(const TriggerActivity& ta)
+{
+  return ta.channel_end;
+}
+
+/// @brief Sum of the adc_integral of the elements
+class ADCSum : public Stat
+{
+public:
+  template<class Element>
+  void on_add(const Element& element, size_t)
+  {
+    adc_integral += element.adc_integral;
+  }
+  template<class Element>
+  void on_expire(const Element& element)
+  {
+    adc_integral -= element.adc_integral;
+  }
+  template<class Element>
+  void on_clear(const WindowBuffer<Element>&)
+  {
+    adc_integral = 0;
+  }
+  void describe(std::ostream& os) const { os << "Total of: " << adc_integral << " ADC counts.\n"; }
+
+  uint64_t adc_integral = 0;
+};
+
+/// @brief Sum of the time over threshold of the TPs
+class ToTSum : public Stat
+{
+public:
+  template<class Element>
+  void on_add(const Element& element, size_t)
+  {
+    time_over_threshold += time_over_threshold_of(element);
+  }
+  template<class Element>
+  void on_expire(const Element& element)
+  {
+    time_over_threshold -= time_over_threshold_of(element);
+  }
+  template<class Element>
+  void on_clear(const WindowBuffer<Element>&)
+  {
+    time_over_threshold = 0;
+  }
+  void describe(std::ostream& os) const { os << "Total of: " << time_over_threshold << " ticks over threshold.\n"; }
+
+  timestamp_t time_over_threshold = 0;
+};
+
+/**
+ * @brief Highest adc_peak of the elements
+ *
+ * Recomputed from the elements left when the peak expires, which happens
+ * about once per window length.
+ */
+class PeakADC : public Stat
+{
+public:
+  template<class Element>
+  void on_add(const Element& element, size_t)
+  {
+    adc_peak = std::max<uint32_t>(adc_peak, element.adc_peak);
+  }
+  template<class Element>
+  void on_expire(const Element& element)
+  {
+    m_stale |= element.adc_peak >= adc_peak;
+  }
+  template<class Element>
+  void on_expired(const WindowBuffer<Element>& elements)
+  {
+    if (m_stale) {
+      adc_peak = 0;
+      for (const Element& element : elements)
+        adc_peak = std::max<uint32_t>(adc_peak, element.adc_peak);
+      m_stale = false;
+    }
+  }
+  template<class Element>
+  void on_clear(const WindowBuffer<Element>&)
+  {
+    adc_peak = 0;
+    m_stale = false;
+  }
+  void describe(std::ostream& os) const { os << "Peak ADC: " << adc_peak << ".\n"; }
+
+  uint32_t adc_peak = 0;
+
+private:
+  bool m_stale = false;
+};
+
+/**
+ * @brief Lowest and highest channel of the elements (channel_start and channel_end of TAs)
+ *
+ * Recomputed from the elements left when an element at either end expires.
+ * Both are 0 for an empty window.
+ */
+class ChannelExtent : public Stat
+{
+public:
+  template<class Element>
+  void on_add(const Element& element, size_t)
+  {
+    if (m_empty) {
+      channel_min = first_channel_of(element);
+      channel_max = last_channel_of(element);
+      m_empty = false;
+      return;
+    }
+    channel_min = std::min(channel_min, first_channel_of(element));
+    channel_max = std::max(channel_max, last_channel_of(element));
+  }
+  template<class Element>
+  void on_expire(const Element& element)
+  {
+    m_stale |= first_channel_of(element) <= channel_min || last_channel_of(element) >= channel_max;
+  }
+  template<class Element>
+  void on_expired(const WindowBuffer<Element>& elements)
+  {
+    if (m_stale) {
+      channel_min = first_channel_of(elements.front());
+      channel_max = last_channel_of(elements.front());
+      for (const Element& element : elements) {
+        channel_min = std::min(channel_min, first_channel_of(element));
+        channel_max = std::max(channel_max, last_channel_of(element));
+      }
+      m_stale = false;
+    }
+  }
+  template<class Element>
+  void on_clear(const WindowBuffer<Element>&)
+  {
+    channel_min = 0;
+    channel_max = 0;
+    m_empty = true;
+    m_stale = false;
+  }
+  void describe(std::ostream& os) const { os << "Channels " << channel_min << " to " << channel_max << ".\n"; }
+
+  channel_t channel_min = 0;
+  channel_t channel_max = 0;
+
+private:
+  bool m_empty = true;
+  bool m_stale = false;
+};
+
+/**
+ * @brief Hit count per channel, in a ChannelOccupancy, and the number of channels hit
+ *
+ * A TA is summarised as it is added into its distinct channels and their
+ * hit counts, kept alongside it, so expiring it costs one update per
+ * channel it hit rather than one per TP.
+ */
+class ChannelCounts : public Stat
+{
+public:
+  using Stat::on_expired;
+
+  /// @brief Size the hit counts for channels [first_channel, first_channel + n_channels)
+  void set_channel_range(channel_t first_channel, uint32_t n_channels)
+  {
+    channel_states.set_range(first_channel, n_channels);
+  }
+
+  uint16_t n_channels_hit() const { return channel_states.n_channels_hit(); }
+
+  void on_add(const TriggerPrimitive& tp, size_t) { channel_states.add(tp.channel); }
+  void on_expire(const TriggerPrimitive& tp) { channel_states.remove(tp.channel); }
+  void on_clear(const WindowBuffer<TriggerPrimitive>& tps)
+  {
+    // Only the channels of the TPs in the window have a count to zero.
+    for (const TriggerPrimitive& tp : tps)
+      channel_states.remove(tp.channel);
+  }
+
+  void on_add(const TriggerActivity& ta, size_t position);
+  void on_expire(const TriggerActivity& ta);
+  void on_clear(const WindowBuffer<TriggerActivity>& tas);
+
+  void describe(std::ostream& os) const { os << n_channels_hit() << " independent channels have hits.\n"; }
+
+  ChannelOccupancy channel_states;
+
+private:
+  struct ChannelHits
+  {
+    channel_t channel;
+    uint16_t n_hits;
+  };
+  using ChannelSummary = std::vector<ChannelHits>;
+
+  // Take the channels of the summary off channel_states, keeping its buffer
+  void remove_channels(ChannelSummary& summary);
+
+  // Channel summary of each TA of the window, in the same order
+  WindowBuffer<ChannelSummary> m_channel_summaries;
+  // Buffers of the summaries of expired TAs, reused for the next ones
+  std::vector<ChannelSummary> m_spare_summaries;
+};
+
+/**
+ * @brief Copy of the TPs in TPColumns, for reduce() and column scans
+ *
+ * Costs a store per column for each TP added, so only worth it for windows
+ * reduced or scanned more than once per TP (eg for adjacency).
+ */
+class Columns : public Stat
+{
+public:
+  void on_add(const TriggerPrimitive& tp, size_t position)
+  {
+    if (position == tp_columns.size())
+      tp_columns.push_back(tp);
+    else
+      tp_columns.insert(position, tp);
+  }
+  // The expired TPs are dropped from the columns in one go
+  void on_expire(const TriggerPrimitive&) { ++m_n_expired; }
+  void on_expired(const WindowBuffer<TriggerPrimitive>&)
+  {
+    tp_columns.pop_front(m_n_expired);
+    m_n_expired = 0;
+  }
+  void on_clear(const WindowBuffer<TriggerPrimitive>&)
+  {
+    tp_columns.clear();
+    m_n_expired = 0;
+  }
+
+  TPColumns tp_columns;
+
+private:
+  size_t m_n_expired = 0;
+};
+
+} // namespace triggeralgs::window_stats
+
+#endif // TRIGGERALGS_INCLUDE_TRIGGERALGS_WINDOWSTATS_HPP_
@@ -21,14 +21,47 @@ class TAMakerDBSCANAlgorithm : public TriggerActivityMaker
 
 public:
   void process(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta);
+  void process_accepted(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta) override;
+  void flush(timestamp_t until, std::vector<TriggerActivity>& output_ta) override;
   
   void configure(const nlohmann::json &config);
+
+  /// @brief Counts of the reorder stage, see "reorder_window"
+  struct ReorderStats
+  {
+    /// TPs that arrived earlier than a TP already seen, and were put back in order
+    uint64_t n_reordered = 0;
+    /// TPs that arrived after a later TP had been clustered, and were dropped
+    uint64_t n_dropped = 0;
+    /// TPs clustered early because the buffer was full
+    uint64_t n_forced = 0;
+    /// Largest number of TPs held in the buffer
+    uint64_t max_depth = 0;
+  };
+
+  const ReorderStats& reorder_stats() const { return m_reorder_stats; }
   
 private:  
+  // Runs the clustering on a TP, in time order with the previous ones
+  void cluster_tp(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta);
+  // Clusters the buffered TPs earlier than until, in time order
+  void release_reordered(timestamp_t until, std::vector<TriggerActivity>& output_ta);
+  // Makes a TA out of each cluster in m_dbscan_clusters
+  void clusters_to_tas(std::vector<TriggerActivity>& output_ta);
+
   int m_eps{10};
   int m_min_pts{3}; // Minimum number of points to form a cluster
   timestamp_t m_first_timestamp{0};
   timestamp_t m_prev_timestamp{0};
+
+  // Reorder stage: TPs are held in a min-heap on time_start until the latest
+  // TP seen is m_reorder_window ticks past them. Disabled when the window is 0.
+  timestamp_t m_reorder_window{0};
+  size_t m_max_reorder_depth{10000};
+  timestamp_t m_latest_timestamp{0};
+  std::vector<TriggerPrimitive> m_reorder_buffer;
+  ReorderStats m_reorder_stats;
+
   std::vector<dbscan::Cluster> m_dbscan_clusters;
   std::unique_ptr<dbscan::IncrementalDBSCAN> m_dbscan;
 };
@@ -21,6 +21,7 @@ class TCMakerDBSCANAlgorithm : public TriggerCandidateMaker
 
 public:
   void process(const TriggerActivity& input_ta, std::vector<TriggerCandidate>& output_tc);
+  void process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& output_tcs) override;
   void configure(const nlohmann::json &config);
 
 private:
@@ -76,6 +76,10 @@ public:
     // previously added
     void add_hit(Hit* new_hit, std::vector<Cluster>* completed_clusters=nullptr);
 
+    // Declare that no hit earlier than `time` is still to come, and
+    // complete the clusters that no such hit could extend
+    void flush(float time, std::vector<Cluster>* completed_clusters=nullptr);
+
     void trim_hits();
 
     std::vector<Hit*> get_hits() const { return m_hits; }
@@ -83,6 +87,8 @@ public:
     std::map<int, Cluster> get_clusters() const { return m_clusters; }
 
     uint64_t get_first_prim_time() const { return m_first_prim_time; }
+    // Whether add_primitive() was called, ie get_first_prim_time() is set
+    bool has_primitives() const { return m_has_primitives; }
     
 private:
     //======================================================================
@@ -91,6 +97,10 @@ private:
     // to `cluster`
     void cluster_reachable(Hit* seed_hit, Cluster& cluster);
 
+    // Move the clusters that can no longer grow, given m_latest_time,
+    // out of the list of active clusters
+    void remove_completed_clusters(std::vector<Cluster>* completed_clusters);
+
     float m_eps;
     float m_minPts;
     std::vector<Hit> m_hit_pool;
@@ -98,6 +108,7 @@ private:
     std::vector<Hit*> m_hits; // All the hits we've seen so far, in time order
     float m_latest_time{ 0 }; // The latest time of a hit in the vector of hits
     uint64_t m_first_prim_time{0};
+    bool m_has_primitives{false};
     std::map<int, Cluster>
         m_clusters; // All of the currently-active (ie, kIncomplete) clusters
 };
@@ -0,0 +1,183 @@
+/**
+ * @file LoadShedder.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/LoadShedder.hpp"
+
+#include <string>
+
+#include "TRACE/trace.h"
+#define TRACE_NAME "LoadShedder"
+
+namespace triggeralgs {
+
+void
+LoadShedder::configure(const nlohmann::json& config)
+{
+  m_policies = 0;
+  m_max_queue_depth = 0;
+  m_max_latency_us = 0;
+  m_min_adc_integral = 0;
+  m_min_time_over_threshold = 0;
+  m_slice_length = 62500;
+  m_overloaded = false;
+  m_current_slice = 0;
+  m_shedding_slice = false;
+  m_n_overloads = 0;
+  m_n_batches_dropped = 0;
+  m_n_tps_dropped = 0;
+  m_n_tps_below_floor = 0;
+  m_n_slices_shed = 0;
+  m_n_tps_in_shed_slices = 0;
+  m_n_degraded_batches = 0;
+
+  if (!config.is_object()) {
+    return;
+  }
+
+  if (config.contains("policies")) {
+    for (const auto& entry : config["policies"]) {
+      const std::string policy = entry.get<std::string>();
+      if (policy == "drop_newest") {
+        m_policies |= kDropNewest;
+      } else if (policy == "adc_floor") {
+        m_policies |= kADCFloor;
+      } else if (policy == "degrade") {
+        m_policies |= kDegrade;
+      } else if (policy == "shed_slices") {
+        m_policies |= kShedSlices;
+      } else {
+        throw BadConfiguration(ERS_HERE, TRACE_NAME);
+      }
+    }
+  }
+  if (config.contains("max_queue_depth"))
+    m_max_queue_depth = config["max_queue_depth"];
+  if (config.contains("max_latency_us"))
+    m_max_latency_us = config["max_latency_us"];
+  if (config.contains("min_adc_integral"))
+    m_min_adc_integral = config["min_adc_integral"];
+  if (config.contains("min_time_over_threshold"))
+    m_min_time_over_threshold = config["min_time_over_threshold"];
+  if (config.contains("slice_length"))
+    m_slice_length = config["slice_length"];
+  if (m_slice_length == 0)
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  TLOG() << "[LS]: policies        : " << config.value("policies", nlohmann::json::array()).dump();
+  TLOG() << "[LS]: max queue depth : " << m_max_queue_depth;
+  TLOG() << "[LS]: max latency us  : " << m_max_latency_us;
+}
+
+bool
+LoadShedder::admit(size_t n_tps, size_t queue_depth)
+{
+  if (!has(kDropNewest)) {
+    return true;
+  }
+  if (!overloaded() && (m_max_queue_depth == 0 || queue_depth < m_max_queue_depth)) {
+    return true;
+  }
+  m_n_batches_dropped.fetch_add(1, std::memory_order_relaxed);
+  m_n_tps_dropped.fetch_add(n_tps, std::memory_order_relaxed);
+  return false;
+}
+
+void
+LoadShedder::update(size_t queue_depth, std::chrono::microseconds latency, TriggerActivityMaker& maker)
+{
+  uint64_t latency_us = latency.count() > 0 ? latency.count() : 0;
+  bool was_overloaded = overloaded();
+  bool is_overloaded = was_overloaded;
+  if (!was_overloaded) {
+    is_overloaded = (m_max_queue_depth > 0 && queue_depth >= m_max_queue_depth) ||
+                    (m_max_latency_us > 0 && latency_us >= m_max_latency_us);
+  } else {
+    // Back to half the thresholds before leaving the overload
+    is_overloaded = (m_max_queue_depth > 0 && 2 * queue_depth > m_max_queue_depth) ||
+                    (m_max_latency_us > 0 && 2 * latency_us > m_max_latency_us);
+  }
+
+  if (is_overloaded != was_overloaded) {
+    m_overloaded.store(is_overloaded, std::memory_order_relaxed);
+    if (is_overloaded) {
+      m_n_overloads.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (has(kDegrade)) {
+      maker.set_degraded(is_overloaded);
+    }
+  }
+  if (is_overloaded && has(kDegrade)) {
+    m_n_degraded_batches.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void
+LoadShedder::shed(std::vector<TriggerPrimitive>& input_tps)
+{
+  if ((m_policies & (kADCFloor | kShedSlices)) == 0 || input_tps.empty()) {
+    return;
+  }
+
+  bool is_overloaded = overloaded();
+  if (!is_overloaded && !m_shedding_slice) {
+    // Only the slice is to follow, so that a slice is shed from its start
+    m_current_slice = input_tps.back().time_start / m_slice_length;
+    return;
+  }
+
+  bool shed_slices = has(kShedSlices);
+  bool floor = is_overloaded && has(kADCFloor);
+  uint64_t n_slices_shed = 0;
+  uint64_t n_tps_in_shed_slices = 0;
+  uint64_t n_tps_below_floor = 0;
+  size_t n_kept = 0;
+  for (size_t idx = 0; idx < input_tps.size(); ++idx) {
+    const TriggerPrimitive& tp = input_tps[idx];
+    if (shed_slices) {
+      timestamp_t slice = tp.time_start / m_slice_length;
+      if (slice != m_current_slice) {
+        m_current_slice = slice;
+        m_shedding_slice = is_overloaded;
+        n_slices_shed += is_overloaded;
+      }
+      if (m_shedding_slice) {
+        ++n_tps_in_shed_slices;
+        continue;
+      }
+    }
+    if (floor && (tp.adc_integral < m_min_adc_integral || tp.time_over_threshold < m_min_time_over_threshold)) {
+      ++n_tps_below_floor;
+      continue;
+    }
+    if (n_kept != idx) {
+      input_tps[n_kept] = tp;
+    }
+    ++n_kept;
+  }
+  input_tps.resize(n_kept);
+
+  m_n_slices_shed.fetch_add(n_slices_shed, std::memory_order_relaxed);
+  m_n_tps_in_shed_slices.fetch_add(n_tps_in_shed_slices, std::memory_order_relaxed);
+  m_n_tps_below_floor.fetch_add(n_tps_below_floor, std::memory_order_relaxed);
+}
+
+LoadShedder::Stats
+LoadShedder::stats() const
+{
+  Stats stats;
+  stats.n_overloads = m_n_overloads.load(std::memory_order_relaxed);
+  stats.n_batches_dropped = m_n_batches_dropped.load(std::memory_order_relaxed);
+  stats.n_tps_dropped = m_n_tps_dropped.load(std::memory_order_relaxed);
+  stats.n_tps_below_floor = m_n_tps_below_floor.load(std::memory_order_relaxed);
+  stats.n_slices_shed = m_n_slices_shed.load(std::memory_order_relaxed);
+  stats.n_tps_in_shed_slices = m_n_tps_in_shed_slices.load(std::memory_order_relaxed);
+  stats.n_degraded_batches = m_n_degraded_batches.load(std::memory_order_relaxed);
+  return stats;
+}
+
+} // namespace triggeralgs
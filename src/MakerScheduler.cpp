@@ -0,0 +1,327 @@
+/**
+ * @file MakerScheduler.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/MakerScheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "TRACE/trace.h"
+#define TRACE_NAME "MakerScheduler"
+
+namespace triggeralgs {
+
+namespace {
+
+// The scheduler and worker the current thread runs for, if any
+thread_local const MakerScheduler* t_scheduler = nullptr;
+thread_local size_t t_worker_idx = 0;
+
+} // namespace
+
+MakerScheduler::~MakerScheduler()
+{
+  stop_workers();
+}
+
+void
+MakerScheduler::configure(const nlohmann::json& config)
+{
+  stop_workers();
+  m_tasks.clear();
+  m_shared_tasks.clear();
+  m_n_queued = 0;
+  m_n_pending = 0;
+  m_n_batches = 0;
+  m_n_mailbox_full = 0;
+
+  m_n_workers = std::max(1u, std::thread::hardware_concurrency());
+  m_mailbox_size = 64;
+  m_batch_budget = 4;
+  nlohmann::json placement = nlohmann::json::array();
+  if (config.is_object()) {
+    if (config.contains("n_workers"))
+      m_n_workers = config["n_workers"];
+    if (config.contains("placement"))
+      placement = config["placement"];
+    if (config.contains("mailbox_size"))
+      m_mailbox_size = config["mailbox_size"];
+    if (config.contains("batch_budget"))
+      m_batch_budget = config["batch_budget"];
+  }
+  if (m_n_workers == 0 || m_mailbox_size == 0 || m_batch_budget == 0 || !placement.is_array())
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  m_placements.assign(m_n_workers, ThreadPlacement());
+  for (size_t idx = 0; idx < m_n_workers; ++idx) {
+    m_placements[idx].configure(placement.empty() ? nlohmann::json() : placement[idx % placement.size()],
+                                "maker-worker-" + std::to_string(idx));
+  }
+
+  TLOG() << "[MS]: workers      : " << m_n_workers;
+  TLOG() << "[MS]: mailbox size : " << m_mailbox_size;
+  TLOG() << "[MS]: batch budget : " << m_batch_budget;
+}
+
+void
+MakerScheduler::start()
+{
+  if (!m_workers.empty())
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  m_stop = false;
+  for (size_t idx = 0; idx < m_n_workers; ++idx) {
+    m_workers.push_back(std::make_unique<Worker>());
+  }
+  for (size_t idx = 0; idx < m_n_workers; ++idx) {
+    m_workers[idx]->thread = std::thread(&MakerScheduler::run_worker, this, idx);
+  }
+}
+
+MakerScheduler::handle_t
+MakerScheduler::add_maker(TriggerActivityMaker& maker, OutputSink<TriggerActivity>& sink)
+{
+  return add_task(std::make_unique<TATask>(maker, sink, m_mailbox_size));
+}
+
+MakerScheduler::handle_t
+MakerScheduler::add_maker(TriggerCandidateMaker& maker,
+                          OutputSink<TriggerCandidate>& sink,
+                          TriggerActivityMaker* ta_source)
+{
+  return add_task(std::make_unique<TCTask>(maker, sink, m_mailbox_size, ta_source));
+}
+
+MakerScheduler::handle_t
+MakerScheduler::add_task(std::unique_ptr<Task> task)
+{
+  // The submitting threads may already be reading m_tasks once the workers run.
+  if (!m_workers.empty())
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  m_tasks.push_back(std::move(task));
+  return m_tasks.size() - 1;
+}
+
+bool
+MakerScheduler::submit(handle_t handle, std::vector<TriggerPrimitive>&& inputs)
+{
+  return submit_batch<TATask>(handle, std::move(inputs));
+}
+
+bool
+MakerScheduler::submit(handle_t handle, std::vector<TriggerActivity>&& inputs)
+{
+  return submit_batch<TCTask>(handle, std::move(inputs));
+}
+
+template<class TaskType, class Input>
+bool
+MakerScheduler::submit_batch(handle_t handle, std::vector<Input>&& inputs)
+{
+  // Submitting TPs to a TC maker, or TAs to a TA maker, is a caller bug.
+  auto* task = handle < m_tasks.size() ? dynamic_cast<TaskType*>(m_tasks[handle].get()) : nullptr;
+  if (task == nullptr)
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  typename TaskType::Batch batch;
+  batch.inputs = std::move(inputs);
+  // Counted before the push, so wait() never sees a batch run but not counted.
+  ++m_n_pending;
+  if (!task->mailbox.try_push(std::move(batch))) {
+    inputs = std::move(batch.inputs);
+    --m_n_pending;
+    m_n_mailbox_full.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  activate(task);
+  return true;
+}
+
+bool
+MakerScheduler::submit_flush(handle_t handle, timestamp_t until)
+{
+  if (handle >= m_tasks.size())
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  Task* task = m_tasks[handle].get();
+  ++m_n_pending;
+  if (!task->push_flush(until)) {
+    --m_n_pending;
+    m_n_mailbox_full.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  activate(task);
+  return true;
+}
+
+void
+MakerScheduler::activate(Task* task)
+{
+  if (!task->scheduled.exchange(true)) {
+    schedule(task);
+  }
+}
+
+void
+MakerScheduler::schedule(Task* task, bool at_front)
+{
+  // Counted first, so the count never drops below the tasks on the deques.
+  ++m_n_queued;
+  if (t_scheduler == this) {
+    Worker& worker = *m_workers[t_worker_idx];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (at_front) {
+      worker.tasks.push_front(task);
+    } else {
+      worker.tasks.push_back(task);
+    }
+  } else {
+    std::lock_guard<std::mutex> lock(m_shared_mutex);
+    m_shared_tasks.push_back(task);
+  }
+
+  if (m_n_sleeping.load() > 0) {
+    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    m_wake.notify_one();
+  }
+}
+
+MakerScheduler::Task*
+MakerScheduler::pop_own(Worker& worker)
+{
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return nullptr;
+  }
+  Task* task = worker.tasks.back();
+  worker.tasks.pop_back();
+  return task;
+}
+
+MakerScheduler::Task*
+MakerScheduler::pop_shared()
+{
+  std::lock_guard<std::mutex> lock(m_shared_mutex);
+  if (m_shared_tasks.empty()) {
+    return nullptr;
+  }
+  Task* task = m_shared_tasks.front();
+  m_shared_tasks.pop_front();
+  return task;
+}
+
+MakerScheduler::Task*
+MakerScheduler::steal(size_t thief_idx)
+{
+  // Start from the next worker along, so the thieves spread over the victims.
+  for (size_t offset = 1; offset < m_workers.size(); ++offset) {
+    Worker& victim = *m_workers[(thief_idx + offset) % m_workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      Task* task = victim.tasks.front();
+      victim.tasks.pop_front();
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void
+MakerScheduler::run_worker(size_t worker_idx)
+{
+  m_placements[worker_idx].apply();
+  t_scheduler = this;
+  t_worker_idx = worker_idx;
+  Worker& worker = *m_workers[worker_idx];
+
+  while (!m_stop.load(std::memory_order_relaxed)) {
+    Task* task = pop_own(worker);
+    if (task == nullptr) {
+      task = pop_shared();
+    }
+    if (task == nullptr && (task = steal(worker_idx)) != nullptr) {
+      ++worker.n_steals;
+    }
+
+    if (task == nullptr) {
+      std::unique_lock<std::mutex> lock(m_sleep_mutex);
+      ++m_n_sleeping;
+      // The timeout covers a task scheduled between the checks and the wait.
+      m_wake.wait_for(lock, std::chrono::milliseconds(1), [this] { return m_n_queued.load() > 0 || m_stop.load(); });
+      --m_n_sleeping;
+      continue;
+    }
+
+    --m_n_queued;
+    ++worker.n_runs;
+    run_task(task);
+  }
+
+  t_scheduler = nullptr;
+}
+
+void
+MakerScheduler::run_task(Task* task)
+{
+  size_t n_run = task->run(m_batch_budget);
+  m_n_batches += n_run;
+
+  if (task->has_work()) {
+    // Still scheduled: back of the line, at the end other workers steal from.
+    schedule(task, true);
+  } else {
+    task->scheduled.store(false);
+    // A batch submitted after the check above found the task still scheduled.
+    if (task->has_work() && !task->scheduled.exchange(true)) {
+      schedule(task);
+    }
+  }
+  // Only once the task is settled, so wait() returning means it is idle.
+  m_n_pending -= n_run;
+}
+
+void
+MakerScheduler::wait()
+{
+  while (m_n_pending.load() > 0) {
+    std::this_thread::yield();
+  }
+}
+
+void
+MakerScheduler::stop_workers()
+{
+  m_stop = true;
+  {
+    std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    m_wake.notify_all();
+  }
+  for (auto& worker : m_workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+  m_workers.clear();
+}
+
+MakerScheduler::Stats
+MakerScheduler::stats() const
+{
+  Stats stats;
+  stats.n_batches = m_n_batches.load();
+  for (const auto& worker : m_workers) {
+    stats.n_runs += worker->n_runs.load();
+    stats.n_steals += worker->n_steals.load();
+  }
+  stats.n_mailbox_full = m_n_mailbox_full.load(std::memory_order_relaxed);
+  return stats;
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,359 @@
+/**
+ * @file ShardedTARunner.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/ShardedTARunner.hpp"
+
+#include "triggeralgs/TriggerActivityFactory.hpp"
+
+#include "detchannelmaps/TPCChannelMap.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <future>
+#include <limits>
+
+#include "TRACE/trace.h"
+#define TRACE_NAME "ShardedTARunner"
+
+namespace triggeralgs {
+
+namespace {
+
+// Heap order for a min-heap on time_start
+bool
+later_ta(const TriggerActivity& a, const TriggerActivity& b)
+{
+  return a.time_start > b.time_start;
+}
+
+} // namespace
+
+ShardedTARunner::~ShardedTARunner()
+{
+  stop_threads();
+}
+
+void
+ShardedTARunner::configure(const nlohmann::json& config)
+{
+  stop_threads();
+  m_shards.clear();
+  m_heap.clear();
+  m_output_time = 0;
+  m_watermark = 0;
+  m_merge_lag = s_default_merge_lag;
+  m_stats = Stats();
+
+  if (!config.is_object() || !config.contains("algorithm") || !config.contains("n_channels"))
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  std::string algorithm = config["algorithm"];
+  size_t n_shards = 1;
+  if (config.contains("n_shards"))
+    n_shards = config["n_shards"];
+  std::string shard_by = "channel";
+  if (config.contains("shard_by"))
+    shard_by = config["shard_by"];
+  size_t queue_size = 64;
+  if (config.contains("queue_size"))
+    queue_size = config["queue_size"];
+  if (config.contains("merge_lag"))
+    m_merge_lag = config["merge_lag"];
+  nlohmann::json maker_config = nlohmann::json::object();
+  if (config.contains("maker"))
+    maker_config = config["maker"];
+  nlohmann::json placement = nlohmann::json::array();
+  if (config.contains("placement"))
+    placement = config["placement"];
+
+  if (n_shards == 0 || n_shards > std::numeric_limits<uint16_t>::max() || queue_size == 0 || !placement.is_array())
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  build_shard_table(config, shard_by, n_shards, config["n_channels"]);
+
+  TLOG() << "[STR]: algorithm : " << algorithm;
+  TLOG() << "[STR]: shards    : " << n_shards << " by " << shard_by;
+  TLOG() << "[STR]: merge lag : " << m_merge_lag;
+
+  for (size_t idx = 0; idx < n_shards; ++idx) {
+    auto shard = std::make_unique<Shard>();
+    shard->placement.configure(placement.empty() ? nlohmann::json() : placement[idx % placement.size()],
+                               "ta-shard-" + std::to_string(idx));
+    m_shards.push_back(std::move(shard));
+  }
+
+  // Each shard thread builds its own maker and queues once placed, so they
+  // are first touched on its NUMA node. The shards only start running once
+  // all of them are set up, so a bad configuration leaves no thread behind.
+  auto factory = TriggerActivityFactory::get_instance();
+  std::promise<bool> start;
+  std::shared_future<bool> started = start.get_future().share();
+  std::vector<std::future<void>> ready;
+  for (auto& shard : m_shards) {
+    std::promise<void> set_up;
+    ready.push_back(set_up.get_future());
+    shard->thread = std::thread([&shard = *shard, &factory, &algorithm, &maker_config, queue_size,
+                                 set_up = std::move(set_up), started]() mutable {
+      shard.placement.apply();
+      try {
+        shard.maker = factory->build_maker(algorithm);
+        shard.maker->configure(maker_config);
+        shard.input = std::make_unique<SPSCQueue<ShardInput>>(queue_size);
+        shard.output = std::make_unique<SPSCQueue<ShardOutput>>(queue_size);
+        shard.free_blocks = std::make_unique<SPSCQueue<std::vector<TriggerPrimitive>>>(queue_size);
+        set_up.set_value();
+      } catch (...) {
+        set_up.set_exception(std::current_exception());
+      }
+      if (started.get()) {
+        run_shard(shard);
+      }
+    });
+  }
+
+  std::exception_ptr error;
+  for (auto& shard_ready : ready) {
+    try {
+      shard_ready.get();
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  start.set_value(!error);
+  if (error) {
+    for (auto& shard : m_shards) {
+      shard->thread.join();
+    }
+    m_shards.clear();
+    std::rethrow_exception(error);
+  }
+}
+
+void
+ShardedTARunner::build_shard_table(const nlohmann::json& config,
+                                   const std::string& shard_by,
+                                   size_t n_shards,
+                                   size_t n_channels)
+{
+  m_shard_of_channel.assign(n_channels, 0);
+
+  if (shard_by == "channel") {
+    for (size_t channel = 0; channel < n_channels; ++channel) {
+      m_shard_of_channel[channel] = channel * n_shards / n_channels;
+    }
+  } else if (shard_by == "apa") {
+    size_t channels_per_apa = 2560;
+    if (config.contains("channels_per_apa"))
+      channels_per_apa = config["channels_per_apa"];
+    if (channels_per_apa == 0)
+      throw BadConfiguration(ERS_HERE, TRACE_NAME);
+    for (size_t channel = 0; channel < n_channels; ++channel) {
+      m_shard_of_channel[channel] = (channel / channels_per_apa) % n_shards;
+    }
+  } else if (shard_by == "plane") {
+    // No default channel map: the wrong one would silently mix the planes up.
+    if (!config.contains("channel_map"))
+      throw BadConfiguration(ERS_HERE, TRACE_NAME);
+    std::string channel_map_name = config["channel_map"];
+    auto channel_map = dunedaq::detchannelmaps::make_map(channel_map_name);
+    for (size_t channel = 0; channel < n_channels; ++channel) {
+      m_shard_of_channel[channel] = channel_map->get_plane_from_offline_channel(channel) % n_shards;
+    }
+  } else {
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+  }
+}
+
+void
+ShardedTARunner::push(span<const TriggerPrimitive> input_tps)
+{
+  if (input_tps.empty()) {
+    return;
+  }
+
+  for (const TriggerPrimitive& input_tp : input_tps) {
+    if (input_tp.channel < 0 || static_cast<size_t>(input_tp.channel) >= m_shard_of_channel.size()) {
+      ++m_stats.n_out_of_range;
+    }
+    m_shards[shard_of(input_tp.channel)]->pending.push_back(input_tp);
+  }
+  m_stats.n_tps += input_tps.size();
+
+  // The input is time ordered: every shard now has all of its TPs before the last one.
+  timestamp_t watermark = input_tps.back().time_start;
+  for (auto& shard : m_shards) {
+    ShardInput input;
+    input.tps = std::move(shard->pending);
+    input.watermark = watermark;
+    send(*shard, std::move(input));
+    shard->pending.clear();
+    shard->free_blocks->try_pop(shard->pending);
+  }
+}
+
+void
+ShardedTARunner::heartbeat(timestamp_t until)
+{
+  for (auto& shard : m_shards) {
+    ShardInput input;
+    input.watermark = until;
+    input.flush = true;
+    send(*shard, std::move(input));
+  }
+}
+
+void
+ShardedTARunner::send(Shard& shard, ShardInput&& input)
+{
+  if (shard.input->try_push(std::move(input))) {
+    return;
+  }
+  ++m_stats.n_input_full;
+  // The shard may itself be waiting for room for its output.
+  do {
+    collect();
+    std::this_thread::yield();
+  } while (!shard.input->try_push(std::move(input)));
+}
+
+void
+ShardedTARunner::run_shard(Shard& shard)
+{
+  ShardInput input;
+  ShardOutput output;
+  while (true) {
+    // Sleeps while the shard has no input
+    shard.input->pop(input);
+
+    if (!input.tps.empty()) {
+      shard.maker->process_batch(input.tps, output.tas);
+    }
+    if (input.stop) {
+      shard.maker->flush(std::numeric_limits<timestamp_t>::max(), output.tas);
+      output.watermark = std::numeric_limits<timestamp_t>::max();
+      output.stopped = true;
+    } else {
+      if (input.flush) {
+        shard.maker->flush(input.watermark, output.tas);
+      }
+      output.watermark = input.watermark;
+    }
+
+    input.tps.clear();
+    shard.free_blocks->try_push(std::move(input.tps));
+    shard.output->push(std::move(output));
+    output.tas.clear();
+
+    if (input.stop) {
+      return;
+    }
+  }
+}
+
+void
+ShardedTARunner::collect()
+{
+  ShardOutput output;
+  for (auto& shard : m_shards) {
+    while (shard->output->try_pop(output)) {
+      receive(*shard, output);
+    }
+  }
+}
+
+void
+ShardedTARunner::receive(Shard& shard, ShardOutput& output)
+{
+  shard.watermark = std::max(shard.watermark, output.watermark);
+  shard.stopped |= output.stopped;
+  for (TriggerActivity& ta : output.tas) {
+    m_heap.push_back(std::move(ta));
+    std::push_heap(m_heap.begin(), m_heap.end(), later_ta);
+  }
+}
+
+void
+ShardedTARunner::drain(std::vector<TriggerActivity>& output_ta)
+{
+  collect();
+
+  timestamp_t min_watermark = std::numeric_limits<timestamp_t>::max();
+  for (const auto& shard : m_shards) {
+    min_watermark = std::min(min_watermark, shard->watermark);
+  }
+  m_watermark = m_shards.empty() ? 0 : min_watermark;
+  if (min_watermark <= m_merge_lag) {
+    return;
+  }
+  // No shard can still make a TA starting before ready_time.
+  timestamp_t ready_time = min_watermark - m_merge_lag;
+  while (!m_heap.empty() && m_heap.front().time_start < ready_time) {
+    output_top(output_ta);
+  }
+}
+
+void
+ShardedTARunner::output_top(std::vector<TriggerActivity>& output_ta)
+{
+  std::pop_heap(m_heap.begin(), m_heap.end(), later_ta);
+  TriggerActivity& ta = m_heap.back();
+  if (ta.time_start < m_output_time) {
+    ++m_stats.n_late;
+  } else {
+    m_output_time = ta.time_start;
+  }
+  output_ta.push_back(std::move(ta));
+  m_heap.pop_back();
+  ++m_stats.n_tas;
+}
+
+void
+ShardedTARunner::stop(std::vector<TriggerActivity>& output_ta)
+{
+  stop_threads();
+  while (!m_heap.empty()) {
+    output_top(output_ta);
+  }
+}
+
+void
+ShardedTARunner::recycle(TriggerActivity&& ta)
+{
+  if (!m_shards.empty()) {
+    m_shards[shard_of(ta.channel_start)]->maker->recycle_from_any_thread(std::move(ta));
+  }
+}
+
+void
+ShardedTARunner::stop_threads()
+{
+  // Tell every shard first, so they all flush in parallel.
+  for (auto& shard : m_shards) {
+    if (shard->thread.joinable()) {
+      ShardInput input;
+      input.stop = true;
+      send(*shard, std::move(input));
+    }
+  }
+  for (auto& shard : m_shards) {
+    if (!shard->thread.joinable()) {
+      continue;
+    }
+    // Take the shard's output while it finishes, it may be waiting for room.
+    ShardOutput output;
+    while (!shard->stopped) {
+      shard->output->pop(output);
+      receive(*shard, output);
+    }
+    shard->thread.join();
+  }
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,25 @@
+/**
+ * @file StaticTriggerActivityMakers.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/StaticTriggerActivityMakers.hpp"
+
+namespace triggeralgs {
+
+template class StaticTriggerActivityMaker<TAMakerADCSimpleWindowAlgorithm>;
+template class StaticTriggerActivityMaker<TAMakerChannelAdjacencyAlgorithm>;
+template class StaticTriggerActivityMaker<TAMakerChannelDistanceAlgorithm>;
+template class StaticTriggerActivityMaker<TAMakerHorizontalMuonAlgorithm>;
+template class StaticTriggerActivityMaker<TAMakerDBSCANAlgorithm>;
+
+template class StaticTriggerActivityMakerBase<StaticTAMakerADCSimpleWindow>;
+template class StaticTriggerActivityMakerBase<StaticTAMakerChannelAdjacency>;
+template class StaticTriggerActivityMakerBase<StaticTAMakerChannelDistance>;
+template class StaticTriggerActivityMakerBase<StaticTAMakerHorizontalMuon>;
+template class StaticTriggerActivityMakerBase<StaticTAMakerDBSCAN>;
+
+} // namespace triggeralgs
@@ -61,6 +61,41 @@ TAMakerADCSimpleWindowAlgorithm::process(const TriggerPrimitive& input_tp, std::
   return;
 }
 
+void
+TAMakerADCSimpleWindowAlgorithm::process_accepted(span<const TriggerPrimitive> input_tps,
+                                                  std::vector<TriggerActivity>& output_ta)
+{
+  for (const TriggerPrimitive& input_tp : input_tps) {
+    // Most TPs of a block just extend the current window, so do that here
+    // and leave the window-closing cases to process().
+    if (!m_current_window.is_empty() && (input_tp.time_start - m_current_window.time_start) < m_window_length) {
+      m_current_window.add(input_tp);
+      m_primitive_count++;
+      continue;
+    }
+    TAMakerADCSimpleWindowAlgorithm::process(input_tp, output_ta);
+  }
+}
+
+void
+TAMakerADCSimpleWindowAlgorithm::flush(timestamp_t until, std::vector<TriggerActivity>& output_ta)
+{
+  // Only a window that a TP at until could not extend is complete; the
+  // threshold check is the one process() does when such a TP arrives.
+  if (m_current_window.is_empty() || until < m_current_window.time_start ||
+      (until - m_current_window.time_start) < m_window_length) {
+    return;
+  }
+
+  if (m_current_window.adc_integral > m_adc_threshold) {
+    TLOG_DEBUG(TLVL_DEBUG_LOW) << "[TAM:ADCSW] Flushing window up to " << until << ", ADC integral above threshold.";
+    output_ta.push_back(construct_ta());
+    m_current_window.clear();
+  }
+
+  postprocess(output_ta);
+}
+
 void
 TAMakerADCSimpleWindowAlgorithm::configure(const nlohmann::json& config)
 {
@@ -79,15 +114,15 @@ TAMakerADCSimpleWindowAlgorithm::configure(const nlohmann::json& config)
 }
 
 TriggerActivity
-TAMakerADCSimpleWindowAlgorithm::construct_ta() const
+TAMakerADCSimpleWindowAlgorithm::construct_ta()
 {
   TLOG_DEBUG(TLVL_DEBUG_LOW) << "[TAM:ADCSW] I am constructing a trigger activity!";
   //TLOG_DEBUG(TRACE_NAME) << m_current_window;
 
-  TriggerPrimitive latest_tp_in_window = m_current_window.tp_list.back();
+  TriggerPrimitive latest_tp_in_window = m_current_window.inputs.back();
   // The time_peak, time_activity, channel_* and adc_peak fields of this TA are irrelevent
   // for the purpose of this trigger alg.
-  TriggerActivity ta;
+  TriggerActivity ta = m_ta_pool.acquire();
   ta.time_start = m_current_window.time_start;
   ta.time_end = latest_tp_in_window.time_start + latest_tp_in_window.time_over_threshold;
   ta.time_peak = latest_tp_in_window.time_peak;
@@ -100,7 +135,8 @@ TAMakerADCSimpleWindowAlgorithm::construct_ta() const
   ta.detid = latest_tp_in_window.detid;
   ta.type = TriggerActivity::Type::kTPC;
   ta.algorithm = TriggerActivity::Algorithm::kADCSimpleWindow;
-  ta.inputs = m_current_window.tp_list;
+  // The window is reset right after, so its TPs can be moved rather than copied.
+  move_window_inputs(m_current_window, ta);
   return ta;
 }
 
@@ -7,6 +7,7 @@
  */
 
 #include "triggeralgs/BundleN/TAMakerBundleNAlgorithm.hpp"
+#include "triggeralgs/TPColumns.hpp"
 
 #include "TRACE/trace.h"
 #define TRACE_NAME "TAMakerBundleNAlgorithm"
@@ -33,12 +34,13 @@ void TAMakerBundleNAlgorithm::set_ta_attributes() {
     m_current_ta.type = TriggerActivity::Type::kTPC;
 
     m_current_ta.adc_peak = 0;
-    for (const TriggerPrimitive& tp : m_current_ta.inputs) {
-      m_current_ta.adc_integral += tp.adc_integral;
-      if (tp.adc_peak <= m_current_ta.adc_peak) continue;
-      m_current_ta.adc_peak = tp.adc_peak;
-      m_current_ta.channel_peak = tp.channel;
-      m_current_ta.time_peak = tp.time_peak;
+    TPReduction reduction = reduce(m_current_ta.inputs);
+    m_current_ta.adc_integral += reduction.adc_integral;
+    if (reduction.adc_peak > 0) {
+      const TriggerPrimitive& peak_tp = m_current_ta.inputs[reduction.peak_index];
+      m_current_ta.adc_peak = peak_tp.adc_peak;
+      m_current_ta.channel_peak = peak_tp.channel;
+      m_current_ta.time_peak = peak_tp.time_peak;
     }
     m_current_ta.time_activity = m_current_ta.time_peak;
     return;
@@ -57,29 +59,57 @@ TAMakerBundleNAlgorithm::process(const TriggerPrimitive& input_tp, std::vector<T
   if (bundle_condition()) {
     TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TA:BN] Emitting BundleN TA with " << m_current_ta.inputs.size() << " TPs.";
     set_ta_attributes();
-    output_tas.push_back(m_current_ta);
+    output_tas.push_back(std::move(m_current_ta));
 
     // Reset the current.
-    m_current_ta = TriggerActivity();
+    m_current_ta = m_ta_pool.acquire();
   }
 
   // Should never reach this step. In this case, send it out.
   if (m_current_ta.inputs.size() > m_bundle_size) {
     TLOG_DEBUG(TLVL_IMPORTANT) << "[TA:BN] Emitting large BundleN TriggerActivity with " << m_current_ta.inputs.size() << " TPs.";
     set_ta_attributes();
-    output_tas.push_back(m_current_ta);
+    output_tas.push_back(std::move(m_current_ta));
 
     // Reset the current.
-    m_current_ta = TriggerActivity();
+    m_current_ta = m_ta_pool.acquire();
   }
 }
 
+void
+TAMakerBundleNAlgorithm::flush(timestamp_t until, std::vector<TriggerActivity>& output_tas)
+{
+  // A bundle is only complete once it has bundle_size TPs, which a later TP
+  // may still bring. Unless configured to, a partial bundle is kept.
+  if (!m_flush_partial_bundles) {
+    return;
+  }
+
+  // Bundles have no time window: a partial bundle is sent out once all its
+  // TPs are older than until, rather than waiting for more TPs to fill it.
+  if (m_current_ta.inputs.empty() || m_current_ta.inputs.back().time_start >= until) {
+    return;
+  }
+
+  TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TA:BN] Flushing partial BundleN TA with " << m_current_ta.inputs.size() << " TPs.";
+  set_ta_attributes();
+  output_tas.push_back(std::move(m_current_ta));
+
+  // Reset the current.
+  m_current_ta = m_ta_pool.acquire();
+
+  postprocess(output_tas);
+}
+
 void
 TAMakerBundleNAlgorithm::configure(const nlohmann::json& config)
 {
   if (config.is_object() && config.contains("bundle_size")) {
     m_bundle_size = config["bundle_size"];
   }
+  if (config.is_object() && config.contains("flush_partial_bundles")) {
+    m_flush_partial_bundles = config["flush_partial_bundles"];
+  }
 }
 
 REGISTER_TRIGGER_ACTIVITY_MAKER(TRACE_NAME, TAMakerBundleNAlgorithm)
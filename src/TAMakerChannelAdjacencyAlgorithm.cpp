@@ -9,6 +9,7 @@
 #include "triggeralgs/ChannelAdjacency/TAMakerChannelAdjacencyAlgorithm.hpp"
 #include "TRACE/trace.h"
 #include "triggeralgs/Logging.hpp"
+#include "triggeralgs/TPColumns.hpp"
 #define TRACE_NAME "TAMakerChannelAdjacencyAlgorithm"
 #include <math.h>
 #include <vector>
@@ -48,38 +49,7 @@ TAMakerChannelAdjacencyAlgorithm::process(const TriggerPrimitive& input_tp,
   }
 
   else {
-    TPWindow win_adj_max;
-
-    bool ta_found = 1;
-    while (ta_found) {
-
-      // make m_current_window_tmp a copy of m_current_window and clear m_current_window
-      TPWindow m_current_window_tmp = m_current_window;
-      m_current_window.clear();
-
-      // make m_current_window a new window of non-overlapping tps (of m_current_window_tmp and win_adj_max)
-      for (auto tp : m_current_window_tmp.inputs) {
-        bool new_tp = 1;
-        for (auto tp_sel : win_adj_max.inputs) {
-          if (tp.channel == tp_sel.channel) {
-            new_tp = 0;
-            break;
-          }
-        }
-        if (new_tp)
-          m_current_window.add(tp);
-      }
-
-      // check adjacency -> win_adj_max now contains only those tps that make the track
-      win_adj_max = check_adjacency();
-      if (win_adj_max.inputs.size() > 0) {
-
-        adj_pass = 1;
-        ta_found = 1;
-        output_ta.push_back(construct_ta(win_adj_max));
-      } else
-        ta_found = 0;
-    }
+    adj_pass = extract_tracks(output_ta);
     if (adj_pass)
       m_current_window.reset(input_tp);
   }
@@ -92,11 +62,84 @@ TAMakerChannelAdjacencyAlgorithm::process(const TriggerPrimitive& input_tp,
   return;
 }
 
+bool
+TAMakerChannelAdjacencyAlgorithm::extract_tracks(std::vector<TriggerActivity>& output_ta)
+{
+  bool adj_pass = 0; // sets to true when adjacency logic is satisfied
+  timestamp_t window_start = m_current_window.time_start;
+
+  TPWindow win_adj_max;
+  // TPs of the track found on the previous pass, now owned by the TA made from it
+  span<const TriggerPrimitive> last_track;
+
+  bool ta_found = 1;
+  while (ta_found) {
+
+    // swap m_current_window into m_previous_window and clear m_current_window, both keeping their buffers
+    std::swap(m_current_window, m_previous_window);
+    m_current_window.clear();
+
+    // make m_current_window a new window of non-overlapping tps (of m_previous_window and the last track)
+    for (const auto& tp : m_previous_window.inputs) {
+      bool new_tp = 1;
+      for (const auto& tp_sel : last_track) {
+        if (tp.channel == tp_sel.channel) {
+          new_tp = 0;
+          break;
+        }
+      }
+      if (new_tp)
+        m_current_window.add(tp);
+    }
+
+    // check adjacency -> win_adj_max now contains only those tps that make the track
+    win_adj_max = check_adjacency();
+    if (win_adj_max.inputs.size() > 0) {
+
+      adj_pass = 1;
+      ta_found = 1;
+      output_ta.push_back(construct_ta(win_adj_max));
+      last_track = output_ta.back().inputs;
+    } else
+      ta_found = 0;
+  }
+
+  // With no track found, the window was rebuilt from the same TPs; only its start time was lost.
+  if (!adj_pass)
+    m_current_window.time_start = window_start;
+
+  return adj_pass;
+}
+
+void
+TAMakerChannelAdjacencyAlgorithm::flush(timestamp_t until, std::vector<TriggerActivity>& output_ta)
+{
+  // The window is only complete once a TP at until could not be added to it.
+  if (m_current_window.is_empty() || until < m_current_window.time_start ||
+      (until - m_current_window.time_start) < m_window_length) {
+    return;
+  }
+
+  if (extract_tracks(output_ta)) {
+    TLOG_DEBUG(TLVL_DEBUG_LOW) << "[TAM:CA] Flushed window up to " << until << " into track TAs.";
+    m_current_window.clear();
+  }
+
+  postprocess(output_ta);
+}
+
 void
 TAMakerChannelAdjacencyAlgorithm::configure(const nlohmann::json& config)
 {
   TriggerActivityMaker::configure(config);
   if (config.is_object()) {
+    // Size the channel hit counts of the windows up front, see ChannelOccupancy
+    if (config.contains("n_channels")) {
+      channel_t first_channel = config.value("first_channel", 0);
+      uint32_t n_channels = config["n_channels"];
+      m_current_window.set_channel_range(first_channel, n_channels);
+      m_previous_window.set_channel_range(first_channel, n_channels);
+    }
     if (config.contains("window_length"))
       m_window_length = config["window_length"];
     if (config.contains("adjacency_tolerance"))
@@ -109,10 +152,10 @@ TAMakerChannelAdjacencyAlgorithm::configure(const nlohmann::json& config)
 }
 
 TriggerActivity
-TAMakerChannelAdjacencyAlgorithm::construct_ta(TPWindow win_adj_max) const
+TAMakerChannelAdjacencyAlgorithm::construct_ta(TPWindow& win_adj_max)
 {
 
-  TriggerActivity ta;
+  TriggerActivity ta = m_ta_pool.acquire();
 
   TriggerPrimitive last_tp = win_adj_max.inputs.back();
 
@@ -128,18 +171,18 @@ TAMakerChannelAdjacencyAlgorithm::construct_ta(TPWindow win_adj_max) const
   ta.detid = last_tp.detid;
   ta.type = TriggerActivity::Type::kTPC;
   ta.algorithm = TriggerActivity::Algorithm::kChannelAdjacency;
-  ta.inputs = win_adj_max.inputs;
-
-  for (const auto& tp : ta.inputs) {
-    ta.time_start = std::min(ta.time_start, tp.time_start);
-    ta.time_end = std::max(ta.time_end, tp.time_start);
-    ta.channel_start = std::min(ta.channel_start, tp.channel);
-    ta.channel_end = std::max(ta.channel_end, tp.channel);
-    if (tp.adc_peak > ta.adc_peak) {
-      ta.time_peak = tp.time_peak;
-      ta.adc_peak = tp.adc_peak;
-      ta.channel_peak = tp.channel;
-    }
+  move_window_inputs(win_adj_max, ta);
+
+  TPReduction reduction = reduce(ta.inputs);
+  ta.time_start = std::min(ta.time_start, reduction.time_start_min);
+  ta.time_end = std::max(ta.time_end, reduction.time_start_max);
+  ta.channel_start = std::min(ta.channel_start, reduction.channel_min);
+  ta.channel_end = std::max(ta.channel_end, reduction.channel_max);
+  if (reduction.adc_peak > ta.adc_peak) {
+    const TriggerPrimitive& peak_tp = ta.inputs[reduction.peak_index];
+    ta.time_peak = peak_tp.time_peak;
+    ta.adc_peak = peak_tp.adc_peak;
+    ta.channel_peak = peak_tp.channel;
   }
 
   return ta;
@@ -160,7 +203,7 @@ TAMakerChannelAdjacencyAlgorithm::check_adjacency()
 
   // Generate a channelID ordered list of hit channels for this window; second element of pair is tps
   std::vector<std::pair<int, TriggerPrimitive>> chanTPList;
-  for (auto tp : m_current_window.inputs) {
+  for (const auto& tp : m_current_window.inputs) {
     chanTPList.push_back(std::make_pair(tp.channel, tp));
   }
   std::sort(chanTPList.begin(),
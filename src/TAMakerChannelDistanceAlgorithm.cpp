@@ -7,51 +7,143 @@
  */
 
 #include "triggeralgs/ChannelDistance/TAMakerChannelDistanceAlgorithm.hpp"
+#include "triggeralgs/TPColumns.hpp"
 
 #include "TRACE/trace.h"
 #define TRACE_NAME "TAMakerChannelDistanceAlgorithm"
 
 namespace triggeralgs {
 
-void
-TAMakerChannelDistanceAlgorithm::set_new_ta(const TriggerPrimitive& input_tp)
+TAMakerChannelDistanceAlgorithm::Step
+TAMakerChannelDistanceAlgorithm::step(const TriggerPrimitive& input_tp, span<const TriggerPrimitive> window_tps)
 {
-  m_current_ta = TriggerActivity();
-  m_current_ta.inputs.push_back(input_tp);
+  // Start a new TA if not already going.
+  // Close the TA based on time, the TP starting the next one.
+  Step result = Step::kStart;
+  if (!window_tps.empty()) {
+    if (input_tp.time_start - window_tps.front().time_start <= m_window_length) {
+      // Skip the TP if it's outside the current channel bounds.
+      if (input_tp.channel > m_current_upper_bound || input_tp.channel < m_current_lower_bound)
+        return Step::kSkip;
+
+      m_current_lower_bound = std::min(m_current_lower_bound, input_tp.channel - m_max_channel_distance);
+      m_current_upper_bound = std::max(m_current_upper_bound, input_tp.channel + m_max_channel_distance);
+      return Step::kAdd;
+    }
+    result = Step::kClose;
+  }
+
   m_current_lower_bound = input_tp.channel - m_max_channel_distance;
   m_current_upper_bound = input_tp.channel + m_max_channel_distance;
-  return;
+  return result;
 }
 
 void
 TAMakerChannelDistanceAlgorithm::process(const TriggerPrimitive& input_tp,
                                             std::vector<TriggerActivity>& output_tas)
 {
+  switch (step(input_tp, m_current_ta.inputs)) {
+    case Step::kClose:
+      // Check to block the TA based on min TPs.
+      if (m_current_ta.inputs.size() >= m_min_tps) {
+        set_ta_attributes();
+        output_tas.push_back(std::move(m_current_ta));
+      } else {
+        recycle(std::move(m_current_ta));
+      }
+      [[fallthrough]];
+    case Step::kStart:
+      m_current_ta = m_ta_pool.acquire();
+      m_current_ta.inputs.push_back(input_tp);
+      break;
+    case Step::kAdd:
+      m_current_ta.inputs.push_back(input_tp);
+      break;
+    case Step::kSkip:
+      break;
+  }
+}
 
-  // Start a new TA if not already going.
-  if (m_current_ta.inputs.empty()) {
-    set_new_ta(input_tp);
+void
+TAMakerChannelDistanceAlgorithm::process_accepted(span<const TriggerPrimitive> input_tps,
+                                                  std::vector<TriggerActivity>& output_tas)
+{
+  // Qualified call: no vtable lookup per TP, and process() can be inlined.
+  for (const TriggerPrimitive& input_tp : input_tps) {
+    TAMakerChannelDistanceAlgorithm::process(input_tp, output_tas);
+  }
+}
+
+void
+TAMakerChannelDistanceAlgorithm::flush(timestamp_t until, std::vector<TriggerActivity>& output_tas)
+{
+  // Close the TA if a TP at until would, as in process().
+  if (m_current_ta.inputs.empty() || until < m_current_ta.inputs.front().time_start ||
+      until - m_current_ta.inputs.front().time_start <= m_window_length) {
     return;
   }
 
-  // Check to close the TA based on time.
-  if (input_tp.time_start - m_current_ta.inputs.front().time_start > m_window_length) {
-    // Check to block the TA based on min TPs.
-    if (m_current_ta.inputs.size() >= m_min_tps) {
-      set_ta_attributes();
-      output_tas.push_back(m_current_ta);
+  if (m_current_ta.inputs.size() >= m_min_tps) {
+    set_ta_attributes();
+    output_tas.push_back(std::move(m_current_ta));
+  } else {
+    recycle(std::move(m_current_ta));
+  }
+  // The next TP starts a new TA.
+  m_current_ta.inputs.clear();
+
+  postprocess(output_tas);
+}
+
+void
+TAMakerChannelDistanceAlgorithm::process_batch_sliced(span<const TriggerPrimitive> input_tps,
+                                                      std::vector<SlicedTriggerActivity>& output_tas)
+{
+  for (const TriggerPrimitive& input_tp : input_tps) {
+    if (!accept_tp(input_tp))
+      continue;
+
+    switch (step(input_tp, m_tp_arena.run())) {
+      case Step::kClose:
+        close_sliced(output_tas);
+        [[fallthrough]];
+      case Step::kStart:
+      case Step::kAdd:
+        m_tp_arena.push(input_tp);
+        break;
+      case Step::kSkip:
+        break;
     }
-    set_new_ta(input_tp);
+  }
+
+  m_post_processor(output_tas);
+}
+
+void
+TAMakerChannelDistanceAlgorithm::flush_sliced(timestamp_t until, std::vector<SlicedTriggerActivity>& output_tas)
+{
+  span<const TriggerPrimitive> window_tps = m_tp_arena.run();
+  if (window_tps.empty() || until < window_tps.front().time_start ||
+      until - window_tps.front().time_start <= m_window_length) {
     return;
   }
 
-  // Check to skip the TP if it's outside the current channel bounds.
-  if (input_tp.channel > m_current_upper_bound || input_tp.channel < m_current_lower_bound)
+  close_sliced(output_tas);
+  m_post_processor(output_tas);
+}
+
+void
+TAMakerChannelDistanceAlgorithm::close_sliced(std::vector<SlicedTriggerActivity>& output_tas)
+{
+  if (m_tp_arena.run().size() < m_min_tps) {
+    m_tp_arena.drop_run();
     return;
+  }
 
-  m_current_ta.inputs.push_back(input_tp);
-  m_current_lower_bound = std::min(m_current_lower_bound, input_tp.channel - m_max_channel_distance);
-  m_current_upper_bound = std::max(m_current_upper_bound, input_tp.channel + m_max_channel_distance);
+  SlicedTriggerActivity ta;
+  set_ta_attributes(ta, m_tp_arena.run());
+  ta.inputs = m_tp_arena.take_run();
+  output_tas.push_back(std::move(ta));
 }
 
 void
@@ -65,6 +157,8 @@ TAMakerChannelDistanceAlgorithm::configure(const nlohmann::json& config)
     m_window_length = config["window_length"];
   if (config.contains("max_channel_distance"))
     m_max_channel_distance = config["max_channel_distance"];
+  if (config.contains("arena_block_size"))
+    m_tp_arena = TPArena(config["arena_block_size"].get<size_t>());
 
   return;
 }
@@ -72,30 +166,37 @@ TAMakerChannelDistanceAlgorithm::configure(const nlohmann::json& config)
 void
 TAMakerChannelDistanceAlgorithm::set_ta_attributes()
 {
-  TriggerPrimitive first_tp = m_current_ta.inputs.front();
-  TriggerPrimitive last_tp = m_current_ta.inputs.back();
+  set_ta_attributes(m_current_ta, m_current_ta.inputs);
+}
 
-  m_current_ta.channel_start = first_tp.channel;
-  m_current_ta.channel_end = last_tp.channel;
+void
+TAMakerChannelDistanceAlgorithm::set_ta_attributes(dunedaq::trgdataformats::TriggerActivityData& ta,
+                                                   span<const TriggerPrimitive> tps) const
+{
+  const TriggerPrimitive& first_tp = tps.front();
+  const TriggerPrimitive& last_tp = tps.back();
 
-  m_current_ta.time_start = first_tp.time_start;
-  m_current_ta.time_end = last_tp.time_start;
+  ta.channel_start = first_tp.channel;
+  ta.channel_end = last_tp.channel;
 
-  m_current_ta.detid = first_tp.detid;
+  ta.time_start = first_tp.time_start;
+  ta.time_end = last_tp.time_start;
 
-  m_current_ta.algorithm = TriggerActivity::Algorithm::kChannelDistance;
-  m_current_ta.type = TriggerActivity::Type::kTPC;
+  ta.detid = first_tp.detid;
 
-  m_current_ta.adc_peak = 0;
-  for (const TriggerPrimitive& tp : m_current_ta.inputs) {
-    m_current_ta.adc_integral += tp.adc_integral;
-    if (tp.adc_peak <= m_current_ta.adc_peak)
-      continue;
-    m_current_ta.adc_peak = tp.adc_peak;
-    m_current_ta.channel_peak = tp.channel;
-    m_current_ta.time_peak = tp.time_peak;
+  ta.algorithm = TriggerActivity::Algorithm::kChannelDistance;
+  ta.type = TriggerActivity::Type::kTPC;
+
+  ta.adc_peak = 0;
+  TPReduction reduction = reduce(tps);
+  ta.adc_integral += reduction.adc_integral;
+  if (reduction.adc_peak > 0) {
+    const TriggerPrimitive& peak_tp = tps[reduction.peak_index];
+    ta.adc_peak = peak_tp.adc_peak;
+    ta.channel_peak = peak_tp.channel;
+    ta.time_peak = peak_tp.time_peak;
   }
-  m_current_ta.time_activity = m_current_ta.time_peak;
+  ta.time_activity = ta.time_peak;
 }
 
 // Register algo in TA Factory
@@ -8,9 +8,11 @@
 
 #include "triggeralgs/dbscan/TAMakerDBSCANAlgorithm.hpp"
 #include "dbscan/Point.hpp"
+#include "triggeralgs/TPColumns.hpp"
 
 #include "TRACE/trace.h"
 #include "triggeralgs/Types.hpp"
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #define TRACE_NAME "TAMakerDBSCANAlgorithm"
@@ -21,55 +23,146 @@ using namespace triggeralgs;
 
 using Logging::TLVL_DEBUG_LOW;
 
+namespace {
+
+// Orders the reorder buffer as a min-heap on time_start
+bool
+later_tp(const TriggerPrimitive& a, const TriggerPrimitive& b)
+{
+  return a.time_start > b.time_start;
+}
+
+} // namespace
+
 void
 TAMakerDBSCANAlgorithm::process(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta)
 {
+  if (m_reorder_window == 0) {
+    cluster_tp(input_tp, output_ta);
+    return;
+  }
+
+  if (input_tp.time_start < m_prev_timestamp) {
+    TLOG_DEBUG(TLVL_DEBUG_LOW) << "[TAM:DBS] TP later than the reorder window: prev " << m_prev_timestamp
+                               << ", current " << input_tp.time_start;
+    ++m_reorder_stats.n_dropped;
+    return;
+  }
+  if (input_tp.time_start < m_latest_timestamp) {
+    ++m_reorder_stats.n_reordered;
+  } else {
+    m_latest_timestamp = input_tp.time_start;
+  }
+
+  m_reorder_buffer.push_back(input_tp);
+  std::push_heap(m_reorder_buffer.begin(), m_reorder_buffer.end(), later_tp);
+  m_reorder_stats.max_depth = std::max<uint64_t>(m_reorder_stats.max_depth, m_reorder_buffer.size());
+
+  // Make room if the buffer is full, whatever the time of its earliest TP.
+  while (m_reorder_buffer.size() > m_max_reorder_depth) {
+    ++m_reorder_stats.n_forced;
+    release_reordered(m_reorder_buffer.front().time_start + 1, output_ta);
+  }
+
+  if (m_latest_timestamp > m_reorder_window) {
+    release_reordered(m_latest_timestamp - m_reorder_window, output_ta);
+  }
+}
+
+void
+TAMakerDBSCANAlgorithm::release_reordered(timestamp_t until, std::vector<TriggerActivity>& output_ta)
+{
+  while (!m_reorder_buffer.empty() && m_reorder_buffer.front().time_start < until) {
+    std::pop_heap(m_reorder_buffer.begin(), m_reorder_buffer.end(), later_tp);
+    cluster_tp(m_reorder_buffer.back(), output_ta);
+    m_reorder_buffer.pop_back();
+  }
+}
+
+void
+TAMakerDBSCANAlgorithm::cluster_tp(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta)
+{
+  // The clustering needs time ordered hits.
   if(input_tp.time_start < m_prev_timestamp){
     TLOG_DEBUG(TLVL_DEBUG_LOW) << "[TAM:DBS] Out-of-order TPs: prev " << m_prev_timestamp << ", current " << input_tp.time_start;
+    ++m_reorder_stats.n_dropped;
     return;
   }
+  m_prev_timestamp = input_tp.time_start;
   
   m_dbscan_clusters.clear();
   m_dbscan->add_primitive(input_tp, &m_dbscan_clusters);
 
-  uint64_t t0=m_dbscan->get_first_prim_time();
-  
-  for(auto const& cluster : m_dbscan_clusters){
-    auto& ta=output_ta.emplace_back();
-
-    ta.time_start = std::numeric_limits<timestamp_t>::max();
-    ta.time_end = 0;
-    ta.channel_start = std::numeric_limits<channel_t>::max();
-    ta.channel_end = 0;
-    ta.adc_integral =  0;
-    
-    for(auto const& hit : cluster.hits){
-      auto const& prim=hit->primitive;
+  clusters_to_tas(output_ta);
+
+  m_dbscan->trim_hits();
+}
+
+void
+TAMakerDBSCANAlgorithm::flush(timestamp_t until, std::vector<TriggerActivity>& output_ta)
+{
+  // No TP earlier than until is still to come, so the buffered ones can go.
+  release_reordered(until, output_ta);
+
+  // Hit times are in units of 100 ticks from the first TP, as in add_primitive()
+  if (m_dbscan && m_dbscan->has_primitives() && until > m_dbscan->get_first_prim_time()) {
+    m_dbscan_clusters.clear();
+    m_dbscan->flush(1e-2*(until - m_dbscan->get_first_prim_time()), &m_dbscan_clusters);
+    if (!m_dbscan_clusters.empty()) {
+      TLOG_DEBUG(TLVL_DEBUG_LOW) << "[TAM:DBS] Flushed " << m_dbscan_clusters.size() << " clusters up to " << until;
+    }
+    clusters_to_tas(output_ta);
+
+    m_dbscan->trim_hits();
+  }
 
-      ta.inputs.push_back(prim);
-      
-      ta.time_start = std::min(prim.time_start, ta.time_start);
-      ta.time_end = std::max(prim.time_start + prim.time_over_threshold, ta.time_end);
+  // Also covers the TAs of the TPs released from the reorder buffer above.
+  postprocess(output_ta);
+}
 
-      ta.channel_start = std::min(prim.channel, ta.channel_start);
-      ta.channel_end = std::max(prim.channel, ta.channel_end);
+void
+TAMakerDBSCANAlgorithm::clusters_to_tas(std::vector<TriggerActivity>& output_ta)
+{
+  for(auto const& cluster : m_dbscan_clusters){
+    output_ta.push_back(m_ta_pool.acquire());
+    auto& ta=output_ta.back();
 
-      ta.adc_integral += prim.adc_integral;
+    // The hits are reused by later TPs, so their TPs are copied into the TA
+    // first, then reduced in one pass.
+    for(auto const& hit : cluster.hits){
+      ta.inputs.push_back(hit->primitive);
+    }
 
-      ta.detid = prim.detid;
-      if (prim.adc_peak > ta.adc_peak) {
-        ta.adc_peak = prim.adc_peak;
-        ta.channel_peak = prim.channel;
-        ta.time_peak = prim.time_peak;
-      }
+    TPReduction reduction = reduce(ta.inputs);
+    ta.time_start = reduction.time_start_min;
+    ta.time_end = reduction.time_end_max;
+    ta.channel_start = reduction.channel_min;
+    ta.channel_end = reduction.channel_max;
+    ta.adc_integral = reduction.adc_integral;
+    if (!ta.inputs.empty()) {
+      ta.detid = ta.inputs.back().detid;
+    }
+    if (reduction.adc_peak > ta.adc_peak) {
+      const TriggerPrimitive& peak_tp = ta.inputs[reduction.peak_index];
+      ta.adc_peak = peak_tp.adc_peak;
+      ta.channel_peak = peak_tp.channel;
+      ta.time_peak = peak_tp.time_peak;
     }
     ta.time_activity = ta.time_peak;
 
     ta.type = TriggerActivity::Type::kTPC;
     ta.algorithm = TriggerActivity::Algorithm::kDBSCAN;
   }
+}
 
-  m_dbscan->trim_hits();
+void
+TAMakerDBSCANAlgorithm::process_accepted(span<const TriggerPrimitive> input_tps, std::vector<TriggerActivity>& output_ta)
+{
+  // Clusters are turned into TAs as soon as they complete, since the hits
+  // they point to live in the DBSCAN hit pool and get reused by later TPs.
+  for (const TriggerPrimitive& input_tp : input_tps) {
+    TAMakerDBSCANAlgorithm::process(input_tp, output_ta);
+  }
 }
 
 void
@@ -83,7 +176,12 @@ TAMakerDBSCANAlgorithm::configure(const nlohmann::json& config)
       m_min_pts = config["min_pts"];
     if (config.contains("eps"))
       m_eps = config["eps"];
+    if (config.contains("reorder_window"))
+      m_reorder_window = config["reorder_window"];
+    if (config.contains("max_reorder_depth"))
+      m_max_reorder_depth = config["max_reorder_depth"];
   }
+  m_reorder_buffer.reserve(m_max_reorder_depth + 1);
   m_dbscan=std::make_unique<dbscan::IncrementalDBSCAN>(m_eps, m_min_pts, 10000);
 }
 
@@ -60,7 +60,7 @@ TAMakerHorizontalMuonAlgorithm::process(const TriggerPrimitive& input_tp,
                                   << " window ADC integral. ta.time_start=" << ta.time_start 
                                   << " ta.time_end=" << ta.time_end;
 
-    output_ta.push_back(ta);
+    output_ta.push_back(std::move(ta));
     m_current_window.reset(input_tp);
   }
 
@@ -83,7 +83,8 @@ TAMakerHorizontalMuonAlgorithm::process(const TriggerPrimitive& input_tp,
   // specified window length, don't add it but check whether the adjacency of the
   // current window exceeds the configured threshold. If it does, and we are triggering
   // on adjacency, then create a TA and reset the window with the new/current TP.
-  else if ((adjacency = check_adjacency()) > m_adjacency_threshold && m_trigger_on_adjacency) {
+  // The adjacency check sorts the window's channels, so is skipped when degraded.
+  else if (m_trigger_on_adjacency && !m_degraded && (adjacency = check_adjacency()) > m_adjacency_threshold) {
 
     //for (auto tp : m_current_window.inputs){ dump_tp(tp); }
 
@@ -121,12 +122,63 @@ TAMakerHorizontalMuonAlgorithm::process(const TriggerPrimitive& input_tp,
   return;
 }
 
+void
+TAMakerHorizontalMuonAlgorithm::process_accepted(span<const TriggerPrimitive> input_tps,
+                                                 std::vector<TriggerActivity>& output_ta)
+{
+  for (const TriggerPrimitive& input_tp : input_tps) {
+    // TPs landing inside the current window only need adding to it. The
+    // trigger checks are left to the (statically called) process().
+    if (!m_print_tp_info && !m_current_window.is_empty() &&
+        (input_tp.time_start - m_current_window.time_start) < m_window_length) {
+      m_current_window.add(input_tp);
+      continue;
+    }
+    TAMakerHorizontalMuonAlgorithm::process(input_tp, output_ta);
+  }
+}
+
+void
+TAMakerHorizontalMuonAlgorithm::flush(timestamp_t until, std::vector<TriggerActivity>& output_ta)
+{
+  // The window is only complete once a TP at until could not be added to it.
+  if (m_current_window.is_empty() || until < m_current_window.time_start ||
+      (until - m_current_window.time_start) < m_window_length) {
+    return;
+  }
+
+  // Same checks as process() makes on the TP closing the window, in the same
+  // order. The large TOT trigger depends on that TP, so is not checked here.
+  bool triggered = (m_trigger_on_adc && m_current_window.adc_integral > m_adc_threshold) ||
+                   (m_trigger_on_n_channels && m_current_window.n_channels_hit() > m_n_channels_threshold);
+  if (!triggered && m_trigger_on_adjacency && !m_degraded) {
+    uint16_t adjacency = check_adjacency();
+    if (adjacency > m_adjacency_threshold) {
+      triggered = true;
+      if (adjacency > m_max_adjacency) {
+        m_max_adjacency = adjacency;
+      }
+    }
+  }
+
+  if (triggered) {
+    TLOG_DEBUG(TLVL_DEBUG_MEDIUM) << "[TAM:HM] Flushing window up to " << until << " into a TA.";
+    output_ta.push_back(construct_ta());
+    m_current_window.clear();
+  }
+
+  postprocess(output_ta);
+}
+
 void
 TAMakerHorizontalMuonAlgorithm::configure(const nlohmann::json& config)
 {
   TriggerActivityMaker::configure(config);
 
   if (config.is_object()) {
+    // Size the channel hit counts of the window up front, see ChannelOccupancy
+    if (config.contains("n_channels"))
+      m_current_window.set_channel_range(config.value("first_channel", 0), config["n_channels"]);
     if (config.contains("trigger_on_adc"))
       m_trigger_on_adc = config["trigger_on_adc"];
     if (config.contains("trigger_on_n_channels"))
@@ -154,10 +206,10 @@ TAMakerHorizontalMuonAlgorithm::configure(const nlohmann::json& config)
 }
 
 TriggerActivity
-TAMakerHorizontalMuonAlgorithm::construct_ta() const
+TAMakerHorizontalMuonAlgorithm::construct_ta()
 {
 
-  TriggerActivity ta;
+  TriggerActivity ta = m_ta_pool.acquire();
 
   TriggerPrimitive last_tp = m_current_window.inputs.back();
 
@@ -173,19 +225,20 @@ TAMakerHorizontalMuonAlgorithm::construct_ta() const
   ta.detid = last_tp.detid;
   ta.type = TriggerActivity::Type::kTPC;
   ta.algorithm = TriggerActivity::Algorithm::kHorizontalMuon;
-  ta.inputs = m_current_window.inputs;
-
-  for( const auto& tp : ta.inputs ) {
-    ta.time_start = std::min(ta.time_start, tp.time_start);
-    ta.time_end = std::max(ta.time_end, tp.time_start + tp.time_over_threshold);
-    ta.channel_start = std::min(ta.channel_start, tp.channel);
-    ta.channel_end = std::max(ta.channel_end, tp.channel);
-    if (tp.adc_peak > ta.adc_peak) {
-      ta.time_peak = tp.time_peak;
-      ta.adc_peak = tp.adc_peak;
-      ta.channel_peak = tp.channel;
-    }
+
+  // Reduce the window's columns before its TPs are handed over to the TA.
+  const TPColumns& columns = m_current_window.tp_columns;
+  TPReduction reduction = reduce(columns);
+  ta.time_start = std::min(ta.time_start, reduction.time_start_min);
+  ta.time_end = std::max(ta.time_end, reduction.time_end_max);
+  ta.channel_start = std::min(ta.channel_start, reduction.channel_min);
+  ta.channel_end = std::max(ta.channel_end, reduction.channel_max);
+  if (reduction.adc_peak > ta.adc_peak) {
+    ta.time_peak = columns.time_peak()[reduction.peak_index];
+    ta.adc_peak = reduction.adc_peak;
+    ta.channel_peak = columns.channel()[reduction.peak_index];
   }
+  move_window_inputs(m_current_window, ta);
 
   return ta;
 }
@@ -207,10 +260,8 @@ TAMakerHorizontalMuonAlgorithm::check_adjacency() const
   unsigned int tol_count = 0;    // Tolerance count, should not pass adj_tolerance
 
   // Generate a channelID ordered list of hit channels for this window
-  std::vector<int> chanList;
-  for (auto tp : m_current_window.inputs) {
-    chanList.push_back(tp.channel);
-  }
+  const WindowBuffer<channel_t>& channels = m_current_window.tp_columns.channel();
+  std::vector<int> chanList(channels.begin(), channels.end());
   std::sort(chanList.begin(), chanList.end());
 
   // ADAJACENCY LOGIC ====================================================================
@@ -269,7 +320,7 @@ TAMakerHorizontalMuonAlgorithm::check_adjacency() const
 // Functions below this line are for debugging purposes.
 // =====================================================================================
 void
-TAMakerHorizontalMuonAlgorithm::add_window_to_record(TPWindow window)
+TAMakerHorizontalMuonAlgorithm::add_window_to_record(Window window)
 {
   m_window_record.push_back(window);
   return;
@@ -80,12 +80,12 @@ TAMakerMichelElectronAlgorithm::configure(const nlohmann::json& config)
 }
 
 TriggerActivity
-TAMakerMichelElectronAlgorithm::construct_ta() const
+TAMakerMichelElectronAlgorithm::construct_ta()
 {
 
   TriggerPrimitive latest_tp_in_window = m_current_window.inputs.back();
 
-  TriggerActivity ta;
+  TriggerActivity ta = m_ta_pool.acquire();
   ta.time_start = m_current_window.time_start;
   ta.time_end = latest_tp_in_window.time_start + latest_tp_in_window.time_over_threshold;
   ta.time_peak = latest_tp_in_window.time_peak;
@@ -98,7 +98,7 @@ TAMakerMichelElectronAlgorithm::construct_ta() const
   ta.detid = latest_tp_in_window.detid;
   ta.type = TriggerActivity::Type::kTPC;
   ta.algorithm = TriggerActivity::Algorithm::kMichelElectron;
-  ta.inputs = m_current_window.inputs;
+  move_window_inputs(m_current_window, ta);
 
   return ta;
 }
@@ -121,7 +121,7 @@ TAMakerMichelElectronAlgorithm::longest_activity() const
 
   // Generate a channelID ordered list of hit channels for this window
   std::vector<TriggerPrimitive> hitList;
-  for (auto tp : m_current_window.inputs) {
+  for (const auto& tp : m_current_window.inputs) {
     hitList.push_back(tp);
   }
   std::sort(hitList.begin(), hitList.end(), [](TriggerPrimitive a, TriggerPrimitive b)
@@ -356,28 +356,25 @@ TAMakerMichelElectronAlgorithm::dump_tp(TriggerPrimitive const& input_tp)
   return;
 }
 
-/*
 void
-TAMakerMichelElectronAlgorithm::flush(timestamp_t, std::vector<TriggerActivity>& output_ta)
+TAMakerMichelElectronAlgorithm::flush(timestamp_t until, std::vector<TriggerActivity>& output_ta)
 {
-  // Check the status of the current window, construct TA if conditions are met. Regardless
-  // of whether the conditions are met, reset the window.
-  if(m_current_window.adc_integral > m_adc_threshold && m_trigger_on_adc){
-  //else if(m_current_window.adc_integral > m_conf.adc_threshold && m_conf.trigger_on_adc){
-    //TLOG_DEBUG(TRACE_NAME) << "ADC integral in window is greater than specified threshold.";
-    output_ta.push_back(construct_ta());
+  // The window is only complete once a TP at until could not be added to it.
+  if (m_current_window.is_empty() || until < m_current_window.time_start ||
+      (until - m_current_window.time_start) < m_window_length) {
+    return;
   }
-  else if(m_current_window.n_channels_hit() > m_n_channels_threshold && m_trigger_on_n_channels){
-  //else if(m_current_window.n_channels_hit() > m_conf.n_channels_threshold && m_conf.trigger_on_n_channels){
-    //TLOG_DEBUG(TRACE_NAME) << "Number of channels hit in the window is greater than specified threshold.";
+
+  // Same Michel candidate checks as process() makes on the TP closing the window.
+  std::vector<TriggerPrimitive> trackHits = longest_activity();
+  if (trackHits.size() > m_adjacency_threshold && check_bragg_peak(trackHits) && check_kinks(trackHits)) {
+    TLOG_DEBUG(TLVL_DEBUG_MEDIUM) << "[TAM:ME] Flushing window up to " << until << ", emitting a trigger for candidate Michel event.";
     output_ta.push_back(construct_ta());
+    m_current_window.clear();
   }
 
-  //TLOG_DEBUG(TRACE_NAME) << "Clearing the current window, on the arrival of the next input_tp, the window will be
-reset."; m_current_window.clear();
-
-  return;
-}*/
+  postprocess(output_ta);
+}
 
 // Register algo in TA Factory
 REGISTER_TRIGGER_ACTIVITY_MAKER(TRACE_NAME, TAMakerMichelElectronAlgorithm)
@@ -96,12 +96,45 @@ TAMakerPlaneCoincidenceAlgorithm::process(const TriggerPrimitive& input_tp, std:
   return;
 }
 
+void
+TAMakerPlaneCoincidenceAlgorithm::flush(timestamp_t until, std::vector<TriggerActivity>& output_ta)
+{
+  // Same completeness requirement on the collection window as in process().
+  if (m_collection_window.is_empty() || until < m_collection_window.time_start ||
+      (until - m_collection_window.time_start) <= m_window_length) {
+    return;
+  }
+
+  if ((m_induction1_window.adc_integral + m_induction2_window.adc_integral + m_collection_window.adc_integral)
+        > m_adc_threshold && check_adjacency(m_collection_window) >= m_adjacency_threshold) {
+
+    TLOG_DEBUG(TLVL_DEBUG_MEDIUM) << "[TAM:PC] Flushing windows up to " << until << ", emitting low energy trigger with "
+                                  << m_induction1_window.adc_integral << " U " << m_induction2_window.adc_integral
+                                  << " Y induction ADC sums.";
+
+    // As in process(), all the windows are flushed together to keep them in the same "time zone".
+    output_ta.push_back(construct_ta(m_collection_window));
+    m_collection_window.clear();
+    m_induction1_window.clear();
+    m_induction2_window.clear();
+  }
+
+  postprocess(output_ta);
+}
+
 void
 TAMakerPlaneCoincidenceAlgorithm::configure(const nlohmann::json& config)
 {
   TriggerActivityMaker::configure(config);
 
   if (config.is_object()) {
+    // Size the channel hit counts of the windows up front, see ChannelOccupancy
+    if (config.contains("n_channels")) {
+      channel_t first_channel = config.value("first_channel", 0);
+      uint32_t n_channels = config["n_channels"];
+      m_current_window.set_channel_range(first_channel, n_channels);
+      m_collection_window.set_channel_range(first_channel, n_channels);
+    }
     if (config.contains("adc_threshold"))
       m_adc_threshold = config["adc_threshold"];
     if (config.contains("window_length"))
@@ -115,12 +148,12 @@ TAMakerPlaneCoincidenceAlgorithm::configure(const nlohmann::json& config)
 }
 
 TriggerActivity
-TAMakerPlaneCoincidenceAlgorithm::construct_ta(TPWindow m_current_window) const
+TAMakerPlaneCoincidenceAlgorithm::construct_ta(CollectionWindow& m_current_window)
 {
 
   TriggerPrimitive latest_tp_in_window = m_current_window.inputs.back();
 
-  TriggerActivity ta;
+  TriggerActivity ta = m_ta_pool.acquire();
   ta.time_start = m_current_window.time_start;
   ta.time_end = latest_tp_in_window.time_start + latest_tp_in_window.time_over_threshold;
   ta.time_peak = latest_tp_in_window.time_peak;
@@ -133,13 +166,14 @@ TAMakerPlaneCoincidenceAlgorithm::construct_ta(TPWindow m_current_window) const
   ta.detid = latest_tp_in_window.detid;
   ta.type = TriggerActivity::Type::kTPC;
   ta.algorithm = TriggerActivity::Algorithm::kPlaneCoincidence;
-  ta.inputs = m_current_window.inputs;
+  // Only called on a window that gets reset or cleared straight after.
+  move_window_inputs(m_current_window, ta);
 
   return ta;
 }
 
 uint16_t
-TAMakerPlaneCoincidenceAlgorithm::check_adjacency(TPWindow window) const
+TAMakerPlaneCoincidenceAlgorithm::check_adjacency(const CollectionWindow& window) const
 {
   /* This function returns the adjacency value for the current window, where adjacency
   *  is defined as the maximum number of consecutive wires containing hits. It accepts
@@ -155,7 +189,7 @@ TAMakerPlaneCoincidenceAlgorithm::check_adjacency(TPWindow window) const
 
   /* Generate a channelID ordered list of hit channels for this window */
   std::vector<int> chanList;
-  for (auto tp : window.inputs) {
+  for (const auto& tp : window.inputs) {
     chanList.push_back(tp.channel);
   }
   std::sort(chanList.begin(), chanList.end());
@@ -201,7 +235,7 @@ TAMakerPlaneCoincidenceAlgorithm::check_adjacency(TPWindow window) const
 // Functions below this line are for debugging and performance study purposes.
 // =====================================================================================
 void
-TAMakerPlaneCoincidenceAlgorithm::add_window_to_record(TPWindow window)
+TAMakerPlaneCoincidenceAlgorithm::add_window_to_record(CollectionWindow window)
 {
   m_window_record.push_back(window);
   return;
@@ -220,7 +254,7 @@ TAMakerPlaneCoincidenceAlgorithm::dump_window_record()
     outfile << window.inputs.back().time_start - window.time_start << ",";
     outfile << window.adc_integral << ",";
     outfile << window.n_channels_hit() << ",";             // Number of unique channels with hits
-    outfile << window.inputs.size() << ",";                // Number of TPs in TPWindow
+    outfile << window.inputs.size() << ",";                // Number of TPs in the window
     outfile << window.inputs.back().channel << ",";        // Last TP Channel ID
     outfile << window.inputs.back().time_start << ",";     // Last TP start time
     outfile << window.inputs.front().channel << ",";       // First TP Channel ID
@@ -257,16 +291,10 @@ TAMakerPlaneCoincidenceAlgorithm::dump_tp(TriggerPrimitive const& input_tp)
 }
 
 int
-TAMakerPlaneCoincidenceAlgorithm::check_tot(TPWindow m_current_window) const
+TAMakerPlaneCoincidenceAlgorithm::check_tot(const CollectionWindow& m_current_window) const
 {
-  // Here, we just want to sum up all the tot values for each TP within window,
-  // and return this tot of the window.
-  int window_tot = 0; 
-  for (auto tp : m_current_window.inputs) {
-    window_tot += tp.time_over_threshold;
-  }
-
-  return window_tot;
+  // The sum of the tot values of the TPs within the window, kept by the window.
+  return m_current_window.time_over_threshold;
 }
 
 // Regiser algo in TA Factory
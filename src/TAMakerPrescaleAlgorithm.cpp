@@ -21,10 +21,7 @@ using Logging::TLVL_IMPORTANT;
 void
 TAMakerPrescaleAlgorithm::process(const TriggerPrimitive& input_tp, std::vector<TriggerActivity>& output_ta)
 {
-  std::vector<TriggerPrimitive> tp_list;
-  tp_list.push_back(input_tp);
-
-  TriggerActivity ta;
+  TriggerActivity ta = m_ta_pool.acquire();
   ta.time_start = input_tp.time_start;
   ta.time_end = input_tp.time_start + input_tp.time_over_threshold;
   ta.time_peak = input_tp.time_peak;
@@ -38,9 +35,9 @@ TAMakerPrescaleAlgorithm::process(const TriggerPrimitive& input_tp, std::vector<
   ta.type = TriggerActivity::Type::kTPC;
   ta.algorithm = TriggerActivity::Algorithm::kPrescale;
 
-  ta.inputs = tp_list;
+  ta.inputs.push_back(input_tp);
 
-  output_ta.push_back(ta);
+  output_ta.push_back(std::move(ta));
 }
 
 void
@@ -20,9 +20,7 @@ TCMakerADCSimpleWindowAlgorithm::process(const TriggerActivity& activity, std::v
 { 
   // For now, if there is any single activity from any one detector element, emit
   // a trigger candidate.
-  std::vector<TriggerActivity::TriggerActivityData> ta_list = {static_cast<TriggerActivity::TriggerActivityData>(activity)};
-
-  TriggerCandidate tc;
+  TriggerCandidate tc = m_tc_pool.acquire();
   tc.time_start = activity.time_start; 
   tc.time_end = activity.time_end;  
   tc.time_candidate = activity.time_activity;
@@ -30,9 +28,9 @@ TCMakerADCSimpleWindowAlgorithm::process(const TriggerActivity& activity, std::v
   tc.type = TriggerCandidate::Type::kADCSimpleWindow;
   tc.algorithm = TriggerCandidate::Algorithm::kADCSimpleWindow;
 
-  tc.inputs = ta_list;
+  tc.inputs.push_back(static_cast<TriggerActivity::TriggerActivityData>(activity));
 
-  cand.push_back(tc);
+  cand.push_back(std::move(tc));
 
 }
 
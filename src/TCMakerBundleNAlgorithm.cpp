@@ -42,23 +42,55 @@ TCMakerBundleNAlgorithm::process(const TriggerActivity& input_ta, std::vector<Tr
   if (bundle_condition()) {
     TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TC:BN] Emitting BundleN TriggerCandidate with " << m_current_tc.inputs.size() << " TAs.";
     set_tc_attributes();
-    output_tcs.push_back(m_current_tc);
+    output_tcs.push_back(std::move(m_current_tc));
 
     // Reset the current.
-    m_current_tc = TriggerCandidate();
+    m_current_tc = m_tc_pool.acquire();
   }
 
   // Should never reach this step. In this case, send it out.
   if (m_current_tc.inputs.size() > m_bundle_size) {
     TLOG_DEBUG(TLVL_IMPORTANT) << "[TC:BN] Emitting large BundleN TriggerCandidate with " << m_current_tc.inputs.size() << " TAs.";
     set_tc_attributes();
-    output_tcs.push_back(m_current_tc);
+    output_tcs.push_back(std::move(m_current_tc));
 
     // Reset the current.
-    m_current_tc = TriggerCandidate();
+    m_current_tc = m_tc_pool.acquire();
   }
 }
 
+void
+TCMakerBundleNAlgorithm::process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& output_tcs)
+{
+  // Fill the current bundle with as many TAs of the block as it has room for,
+  // and only check the bundle condition once per fill.
+  size_t idx = 0;
+  while (idx < input_tas.size()) {
+    size_t room = m_current_tc.inputs.size() < m_bundle_size ? m_bundle_size - m_current_tc.inputs.size() : 1;
+    size_t n_take = std::min(room, input_tas.size() - idx);
+    m_current_tc.inputs.insert(
+      m_current_tc.inputs.end(), input_tas.begin() + idx, input_tas.begin() + idx + n_take);
+    idx += n_take;
+
+    bool oversized = m_current_tc.inputs.size() > m_bundle_size;
+    if (bundle_condition() || oversized) {
+      if (oversized) {
+        // Should never reach this step. In this case, send it out.
+        TLOG_DEBUG(TLVL_IMPORTANT) << "[TC:BN] Emitting large BundleN TriggerCandidate with " << m_current_tc.inputs.size() << " TAs.";
+      } else {
+        TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TC:BN] Emitting BundleN TriggerCandidate with " << m_current_tc.inputs.size() << " TAs.";
+      }
+      set_tc_attributes();
+      output_tcs.push_back(std::move(m_current_tc));
+
+      // Reset the current.
+      m_current_tc = m_tc_pool.acquire();
+    }
+  }
+
+  postprocess(output_tcs);
+}
+
 void
 TCMakerBundleNAlgorithm::configure(const nlohmann::json& config)
 {
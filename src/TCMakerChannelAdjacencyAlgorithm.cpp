@@ -22,14 +22,15 @@ using Logging::TLVL_DEBUG_HIGH;
 using Logging::TLVL_DEBUG_MEDIUM;
 using Logging::TLVL_VERY_IMPORTANT;
 
+template<class Activity>
 void
-TCMakerChannelAdjacencyAlgorithm::process(const TriggerActivity& activity,
-                                               std::vector<TriggerCandidate>& output_tc)
+TCMakerChannelAdjacencyAlgorithm::process_activity(Activity&& activity,
+                                                   std::vector<TriggerCandidate>& output_tc)
 {
 
   // The first time process() is called, reset window object.
   if (m_current_window.is_empty()) {
-    m_current_window.reset(activity);
+    m_current_window.reset(std::forward<Activity>(activity));
     m_activity_count++;
   }
 
@@ -37,13 +38,13 @@ TCMakerChannelAdjacencyAlgorithm::process(const TriggerActivity& activity,
   // is less than the specified window size, add the TA to the window.
   else if ((activity.time_start - m_current_window.time_start) < m_window_length) {
     TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TCM:CA] Window not yet complete, adding the activity to the window.";
-    m_current_window.add(activity);
+    m_current_window.add(std::forward<Activity>(activity));
   }
   // If it is not, move the window along.
   else {
     TLOG_DEBUG(TLVL_DEBUG_ALL)
       << "[TCM:CA] TAWindow is at required length but specified threshold not met, shifting window along.";
-    m_current_window.move(activity, m_window_length);
+    m_current_window.move(std::forward<Activity>(activity), m_window_length);
   }
 
   // If the addition of the current TA to the window would make it longer
@@ -62,7 +63,7 @@ TCMakerChannelAdjacencyAlgorithm::process(const TriggerActivity& activity,
                                  << " ta.adc_integral=" << ta.adc_integral;
     }
 
-    output_tc.push_back(tc);
+    output_tc.push_back(std::move(tc));
     m_current_window.clear();
   }
 
@@ -79,12 +80,80 @@ TCMakerChannelAdjacencyAlgorithm::process(const TriggerActivity& activity,
   return;
 }
 
+void
+TCMakerChannelAdjacencyAlgorithm::process(const TriggerActivity& activity, std::vector<TriggerCandidate>& output_tc)
+{
+  process_activity(activity, output_tc);
+}
+
+void
+TCMakerChannelAdjacencyAlgorithm::process(TriggerActivity&& activity, std::vector<TriggerCandidate>& output_tc)
+{
+  process_activity(std::move(activity), output_tc);
+}
+
+void
+TCMakerChannelAdjacencyAlgorithm::process_batch(span<const TriggerActivity> input_tas,
+                                                std::vector<TriggerCandidate>& output_tc)
+{
+  // Find out whether the whole block lands inside the current window, and
+  // bound what it can add to the window's ADC and channel count.
+  bool fits_window = !m_current_window.is_empty();
+  uint64_t block_adc = 0;
+  uint64_t block_tps = 0;
+  for (const TriggerActivity& input_ta : input_tas) {
+    fits_window &= (input_ta.time_start - m_current_window.time_start) < m_window_length;
+    block_adc += input_ta.adc_integral;
+    block_tps += input_ta.inputs.size();
+  }
+
+  // Evaluate the thresholds once for the block. The window's ADC and channel
+  // count only grow while TAs are added, so if the bounds stay within the
+  // thresholds no TA of the block could have made a TC on its own.
+  bool adc_safe = !m_trigger_on_adc || m_current_window.adc_integral + block_adc <= m_adc_threshold;
+  bool channels_safe =
+    !m_trigger_on_n_channels || m_current_window.n_channels_hit() + block_tps <= m_n_channels_threshold;
+
+  if (fits_window && adc_safe && channels_safe) {
+    TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TCM:CA] Adding block of " << input_tas.size() << " activities to the window.";
+    for (const TriggerActivity& input_ta : input_tas) {
+      m_current_window.add(input_ta);
+    }
+    m_activity_count += input_tas.size();
+  } else {
+    for (const TriggerActivity& input_ta : input_tas) {
+      TCMakerChannelAdjacencyAlgorithm::process(input_ta, output_tc);
+    }
+  }
+
+  postprocess(output_tc);
+}
+
+void
+TCMakerChannelAdjacencyAlgorithm::flush(timestamp_t until, std::vector<TriggerCandidate>& output_tc)
+{
+  // The thresholds are checked as each TA is added, so the window never holds
+  // back a TC. Only the TAs that no TA starting at or after until could share
+  // the window with are dropped, as the next TA would do.
+  if (m_current_window.is_empty() || until < m_current_window.time_start ||
+      (until - m_current_window.time_start) < m_window_length) {
+    return;
+  }
+  TLOG_DEBUG(TLVL_DEBUG_ALL) << "[TCM:CA] Expiring window activities up to " << until;
+  m_current_window.expire(until, m_window_length);
+
+  postprocess(output_tc);
+}
+
 void
 TCMakerChannelAdjacencyAlgorithm::configure(const nlohmann::json& config)
 {
   TriggerCandidateMaker::configure(config);
 
   if (config.is_object()) {
+    // Size the channel hit counts of the window up front, see ChannelOccupancy
+    if (config.contains("n_channels"))
+      m_current_window.set_channel_range(config.value("first_channel", 0), config["n_channels"]);
     if (config.contains("trigger_on_adc"))
       m_trigger_on_adc = config["trigger_on_adc"];
     if (config.contains("trigger_on_n_channels"))
@@ -107,11 +176,11 @@ TCMakerChannelAdjacencyAlgorithm::configure(const nlohmann::json& config)
 }
 
 TriggerCandidate
-TCMakerChannelAdjacencyAlgorithm::construct_tc() const
+TCMakerChannelAdjacencyAlgorithm::construct_tc()
 {
-  TriggerActivity latest_ta_in_window = m_current_window.inputs.back();
+  const TriggerActivity& latest_ta_in_window = m_current_window.inputs.back();
 
-  TriggerCandidate tc;
+  TriggerCandidate tc = m_tc_pool.acquire();
   tc.time_start = m_current_window.time_start;
   tc.time_end = latest_ta_in_window.inputs.back().time_start;
   tc.time_candidate = m_current_window.time_start;
@@ -16,7 +16,7 @@ namespace triggeralgs {
 void
 TCMakerChannelDistanceAlgorithm::set_new_tc(const TriggerActivity& input_ta)
 {
-  m_current_tc = TriggerCandidate();
+  m_current_tc = m_tc_pool.acquire();
   m_current_tc.inputs.push_back(input_ta);
   m_current_tp_count = input_ta.inputs.size();
   return;
@@ -62,7 +62,7 @@ TCMakerChannelDistanceAlgorithm::process(const TriggerActivity& input_ta,
   // Check to close the TC based on TP contents.
   if (input_ta.inputs.size() + m_current_tp_count > m_max_tp_count) {
     set_tc_attributes();
-    output_tcs.push_back(m_current_tc);
+    output_tcs.push_back(std::move(m_current_tc));
 
     set_new_tc(input_ta);
     return;
@@ -74,6 +74,29 @@ TCMakerChannelDistanceAlgorithm::process(const TriggerActivity& input_ta,
   return;
 }
 
+void
+TCMakerChannelDistanceAlgorithm::process_batch(span<const TriggerActivity> input_tas,
+                                               std::vector<TriggerCandidate>& output_tcs)
+{
+  size_t block_tps = 0;
+  for (const TriggerActivity& input_ta : input_tas) {
+    block_tps += input_ta.inputs.size();
+  }
+
+  // One check for the whole block: if its TPs fit under the maximum, none of
+  // its TAs can close the current TC.
+  if (!m_current_tc.inputs.empty() && block_tps + m_current_tp_count <= m_max_tp_count) {
+    m_current_tc.inputs.insert(m_current_tc.inputs.end(), input_tas.begin(), input_tas.end());
+    m_current_tp_count += block_tps;
+  } else {
+    for (const TriggerActivity& input_ta : input_tas) {
+      TCMakerChannelDistanceAlgorithm::process(input_ta, output_tcs);
+    }
+  }
+
+  postprocess(output_tcs);
+}
+
 // Register algo in TC Factory
 REGISTER_TRIGGER_CANDIDATE_MAKER(TRACE_NAME, TCMakerChannelDistanceAlgorithm)
 
@@ -16,7 +16,7 @@ namespace triggeralgs {
 void
 TCMakerDBSCANAlgorithm::set_new_tc(const TriggerActivity& input_ta)
 {
-  m_current_tc = TriggerCandidate();
+  m_current_tc = m_tc_pool.acquire();
   m_current_tc.inputs.push_back(input_ta);
   m_current_tp_count = input_ta.inputs.size();
   return;
@@ -60,7 +60,7 @@ TCMakerDBSCANAlgorithm::process(const TriggerActivity& input_ta, std::vector<Tri
   // Check to close the TC based on TP contents.
   if (input_ta.inputs.size() + m_current_tp_count > m_max_tp_count) {
     set_tc_attributes();
-    output_tcs.push_back(m_current_tc);
+    output_tcs.push_back(std::move(m_current_tc));
     set_new_tc(input_ta);
     return;
   }
@@ -71,6 +71,28 @@ TCMakerDBSCANAlgorithm::process(const TriggerActivity& input_ta, std::vector<Tri
   return;
 }
 
+void
+TCMakerDBSCANAlgorithm::process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& output_tcs)
+{
+  // If the TPs of the whole block fit in the current TC, the TP-count
+  // threshold can't be crossed by any of its TAs: append them all at once.
+  size_t block_tps = 0;
+  for (const TriggerActivity& input_ta : input_tas) {
+    block_tps += input_ta.inputs.size();
+  }
+
+  if (!m_current_tc.inputs.empty() && block_tps + m_current_tp_count <= m_max_tp_count) {
+    m_current_tc.inputs.insert(m_current_tc.inputs.end(), input_tas.begin(), input_tas.end());
+    m_current_tp_count += block_tps;
+  } else {
+    for (const TriggerActivity& input_ta : input_tas) {
+      TCMakerDBSCANAlgorithm::process(input_ta, output_tcs);
+    }
+  }
+
+  postprocess(output_tcs);
+}
+
 // Register algo in TC Factory.
 REGISTER_TRIGGER_CANDIDATE_MAKER(TRACE_NAME, TCMakerDBSCANAlgorithm)
 
@@ -21,17 +21,15 @@ using Logging::TLVL_DEBUG_LOW;
 using Logging::TLVL_DEBUG_INFO;
 using Logging::TLVL_VERY_IMPORTANT;
 
+template<class Activity>
 void
-TCMakerPlaneCoincidenceAlgorithm::process(const TriggerActivity& activity,
-                                                std::vector<TriggerCandidate>& output_tc)
+TCMakerPlaneCoincidenceAlgorithm::process_activity(Activity&& activity,
+                                                   std::vector<TriggerCandidate>& output_tc)
 {
 
-  std::vector<TriggerActivity::TriggerActivityData> ta_list = { static_cast<TriggerActivity::TriggerActivityData>(
-    activity) };
-
   // The first time process is called, reset window object.
   if (m_current_window.is_empty()) {
-    m_current_window.reset(activity);
+    m_current_window.reset(std::forward<Activity>(activity));
     m_activity_count++;
     // Trivial TC Logic:
     // If the request has been made to not trigger on number of channels or
@@ -43,7 +41,7 @@ TCMakerPlaneCoincidenceAlgorithm::process(const TriggerActivity& activity,
       TLOG_DEBUG(TLVL_DEBUG_LOW) << "[TCM:PC] Constructing TC.";
       TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TCM:PC] Activity count: " << m_activity_count;
       TriggerCandidate tc = construct_tc();
-      output_tc.push_back(tc);
+      output_tc.push_back(std::move(tc));
 
       // Clear the current window (only has a single TA in it)
       m_current_window.clear();
@@ -57,7 +55,7 @@ TCMakerPlaneCoincidenceAlgorithm::process(const TriggerActivity& activity,
   // If the difference between the current TA's start time and the start of the window
   // is less than the specified window size, add the TA to the window.
   if ((activity.time_start - m_current_window.time_start) < m_window_length) {
-    m_current_window.add(activity);
+    m_current_window.add(std::forward<Activity>(activity));
   }
   // If the addition of the current TA to the window would make it longer
   // than the specified window length, don't add it but check whether the sum of all adc in
@@ -67,9 +65,9 @@ TCMakerPlaneCoincidenceAlgorithm::process(const TriggerActivity& activity,
     TLOG_DEBUG(TLVL_DEBUG_MEDIUM) << "[TCM:PC] ADC integral in window is greater than specified threshold.";
     TriggerCandidate tc = construct_tc();
 
-    output_tc.push_back(tc);
+    output_tc.push_back(std::move(tc));
     TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TCM:PC] Resetting window with activity.";
-    m_current_window.reset(activity);
+    m_current_window.reset(std::forward<Activity>(activity));
   }
   // If the addition of the current TA to the window would make it longer
   // than the specified window length, don't add it but check whether the number of hit channels in
@@ -79,13 +77,13 @@ TCMakerPlaneCoincidenceAlgorithm::process(const TriggerActivity& activity,
     // TODO 04-2024: This case appears unsupported. Throwing error for now, but should this be removed?
     tc_number++;
     //   output_tc.push_back(construct_tc());
-    m_current_window.reset(activity);
+    m_current_window.reset(std::forward<Activity>(activity));
     TLOG_DEBUG(TLVL_DEBUG_INFO) << "[TCM:PC] Should not see this!";
   }
   // If it is not, move the window along.
   else {
     TLOG_DEBUG(TLVL_DEBUG_HIGH) << "[TCM:PC] TAWindow is at required length but specified threshold not met, shifting window along.";
-    m_current_window.move(activity, m_window_length);
+    m_current_window.move(std::forward<Activity>(activity), m_window_length);
   }
 
   m_activity_count++;
@@ -93,11 +91,84 @@ TCMakerPlaneCoincidenceAlgorithm::process(const TriggerActivity& activity,
   return;
 }
 
+void
+TCMakerPlaneCoincidenceAlgorithm::process(const TriggerActivity& activity, std::vector<TriggerCandidate>& output_tc)
+{
+  process_activity(activity, output_tc);
+}
+
+void
+TCMakerPlaneCoincidenceAlgorithm::process(TriggerActivity&& activity, std::vector<TriggerCandidate>& output_tc)
+{
+  process_activity(std::move(activity), output_tc);
+}
+
+void
+TCMakerPlaneCoincidenceAlgorithm::process_batch(span<const TriggerActivity> input_tas,
+                                                std::vector<TriggerCandidate>& output_tc)
+{
+  size_t idx = 0;
+  while (idx < input_tas.size()) {
+    // The thresholds are only evaluated once a TA falls outside the current
+    // window, so the run of TAs that lands inside it can be added in one go.
+    size_t run_end = idx;
+    if (!m_current_window.is_empty()) {
+      while (run_end < input_tas.size() &&
+             (input_tas[run_end].time_start - m_current_window.time_start) < m_window_length) {
+        m_current_window.add(input_tas[run_end]);
+        ++run_end;
+      }
+      m_activity_count += run_end - idx;
+    }
+
+    // The TA closing the window (or opening a new one) goes through the full logic.
+    if (run_end < input_tas.size()) {
+      TCMakerPlaneCoincidenceAlgorithm::process(input_tas[run_end], output_tc);
+      ++run_end;
+    }
+    idx = run_end;
+  }
+
+  postprocess(output_tc);
+}
+
+void
+TCMakerPlaneCoincidenceAlgorithm::flush(timestamp_t until, std::vector<TriggerCandidate>& output_tc)
+{
+  // The window is only complete once a TA starting at until could not be added to it.
+  if (m_current_window.is_empty() || until < m_current_window.time_start ||
+      (until - m_current_window.time_start) < m_window_length) {
+    return;
+  }
+
+  // Same threshold checks as process() makes on the TA closing the window. The
+  // window is cleared once it made its TC, so it is not output again.
+  if (m_current_window.adc_integral > m_adc_threshold && m_trigger_on_adc) {
+    TLOG_DEBUG(TLVL_DEBUG_MEDIUM) << "[TCM:PC] Flushing window up to " << until << ", ADC integral is greater than specified threshold.";
+    output_tc.push_back(construct_tc());
+    m_current_window.clear();
+  }
+  else if (m_current_window.n_channels_hit() > m_n_channels_threshold && m_trigger_on_n_channels) {
+    // As in process(), this case makes no TC and only drops the window.
+    tc_number++;
+    m_current_window.clear();
+  }
+  // Otherwise, drop the TAs the next TA would move the window past.
+  else {
+    m_current_window.expire(until, m_window_length);
+  }
+
+  postprocess(output_tc);
+}
+
 void
 TCMakerPlaneCoincidenceAlgorithm::configure(const nlohmann::json& config)
 {
   TriggerCandidateMaker::configure(config);
   if (config.is_object()) {
+    // Size the channel hit counts of the window up front, see ChannelOccupancy
+    if (config.contains("n_channels"))
+      m_current_window.set_channel_range(config.value("first_channel", 0), config["n_channels"]);
     if (config.contains("trigger_on_adc"))
       m_trigger_on_adc = config["trigger_on_adc"];
     if (config.contains("trigger_on_n_channels"))
@@ -121,11 +192,11 @@ TCMakerPlaneCoincidenceAlgorithm::configure(const nlohmann::json& config)
 }
 
 TriggerCandidate
-TCMakerPlaneCoincidenceAlgorithm::construct_tc() const
+TCMakerPlaneCoincidenceAlgorithm::construct_tc()
 {
-  TriggerActivity latest_ta_in_window = m_current_window.inputs.back();
+  const TriggerActivity& latest_ta_in_window = m_current_window.inputs.back();
 
-  TriggerCandidate tc;
+  TriggerCandidate tc = m_tc_pool.acquire();
   tc.time_start = m_current_window.time_start;
   tc.time_end =
     latest_ta_in_window.inputs.back().time_start + latest_ta_in_window.inputs.back().time_over_threshold;
@@ -18,10 +18,7 @@ using namespace triggeralgs;
 void
 TCMakerPrescaleAlgorithm::process(const TriggerActivity& activity, std::vector<TriggerCandidate>& cand)
 { 
-  std::vector<TriggerActivity::TriggerActivityData> ta_list;
-  ta_list.push_back(static_cast<TriggerActivity::TriggerActivityData>(activity));
-  
-  TriggerCandidate tc;
+  TriggerCandidate tc = m_tc_pool.acquire();
   tc.time_start = activity.time_start;
   tc.time_end = activity.time_end;
   tc.time_candidate = activity.time_start;
@@ -29,7 +26,7 @@ TCMakerPrescaleAlgorithm::process(const TriggerActivity& activity, std::vector<T
   tc.type = TriggerCandidate::Type::kPrescale;
   tc.algorithm = TriggerCandidate::Algorithm::kPrescale;
 
-  tc.inputs = ta_list;
+  tc.inputs.push_back(static_cast<TriggerActivity::TriggerActivityData>(activity));
 
   using namespace std::chrono;
 
@@ -38,7 +35,7 @@ TCMakerPrescaleAlgorithm::process(const TriggerActivity& activity, std::vector<T
   uint64_t data_time = activity.time_start*16e-6;       // Convert 62.5 MHz ticks to ms    
   m_data_vs_system_time.store(data_time - system_time); // Store the difference for OpMon
 
-  cand.push_back(tc);
+  cand.push_back(std::move(tc));
 }
 
 void
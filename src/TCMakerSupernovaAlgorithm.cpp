@@ -41,4 +41,14 @@ TCMakerSupernovaAlgorithm::process(const TriggerActivity& activity, std::vector<
   }
 }
 
+void
+TCMakerSupernovaAlgorithm::process_batch(span<const TriggerActivity> input_tas, std::vector<TriggerCandidate>& cand)
+{
+  for (const TriggerActivity& activity : input_tas) {
+    TCMakerSupernovaAlgorithm::process(activity, cand);
+  }
+
+  postprocess(cand);
+}
+
 REGISTER_TRIGGER_CANDIDATE_MAKER(TRACE_NAME, TCMakerSupernovaAlgorithm)
@@ -13,6 +13,9 @@
 #include <limits>
 #include <vector>
 
+#include "TRACE/trace.h"
+#define TRACE_NAME "TDMakerSupernovaAlgorithm"
+
 using pd_clock = std::chrono::duration<double, std::ratio<1, 62500000>>;
 using namespace triggeralgs;
 
@@ -43,3 +46,6 @@ TDMakerSupernovaAlgorithm::operator()(const TriggerCandidate& cand, std::vector<
   decisions.push_back(trigger);
   return;
 }
+
+// Register algo in TD Factory
+REGISTER_TRIGGER_DECISION_MAKER(TRACE_NAME, TDMakerSupernovaAlgorithm)
@@ -0,0 +1,78 @@
+/**
+ * @file TPArena.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/TPArena.hpp"
+
+#include <algorithm>
+#include <memory>
+
+namespace triggeralgs {
+
+TPSlice
+TPArena::append(span<const TriggerPrimitive> input_tps)
+{
+  if (input_tps.empty()) {
+    return {};
+  }
+
+  if (!m_block || m_block->capacity - m_block->size < input_tps.size()) {
+    // Drop our reference to the current block: any slices into it keep it alive.
+    m_block = std::make_shared<Block>(std::max(m_block_size, input_tps.size()));
+    ++m_n_blocks;
+  }
+
+  TriggerPrimitive* first = m_block->tps.get() + m_block->size;
+  std::copy(input_tps.begin(), input_tps.end(), first);
+  m_block->size += input_tps.size();
+  m_n_appended += input_tps.size();
+
+  return TPSlice(m_block, first, input_tps.size());
+}
+
+void
+TPArena::push(const TriggerPrimitive& input_tp)
+{
+  if (!m_block || m_block->size == m_block->capacity) {
+    auto block = std::make_shared<Block>(std::max(m_block_size, 2 * m_run_size));
+    span<const TriggerPrimitive> open_run = run();
+    std::copy(open_run.begin(), open_run.end(), block->tps.get());
+    block->size = m_run_size;
+    m_n_moved += m_run_size;
+    m_block = std::move(block);
+    ++m_n_blocks;
+  }
+
+  m_block->tps[m_block->size++] = input_tp;
+  ++m_run_size;
+  ++m_n_appended;
+}
+
+TPSlice
+TPArena::take_run()
+{
+  if (m_run_size == 0) {
+    return {};
+  }
+
+  TPSlice slice(m_block, m_block->tps.get() + m_block->size - m_run_size, m_run_size);
+  m_run_size = 0;
+  return slice;
+}
+
+void
+TPArena::drop_run()
+{
+  if (m_run_size == 0) {
+    return;
+  }
+
+  m_block->size -= m_run_size;
+  m_run_size = 0;
+}
+
+} // namespace triggeralgs
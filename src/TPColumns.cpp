@@ -0,0 +1,245 @@
+/**
+ * @file TPColumns.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/TPColumns.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace triggeralgs {
+
+void
+TPColumns::push_back(const TriggerPrimitive& tp)
+{
+  m_time_start.push_back(tp.time_start);
+  m_time_over_threshold.push_back(tp.time_over_threshold);
+  m_time_peak.push_back(tp.time_peak);
+  m_channel.push_back(tp.channel);
+  m_adc_integral.push_back(tp.adc_integral);
+  m_adc_peak.push_back(tp.adc_peak);
+}
+
+void
+TPColumns::insert(size_t position, const TriggerPrimitive& tp)
+{
+  m_time_start.insert(m_time_start.begin() + position, timestamp_t(tp.time_start));
+  m_time_over_threshold.insert(m_time_over_threshold.begin() + position, timestamp_t(tp.time_over_threshold));
+  m_time_peak.insert(m_time_peak.begin() + position, timestamp_t(tp.time_peak));
+  m_channel.insert(m_channel.begin() + position, channel_t(tp.channel));
+  m_adc_integral.insert(m_adc_integral.begin() + position, uint32_t(tp.adc_integral));
+  m_adc_peak.insert(m_adc_peak.begin() + position, uint32_t(tp.adc_peak));
+}
+
+void
+TPColumns::pop_front(size_t n)
+{
+  m_time_start.pop_front(n);
+  m_time_over_threshold.pop_front(n);
+  m_time_peak.pop_front(n);
+  m_channel.pop_front(n);
+  m_adc_integral.pop_front(n);
+  m_adc_peak.pop_front(n);
+}
+
+void
+TPColumns::clear()
+{
+  m_time_start.clear();
+  m_time_over_threshold.clear();
+  m_time_peak.clear();
+  m_channel.clear();
+  m_adc_integral.clear();
+  m_adc_peak.clear();
+}
+
+namespace {
+
+struct ColumnPointers
+{
+  const timestamp_t* time_start;
+  const timestamp_t* time_over_threshold;
+  const channel_t* channel;
+  const uint32_t* adc_integral;
+  const uint32_t* adc_peak;
+};
+
+/// Fold the TPs [first, last) of the columns into reduction
+void
+reduce_scalar(const ColumnPointers& columns, size_t first, size_t last, TPReduction& reduction)
+{
+  for (size_t idx = first; idx < last; ++idx) {
+    timestamp_t time_start = columns.time_start[idx];
+    reduction.time_start_min = std::min(reduction.time_start_min, time_start);
+    reduction.time_start_max = std::max(reduction.time_start_max, time_start);
+    reduction.time_end_max = std::max(reduction.time_end_max, time_start + columns.time_over_threshold[idx]);
+    reduction.channel_min = std::min(reduction.channel_min, columns.channel[idx]);
+    reduction.channel_max = std::max(reduction.channel_max, columns.channel[idx]);
+    reduction.adc_integral += columns.adc_integral[idx];
+    if (columns.adc_peak[idx] > reduction.adc_peak) {
+      reduction.adc_peak = columns.adc_peak[idx];
+      reduction.peak_index = idx;
+    }
+  }
+}
+
+#if defined(__x86_64__)
+
+static_assert(std::is_same_v<timestamp_t, uint64_t> && std::is_same_v<channel_t, int32_t>,
+              "The AVX2 reduction expects 64-bit unsigned times and 32-bit signed channels");
+
+/// Biased lanes: x ^ sign bit compares as signed in the order x compares as unsigned
+__attribute__((target("avx2"))) inline __m256i
+max_biased_epi64(__m256i a, __m256i b)
+{
+  return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a));
+}
+
+__attribute__((target("avx2"))) inline __m256i
+min_biased_epi64(__m256i a, __m256i b)
+{
+  return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+/**
+ * Fold the TPs of the columns into reduction 8 at a time, returning the
+ * number folded (a multiple of 8). Each lane keeps the first of its TPs
+ * with the highest adc_peak, so the lowest index among the lanes holding
+ * the maximum is the first TP overall.
+ */
+__attribute__((target("avx2"))) size_t
+reduce_avx2(const ColumnPointers& columns, size_t n_tps, TPReduction& reduction)
+{
+  const __m256i bias64 = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i bias32 = _mm256_set1_epi32(INT32_MIN);
+
+  __m256i time_start_min = _mm256_set1_epi64x(INT64_MAX);
+  __m256i time_start_max = _mm256_set1_epi64x(INT64_MIN);
+  __m256i time_end_max = _mm256_set1_epi64x(INT64_MIN);
+  __m256i channel_min = _mm256_set1_epi32(INT32_MAX);
+  __m256i channel_max = _mm256_set1_epi32(INT32_MIN);
+  __m256i adc_integral_lo = _mm256_setzero_si256();
+  __m256i adc_integral_hi = _mm256_setzero_si256();
+  __m256i adc_peak_max = bias32;
+  __m256i peak_index = _mm256_setzero_si256();
+  __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  size_t idx = 0;
+  for (; idx + 8 <= n_tps; idx += 8) {
+    for (size_t half = 0; half < 8; half += 4) {
+      __m256i time_start =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.time_start + idx + half));
+      __m256i time_over_threshold =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.time_over_threshold + idx + half));
+      __m256i time_start_biased = _mm256_xor_si256(time_start, bias64);
+      time_start_min = min_biased_epi64(time_start_min, time_start_biased);
+      time_start_max = max_biased_epi64(time_start_max, time_start_biased);
+      time_end_max =
+        max_biased_epi64(time_end_max, _mm256_xor_si256(_mm256_add_epi64(time_start, time_over_threshold), bias64));
+    }
+
+    __m256i channel = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.channel + idx));
+    channel_min = _mm256_min_epi32(channel_min, channel);
+    channel_max = _mm256_max_epi32(channel_max, channel);
+
+    __m256i adc_integral = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.adc_integral + idx));
+    adc_integral_lo = _mm256_add_epi64(adc_integral_lo, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(adc_integral)));
+    adc_integral_hi =
+      _mm256_add_epi64(adc_integral_hi, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(adc_integral, 1)));
+
+    __m256i adc_peak =
+      _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.adc_peak + idx)), bias32);
+    __m256i higher = _mm256_cmpgt_epi32(adc_peak, adc_peak_max);
+    adc_peak_max = _mm256_blendv_epi8(adc_peak_max, adc_peak, higher);
+    peak_index = _mm256_blendv_epi8(peak_index, index, higher);
+    index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+  }
+  if (idx == 0)
+    return 0;
+
+  alignas(32) uint64_t lanes64[3][4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes64[0]), _mm256_xor_si256(time_start_min, bias64));
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes64[1]), _mm256_xor_si256(time_start_max, bias64));
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes64[2]), _mm256_xor_si256(time_end_max, bias64));
+  alignas(32) uint64_t adc_lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(adc_lanes), _mm256_add_epi64(adc_integral_lo, adc_integral_hi));
+  for (size_t lane = 0; lane < 4; ++lane) {
+    reduction.time_start_min = std::min<timestamp_t>(reduction.time_start_min, lanes64[0][lane]);
+    reduction.time_start_max = std::max<timestamp_t>(reduction.time_start_max, lanes64[1][lane]);
+    reduction.time_end_max = std::max<timestamp_t>(reduction.time_end_max, lanes64[2][lane]);
+    reduction.adc_integral += adc_lanes[lane];
+  }
+
+  alignas(32) int32_t lanes32[4][8];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes32[0]), channel_min);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes32[1]), channel_max);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes32[2]), _mm256_xor_si256(adc_peak_max, bias32));
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes32[3]), peak_index);
+  for (size_t lane = 0; lane < 8; ++lane) {
+    reduction.channel_min = std::min<channel_t>(reduction.channel_min, lanes32[0][lane]);
+    reduction.channel_max = std::max<channel_t>(reduction.channel_max, lanes32[1][lane]);
+    uint32_t adc_peak = static_cast<uint32_t>(lanes32[2][lane]);
+    size_t lane_peak_index = static_cast<uint32_t>(lanes32[3][lane]);
+    if (adc_peak > reduction.adc_peak ||
+        (adc_peak == reduction.adc_peak && adc_peak > 0 && lane_peak_index < reduction.peak_index)) {
+      reduction.adc_peak = adc_peak;
+      reduction.peak_index = lane_peak_index;
+    }
+  }
+  return idx;
+}
+
+#endif // __x86_64__
+
+} // namespace
+
+TPReduction
+reduce(const TPColumns& columns)
+{
+  ColumnPointers pointers{ columns.time_start().data(),
+                           columns.time_over_threshold().data(),
+                           columns.channel().data(),
+                           columns.adc_integral().data(),
+                           columns.adc_peak().data() };
+  size_t n_tps = columns.size();
+  TPReduction reduction;
+  size_t n_reduced = 0;
+#if defined(__x86_64__)
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  // The lane indices are 32 bits wide
+  if (has_avx2 && n_tps <= INT32_MAX)
+    n_reduced = reduce_avx2(pointers, n_tps, reduction);
+#endif
+  reduce_scalar(pointers, n_reduced, n_tps, reduction);
+  return reduction;
+}
+
+TPReduction
+reduce(span<const TriggerPrimitive> tps)
+{
+  TPReduction reduction;
+  for (size_t idx = 0; idx < tps.size(); ++idx) {
+    const TriggerPrimitive& tp = tps[idx];
+    reduction.time_start_min = std::min(reduction.time_start_min, tp.time_start);
+    reduction.time_start_max = std::max(reduction.time_start_max, tp.time_start);
+    reduction.time_end_max = std::max(reduction.time_end_max, tp.time_start + tp.time_over_threshold);
+    reduction.channel_min = std::min(reduction.channel_min, tp.channel);
+    reduction.channel_max = std::max(reduction.channel_max, tp.channel);
+    reduction.adc_integral += tp.adc_integral;
+    if (tp.adc_peak > reduction.adc_peak) {
+      reduction.adc_peak = tp.adc_peak;
+      reduction.peak_index = idx;
+    }
+  }
+  return reduction;
+}
+
+} // namespace triggeralgs
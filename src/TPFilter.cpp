@@ -0,0 +1,464 @@
+/**
+ * @file TPFilter.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/TPFilter.hpp"
+
+#include "triggeralgs/Issues.hpp"
+#include "triggeralgs/Logging.hpp"
+
+#include "detchannelmaps/TPCChannelMap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "TRACE/trace.h"
+#define TRACE_NAME "TPFilter"
+
+namespace triggeralgs {
+
+using Logging::TLVL_DEBUG_LOW;
+
+namespace {
+
+/// Set lo/span from an optional [min_key, max_key] pair, returning whether either was given
+bool
+configure_range(const nlohmann::json& config,
+                const char* min_key,
+                const char* max_key,
+                uint64_t type_max,
+                uint64_t& lo,
+                uint64_t& span)
+{
+  uint64_t min = 0;
+  uint64_t max = type_max;
+  bool enabled = false;
+  if (config.contains(min_key)) {
+    min = config[min_key];
+    enabled |= min > 0;
+  }
+  if (config.contains(max_key)) {
+    max = std::min(config[max_key].get<uint64_t>(), type_max);
+    enabled |= max < type_max;
+  }
+  if (min > max)
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  lo = min;
+  span = max - min;
+  return enabled;
+}
+
+} // namespace
+
+template<unsigned... kFilters>
+std::array<TPFilter::predicate_t, sizeof...(kFilters)>
+TPFilter::make_predicate_table(std::integer_sequence<unsigned, kFilters...>)
+{
+  return { &TPFilter::predicate_for<kFilters>... };
+}
+
+TPFilter::predicate_t
+TPFilter::select_predicate(unsigned filters)
+{
+  static const auto table = make_predicate_table(std::make_integer_sequence<unsigned, kAll + 1>{});
+  return table[filters & kAll];
+}
+
+size_t
+TPFilter::compact_scalar(TriggerPrimitive* tps, size_t n_tps, size_t start)
+{
+  // Evaluates the filters one by one, rather than through m_predicate, so
+  // that rejections can be counted per filter.
+  size_t n_kept = start;
+  for (size_t idx = start; idx < n_tps; ++idx) {
+    const TriggerPrimitive& tp = tps[idx];
+    bool keep = true;
+    if (m_enabled & kToT) {
+      bool pass = in_range(tp.time_over_threshold, m_tot_lo, m_tot_span);
+      m_stats.n_rejected_time_over_threshold += !pass;
+      keep &= pass;
+    }
+    if (m_enabled & kADCIntegral) {
+      bool pass = in_range(tp.adc_integral, m_adc_integral_lo, m_adc_integral_span);
+      m_stats.n_rejected_adc_integral += !pass;
+      keep &= pass;
+    }
+    if (m_enabled & kADCPeak) {
+      bool pass = in_range(tp.adc_peak, m_adc_peak_lo, m_adc_peak_span);
+      m_stats.n_rejected_adc_peak += !pass;
+      keep &= pass;
+    }
+    if (m_enabled & kChannel) {
+      uint32_t channel = static_cast<uint32_t>(tp.channel);
+      bool pass = (channel < m_n_channels ? m_channel_accept[channel] : m_channel_accept_default) != 0;
+      m_stats.n_rejected_channel += !pass;
+      keep &= pass;
+    }
+    if (m_enabled & kDetID) {
+      bool pass = m_detid_accept[tp.detid] != 0;
+      m_stats.n_rejected_detid += !pass;
+      keep &= pass;
+    }
+
+    if (keep) {
+      if (n_kept != idx)
+        tps[n_kept] = tp;
+      ++n_kept;
+    }
+  }
+  return n_kept;
+}
+
+#if defined(__x86_64__)
+
+namespace {
+
+// The vector paths read every field as a 32-bit word at its offset in the
+// TP. Narrower fields are masked down, 64-bit ones have their upper word
+// checked to be zero (the configured bounds never exceed 32 bits).
+template<class Field>
+constexpr uint32_t
+field_mask()
+{
+  return sizeof(Field) >= 4 ? 0xffffffffu : (1u << (8 * sizeof(Field))) - 1;
+}
+
+using tot_t = decltype(TriggerPrimitive::time_over_threshold);
+using adc_integral_t = decltype(TriggerPrimitive::adc_integral);
+using adc_peak_t = decltype(TriggerPrimitive::adc_peak);
+using channel_field_t = decltype(TriggerPrimitive::channel);
+using detid_field_t = decltype(TriggerPrimitive::detid);
+
+constexpr size_t kToTOffset = offsetof(TriggerPrimitive, time_over_threshold);
+constexpr size_t kADCIntegralOffset = offsetof(TriggerPrimitive, adc_integral);
+constexpr size_t kADCPeakOffset = offsetof(TriggerPrimitive, adc_peak);
+constexpr size_t kChannelOffset = offsetof(TriggerPrimitive, channel);
+constexpr size_t kDetIDOffset = offsetof(TriggerPrimitive, detid);
+
+static_assert(sizeof(tot_t) <= 8 && sizeof(adc_integral_t) <= 4 && sizeof(adc_peak_t) <= 4 &&
+                sizeof(channel_field_t) == 4 && sizeof(detid_field_t) <= 4,
+              "TPFilter vector paths expect narrower TP fields");
+static_assert(kADCPeakOffset + 4 <= sizeof(TriggerPrimitive) && kDetIDOffset + 4 <= sizeof(TriggerPrimitive),
+              "TPFilter vector paths read 32 bits at each field offset");
+
+uint32_t
+load_u32(const TriggerPrimitive* tp, size_t offset)
+{
+  uint32_t word;
+  std::memcpy(&word, reinterpret_cast<const char*>(tp) + offset, sizeof(word));
+  return word;
+}
+
+/// Keep the TPs flagged in keep_bits (bit i for tps[base + i]) at tps[n_kept...]
+inline size_t
+move_kept(TriggerPrimitive* tps, size_t base, uint32_t keep_bits, size_t n_kept)
+{
+  while (keep_bits) {
+    size_t idx = base + __builtin_ctz(keep_bits);
+    if (n_kept != idx)
+      tps[n_kept] = tps[idx];
+    ++n_kept;
+    keep_bits &= keep_bits - 1;
+  }
+  return n_kept;
+}
+
+__attribute__((target("sse4.1"))) inline __m128i
+load4_sse41(const TriggerPrimitive* tps, size_t offset, uint32_t mask)
+{
+  __m128i words = _mm_set_epi32(static_cast<int>(load_u32(tps + 3, offset)),
+                                static_cast<int>(load_u32(tps + 2, offset)),
+                                static_cast<int>(load_u32(tps + 1, offset)),
+                                static_cast<int>(load_u32(tps + 0, offset)));
+  return _mm_and_si128(words, _mm_set1_epi32(static_cast<int>(mask)));
+}
+
+/// Lanes where lo <= value <= lo + span, as unsigned 32-bit values
+__attribute__((target("sse4.1"))) inline __m128i
+in_range_sse41(__m128i value, uint64_t lo, uint64_t span)
+{
+  __m128i delta = _mm_sub_epi32(value, _mm_set1_epi32(static_cast<int>(lo)));
+  __m128i span_v = _mm_set1_epi32(static_cast<int>(span));
+  return _mm_cmpeq_epi32(_mm_min_epu32(delta, span_v), delta);
+}
+
+__attribute__((target("avx2"))) inline __m256i
+gather8_avx2(const TriggerPrimitive* tps, size_t offset, uint32_t mask)
+{
+  const __m256i byte_idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                              _mm256_set1_epi32(static_cast<int>(sizeof(TriggerPrimitive))));
+  __m256i words =
+    _mm256_i32gather_epi32(reinterpret_cast<const int*>(reinterpret_cast<const char*>(tps) + offset), byte_idx, 1);
+  return _mm256_and_si256(words, _mm256_set1_epi32(static_cast<int>(mask)));
+}
+
+__attribute__((target("avx2"))) inline __m256i
+in_range_avx2(__m256i value, uint64_t lo, uint64_t span)
+{
+  __m256i delta = _mm256_sub_epi32(value, _mm256_set1_epi32(static_cast<int>(lo)));
+  __m256i span_v = _mm256_set1_epi32(static_cast<int>(span));
+  return _mm256_cmpeq_epi32(_mm256_min_epu32(delta, span_v), delta);
+}
+
+/// Lookup of table[index] != 0 per lane, with default_accept for index >= size
+__attribute__((target("avx2"))) inline __m256i
+lookup_avx2(const std::vector<uint8_t>& table, uint32_t size, uint8_t default_accept, __m256i index)
+{
+  // Out of range lanes read entry 0 and are then replaced by the default.
+  __m256i in_table = _mm256_cmpgt_epi32(_mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(size)), _mm256_set1_epi32(INT32_MIN)),
+                                _mm256_xor_si256(index, _mm256_set1_epi32(INT32_MIN)));
+  __m256i safe_index = _mm256_and_si256(index, in_table);
+  __m256i entry = _mm256_and_si256(
+    _mm256_i32gather_epi32(reinterpret_cast<const int*>(table.data()), safe_index, 1), _mm256_set1_epi32(0xff));
+  __m256i accept = _mm256_xor_si256(_mm256_cmpeq_epi32(entry, _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+  __m256i default_v = _mm256_set1_epi32(default_accept ? -1 : 0);
+  return _mm256_blendv_epi8(default_v, accept, in_table);
+}
+
+} // namespace
+
+__attribute__((target("sse4.1"))) size_t
+TPFilter::compact_sse41(TriggerPrimitive* tps, size_t n_tps)
+{
+  size_t n_kept = 0;
+  size_t idx = 0;
+  for (; idx + 4 <= n_tps; idx += 4) {
+    const TriggerPrimitive* block = tps + idx;
+    __m128i keep = _mm_set1_epi32(-1);
+
+    if (m_enabled & kToT) {
+      __m128i pass = in_range_sse41(load4_sse41(block, kToTOffset, field_mask<tot_t>()), m_tot_lo, m_tot_span);
+      if constexpr (sizeof(tot_t) == 8)
+        pass = _mm_and_si128(pass, _mm_cmpeq_epi32(load4_sse41(block, kToTOffset + 4, 0xffffffffu), _mm_setzero_si128()));
+      m_stats.n_rejected_time_over_threshold += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(pass)));
+      keep = _mm_and_si128(keep, pass);
+    }
+    if (m_enabled & kADCIntegral) {
+      __m128i pass = in_range_sse41(
+        load4_sse41(block, kADCIntegralOffset, field_mask<adc_integral_t>()), m_adc_integral_lo, m_adc_integral_span);
+      m_stats.n_rejected_adc_integral += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(pass)));
+      keep = _mm_and_si128(keep, pass);
+    }
+    if (m_enabled & kADCPeak) {
+      __m128i pass =
+        in_range_sse41(load4_sse41(block, kADCPeakOffset, field_mask<adc_peak_t>()), m_adc_peak_lo, m_adc_peak_span);
+      m_stats.n_rejected_adc_peak += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(pass)));
+      keep = _mm_and_si128(keep, pass);
+    }
+
+    uint32_t keep_bits = _mm_movemask_ps(_mm_castsi128_ps(keep));
+
+    // No gathers before AVX2: the table lookups are done per lane.
+    if (m_enabled & (kChannel | kDetID)) {
+      for (unsigned lane = 0; lane < 4; ++lane) {
+        const TriggerPrimitive& tp = block[lane];
+        if (m_enabled & kChannel) {
+          uint32_t channel = static_cast<uint32_t>(tp.channel);
+          bool pass = (channel < m_n_channels ? m_channel_accept[channel] : m_channel_accept_default) != 0;
+          m_stats.n_rejected_channel += !pass;
+          keep_bits &= ~(static_cast<uint32_t>(!pass) << lane);
+        }
+        if (m_enabled & kDetID) {
+          bool pass = m_detid_accept[tp.detid] != 0;
+          m_stats.n_rejected_detid += !pass;
+          keep_bits &= ~(static_cast<uint32_t>(!pass) << lane);
+        }
+      }
+    }
+
+    n_kept = move_kept(tps, idx, keep_bits, n_kept);
+  }
+
+  // Finish the tail with the scalar filter, moving it down first.
+  size_t n_tail = n_tps - idx;
+  for (size_t tail = 0; tail < n_tail; ++tail)
+    if (n_kept + tail != idx + tail)
+      tps[n_kept + tail] = tps[idx + tail];
+  return compact_scalar(tps, n_kept + n_tail, n_kept);
+}
+
+__attribute__((target("avx2"))) size_t
+TPFilter::compact_avx2(TriggerPrimitive* tps, size_t n_tps)
+{
+  size_t n_kept = 0;
+  size_t idx = 0;
+  for (; idx + 8 <= n_tps; idx += 8) {
+    const TriggerPrimitive* block = tps + idx;
+    __m256i keep = _mm256_set1_epi32(-1);
+
+    if (m_enabled & kToT) {
+      __m256i pass = in_range_avx2(gather8_avx2(block, kToTOffset, field_mask<tot_t>()), m_tot_lo, m_tot_span);
+      if constexpr (sizeof(tot_t) == 8)
+        pass = _mm256_and_si256(
+          pass, _mm256_cmpeq_epi32(gather8_avx2(block, kToTOffset + 4, 0xffffffffu), _mm256_setzero_si256()));
+      m_stats.n_rejected_time_over_threshold += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(pass)));
+      keep = _mm256_and_si256(keep, pass);
+    }
+    if (m_enabled & kADCIntegral) {
+      __m256i pass = in_range_avx2(
+        gather8_avx2(block, kADCIntegralOffset, field_mask<adc_integral_t>()), m_adc_integral_lo, m_adc_integral_span);
+      m_stats.n_rejected_adc_integral += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(pass)));
+      keep = _mm256_and_si256(keep, pass);
+    }
+    if (m_enabled & kADCPeak) {
+      __m256i pass =
+        in_range_avx2(gather8_avx2(block, kADCPeakOffset, field_mask<adc_peak_t>()), m_adc_peak_lo, m_adc_peak_span);
+      m_stats.n_rejected_adc_peak += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(pass)));
+      keep = _mm256_and_si256(keep, pass);
+    }
+    if (m_enabled & kChannel) {
+      __m256i channel = gather8_avx2(block, kChannelOffset, 0xffffffffu);
+      __m256i pass = lookup_avx2(m_channel_accept, m_n_channels, m_channel_accept_default, channel);
+      m_stats.n_rejected_channel += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(pass)));
+      keep = _mm256_and_si256(keep, pass);
+    }
+    if (m_enabled & kDetID) {
+      __m256i detid = gather8_avx2(block, kDetIDOffset, field_mask<detid_field_t>());
+      __m256i pass = lookup_avx2(m_detid_accept, std::numeric_limits<detid_t>::max() + 1, 0, detid);
+      m_stats.n_rejected_detid += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(pass)));
+      keep = _mm256_and_si256(keep, pass);
+    }
+
+    uint32_t keep_bits = _mm256_movemask_ps(_mm256_castsi256_ps(keep));
+    n_kept = move_kept(tps, idx, keep_bits, n_kept);
+  }
+
+  size_t n_tail = n_tps - idx;
+  for (size_t tail = 0; tail < n_tail; ++tail)
+    if (n_kept + tail != idx + tail)
+      tps[n_kept + tail] = tps[idx + tail];
+  return compact_scalar(tps, n_kept + n_tail, n_kept);
+}
+
+#endif // __x86_64__
+
+size_t
+TPFilter::compact(span<TriggerPrimitive> input_tps)
+{
+  size_t n_tps = input_tps.size();
+  m_stats.n_tps += n_tps;
+  if (m_enabled == 0)
+    return n_tps;
+
+  size_t n_kept;
+#if defined(__x86_64__)
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  static const bool has_sse41 = __builtin_cpu_supports("sse4.1");
+  if (has_avx2)
+    n_kept = compact_avx2(input_tps.data(), n_tps);
+  else if (has_sse41)
+    n_kept = compact_sse41(input_tps.data(), n_tps);
+  else
+#endif
+    n_kept = compact_scalar(input_tps.data(), n_tps, 0);
+
+  m_stats.n_rejected += n_tps - n_kept;
+  return n_kept;
+}
+
+void
+TPFilter::configure(const nlohmann::json& config)
+{
+  Stats stats = m_stats;
+  *this = TPFilter();
+  m_stats = stats;
+
+  if (!config.is_object()) {
+    return;
+  }
+
+  // The TP fields are narrower than 64 bits: a bound at the field's maximum
+  // is no bound at all.
+  if (configure_range(config,
+                      "min_time_over_threshold",
+                      "max_time_over_threshold",
+                      std::numeric_limits<uint32_t>::max(),
+                      m_tot_lo,
+                      m_tot_span))
+    m_enabled |= kToT;
+  if (configure_range(config,
+                      "min_adc_integral",
+                      "max_adc_integral",
+                      std::numeric_limits<uint32_t>::max(),
+                      m_adc_integral_lo,
+                      m_adc_integral_span))
+    m_enabled |= kADCIntegral;
+  if (configure_range(config,
+                      "min_adc_peak",
+                      "max_adc_peak",
+                      std::numeric_limits<uint16_t>::max(),
+                      m_adc_peak_lo,
+                      m_adc_peak_span))
+    m_enabled |= kADCPeak;
+
+  // Plane selection and channel masking are folded into one table.
+  if (config.contains("planes")) {
+    // No default channel map: the wrong one would silently keep the wrong planes.
+    if (!config.contains("n_channels") || !config.contains("channel_map"))
+      throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+    uint32_t n_channels = config["n_channels"];
+    std::string channel_map_name = config["channel_map"];
+    auto channel_map = dunedaq::detchannelmaps::make_map(channel_map_name);
+
+    std::array<uint8_t, 3> keep_plane = { 0, 0, 0 };
+    for (unsigned plane : config["planes"]) {
+      if (plane >= keep_plane.size())
+        throw BadConfiguration(ERS_HERE, TRACE_NAME);
+      keep_plane[plane] = 1;
+    }
+
+    m_n_channels = n_channels;
+    m_channel_accept.resize(n_channels);
+    for (uint32_t channel = 0; channel < n_channels; ++channel) {
+      unsigned plane = channel_map->get_plane_from_offline_channel(channel);
+      m_channel_accept[channel] = plane < keep_plane.size() ? keep_plane[plane] : 0;
+    }
+    // Can't tell the plane of channels outside the configured range.
+    m_channel_accept_default = 0;
+    m_enabled |= kChannel;
+  }
+
+  if (config.contains("channel_mask")) {
+    for (channel_t channel : config["channel_mask"]) {
+      if (channel < 0)
+        throw BadConfiguration(ERS_HERE, TRACE_NAME);
+      if (static_cast<uint32_t>(channel) >= m_n_channels) {
+        m_n_channels = channel + 1;
+        m_channel_accept.resize(m_n_channels, m_channel_accept_default);
+      }
+      m_channel_accept[channel] = 0;
+    }
+    m_enabled |= kChannel;
+  }
+  if (m_enabled & kChannel)
+    m_channel_accept.resize(m_n_channels + kTablePadding, 0);
+
+  if (config.contains("detids")) {
+    m_detid_accept.assign(std::numeric_limits<detid_t>::max() + 1 + kTablePadding, 0);
+    for (detid_t detid : config["detids"]) {
+      m_detid_accept[detid] = 1;
+    }
+    m_enabled |= kDetID;
+  }
+
+  m_predicate = select_predicate(m_enabled);
+
+  TLOG_DEBUG(TLVL_DEBUG_LOW) << "[TPF]: enabled filters 0x" << std::hex << m_enabled << std::dec
+                             << ", channel table size " << m_n_channels;
+}
+
+} // namespace triggeralgs
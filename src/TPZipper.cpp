@@ -0,0 +1,208 @@
+/**
+ * @file TPZipper.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/TPZipper.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace triggeralgs {
+
+TPZipper::TPZipper(size_t n_links)
+  : m_links(n_links)
+{
+  m_heap.reserve(n_links);
+}
+
+void
+TPZipper::configure(const nlohmann::json& config)
+{
+  if (!config.is_object()) {
+    return;
+  }
+
+  if (config.contains("max_lateness"))
+    m_max_lateness = config["max_lateness"];
+  if (config.contains("timeout_ms"))
+    m_timeout = std::chrono::milliseconds(config["timeout_ms"].get<int64_t>());
+}
+
+bool
+TPZipper::add(size_t link_idx, const TriggerPrimitive& input_tp)
+{
+  ++m_stats.n_added;
+  if (input_tp.time_start < m_output_time) {
+    ++m_stats.n_dropped;
+    return false;
+  }
+
+  Link& link = m_links[link_idx];
+  bool was_empty = link.empty();
+
+  if (input_tp.time_start >= link.watermark) {
+    // The usual case: the link's TPs come in time order.
+    link.tps.push_back(input_tp);
+    advance_watermark(link, input_tp.time_start);
+  } else {
+    ++m_stats.n_late;
+    // Late TPs are expected to be only a little out of order, so look for
+    // their place from the back.
+    auto pos = link.tps.end();
+    auto first = link.tps.begin() + link.head;
+    while (pos != first && (pos - 1)->time_start > input_tp.time_start) {
+      --pos;
+    }
+    bool new_head = !was_empty && pos == first;
+    link.tps.insert(pos, input_tp);
+    if (new_head) {
+      // The link's key in the heap went down.
+      for (HeapEntry& entry : m_heap) {
+        if (entry.link == link_idx) {
+          entry.time = input_tp.time_start;
+        }
+      }
+      std::make_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+    }
+  }
+
+  if (was_empty) {
+    m_heap.push_back({ link.head_time(), link_idx });
+    std::push_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+  }
+  ++m_n_buffered;
+  return true;
+}
+
+void
+TPZipper::add(size_t link_idx, span<const TriggerPrimitive> input_tps)
+{
+  for (const TriggerPrimitive& input_tp : input_tps) {
+    add(link_idx, input_tp);
+  }
+}
+
+void
+TPZipper::heartbeat(size_t link_idx, timestamp_t time)
+{
+  advance_watermark(m_links[link_idx], time);
+}
+
+void
+TPZipper::advance_watermark(Link& link, timestamp_t time)
+{
+  // m_min_watermark is left to drain() to bring up to date, so advancing a
+  // link does not cost a pass over all of them.
+  if (time > link.watermark) {
+    link.watermark = time;
+    m_max_watermark = std::max(m_max_watermark, time);
+  }
+}
+
+void
+TPZipper::drain(std::vector<TriggerPrimitive>& output_tps)
+{
+  bool min_watermark_updated = false;
+  while (!m_heap.empty()) {
+    timestamp_t time = m_heap.front().time;
+
+    if (time > m_min_watermark && !min_watermark_updated) {
+      m_min_watermark = std::numeric_limits<timestamp_t>::max();
+      for (const Link& link : m_links) {
+        m_min_watermark = std::min(m_min_watermark, link.watermark);
+      }
+      min_watermark_updated = true;
+    }
+
+    if (time > m_min_watermark) {
+      // Some link may still send an earlier TP, unless it is too far behind.
+      if (m_max_watermark - time <= m_max_lateness) {
+        break;
+      }
+      ++m_stats.n_forced;
+    }
+
+    output_front(output_tps);
+  }
+}
+
+void
+TPZipper::flush(timestamp_t until, std::vector<TriggerPrimitive>& output_tps)
+{
+  while (!m_heap.empty() && m_heap.front().time <= until) {
+    output_front(output_tps);
+  }
+}
+
+bool
+TPZipper::flush_on_timeout(std::vector<TriggerPrimitive>& output_tps, std::chrono::steady_clock::time_point now)
+{
+  if (m_stats.n_added != m_n_added_at_last_check) {
+    m_n_added_at_last_check = m_stats.n_added;
+    m_last_progress_time = now;
+    return false;
+  }
+  if (now - m_last_progress_time < m_timeout) {
+    return false;
+  }
+
+  ++m_stats.n_timeouts;
+  m_last_progress_time = now;
+  flush(output_tps);
+  return true;
+}
+
+void
+TPZipper::output_front(std::vector<TriggerPrimitive>& output_tps)
+{
+  Link& link = m_links[m_heap.front().link];
+  output_tps.push_back(link.tps[link.head]);
+  m_output_time = link.tps[link.head].time_start;
+  ++link.head;
+  --m_n_buffered;
+  ++m_stats.n_output;
+
+  if (link.empty()) {
+    // Keep the buffer's capacity for the link's next TPs.
+    link.tps.clear();
+    link.head = 0;
+    std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+    m_heap.pop_back();
+  } else {
+    if (link.head >= s_compact_threshold && 2 * link.head >= link.tps.size()) {
+      // A link that never runs dry still needs its output TPs dropped now and then.
+      link.tps.erase(link.tps.begin(), link.tps.begin() + link.head);
+      link.head = 0;
+    }
+    m_heap.front().time = link.head_time();
+    sift_down(0);
+  }
+}
+
+void
+TPZipper::sift_down(size_t idx)
+{
+  HeapEntry entry = m_heap[idx];
+  size_t size = m_heap.size();
+  while (true) {
+    size_t child = 2 * idx + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size && m_heap[child] > m_heap[child + 1]) {
+      ++child;
+    }
+    if (!(entry > m_heap[child])) {
+      break;
+    }
+    m_heap[idx] = m_heap[child];
+    idx = child;
+  }
+  m_heap[idx] = entry;
+}
+
+} // namespace triggeralgs
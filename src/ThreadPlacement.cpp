@@ -0,0 +1,155 @@
+/**
+ * @file ThreadPlacement.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/ThreadPlacement.hpp"
+
+#include "triggeralgs/Issues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "TRACE/trace.h"
+#define TRACE_NAME "ThreadPlacement"
+
+namespace triggeralgs {
+
+namespace {
+
+// Linux thread names are 15 characters and the terminating null
+constexpr size_t max_name_length = 15;
+// MPOL_PREFERRED of linux/mempolicy.h: allocate on the node while it has memory
+constexpr int mpol_preferred = 1;
+constexpr int max_numa_nodes = 1024;
+
+std::string
+node_path(int node)
+{
+  return "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+}
+
+} // namespace
+
+void
+ThreadPlacement::configure(const nlohmann::json& config, const std::string& default_name)
+{
+  m_cpus.clear();
+  m_numa_node = -1;
+  m_name = default_name;
+
+  if (config.is_object()) {
+    if (config.contains("cpus"))
+      m_cpus = config["cpus"].get<std::vector<int>>();
+    if (config.contains("numa_node"))
+      m_numa_node = config["numa_node"];
+    if (config.contains("name"))
+      m_name = config["name"];
+  }
+
+  for (int cpu : m_cpus) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+      throw BadConfiguration(ERS_HERE, TRACE_NAME);
+#else
+    if (cpu < 0)
+      throw BadConfiguration(ERS_HERE, TRACE_NAME);
+#endif
+  }
+  if (m_numa_node >= max_numa_nodes)
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+  if (m_numa_node >= 0 && m_cpus.empty()) {
+    m_cpus = cpus_of_node(m_numa_node);
+  }
+  if (m_name.size() > max_name_length) {
+    m_name.resize(max_name_length);
+  }
+}
+
+bool
+ThreadPlacement::apply() const
+{
+  bool placed = true;
+#ifdef __linux__
+  if (!m_name.empty()) {
+    pthread_setname_np(pthread_self(), m_name.c_str());
+  }
+
+  if (!m_cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : m_cpus) {
+      CPU_SET(cpu, &cpu_set);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+      TLOG() << "[PL]: " << m_name << ": could not set the CPU affinity";
+      placed = false;
+    }
+  }
+
+  if (m_numa_node >= 0) {
+    constexpr size_t bits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> node_mask(max_numa_nodes / bits, 0);
+    node_mask[m_numa_node / bits] |= 1ul << (m_numa_node % bits);
+    if (syscall(SYS_set_mempolicy, mpol_preferred, node_mask.data(), max_numa_nodes + 1) != 0) {
+      TLOG() << "[PL]: " << m_name << ": could not prefer NUMA node " << m_numa_node;
+      placed = false;
+    }
+  }
+#else
+  placed = m_cpus.empty() && m_numa_node < 0;
+#endif
+  return placed;
+}
+
+int
+ThreadPlacement::n_numa_nodes()
+{
+  int n_nodes = 0;
+  while (n_nodes < max_numa_nodes && std::ifstream(node_path(n_nodes)).good()) {
+    ++n_nodes;
+  }
+  return n_nodes > 0 ? n_nodes : 1;
+}
+
+std::vector<int>
+ThreadPlacement::cpus_of_node(int node)
+{
+  // A cpulist reads like "0-7,16-23"
+  std::vector<int> cpus;
+  std::ifstream file(node_path(node));
+  std::string range;
+  while (std::getline(file, range, ',')) {
+    std::istringstream stream(range);
+    int first = 0;
+    int last = 0;
+    char dash = 0;
+    if (!(stream >> first)) {
+      continue;
+    }
+    last = (stream >> dash >> last) ? last : first;
+    for (int cpu = first; cpu <= last; ++cpu) {
+#ifdef __linux__
+      // apply() can only set the CPUs a cpu_set_t holds
+      if (cpu >= CPU_SETSIZE)
+        break;
+#endif
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,425 @@
+/**
+ * @file TriggerPipeline.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/TriggerPipeline.hpp"
+
+#include "triggeralgs/TriggerActivityFactory.hpp"
+#include "triggeralgs/TriggerCandidateFactory.hpp"
+#include "triggeralgs/TriggerDecisionFactory.hpp"
+
+#include <exception>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include "TRACE/trace.h"
+#define TRACE_NAME "TriggerPipeline"
+
+namespace triggeralgs {
+
+TriggerPipeline::~TriggerPipeline()
+{
+  stop_threads();
+}
+
+void
+TriggerPipeline::configure(const nlohmann::json& config)
+{
+  stop_threads();
+
+  if (!config.is_object() || !config.contains("ta_algorithm") || !config.contains("tc_algorithm"))
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+
+  std::string ta_algorithm = config["ta_algorithm"];
+  std::string tc_algorithm = config["tc_algorithm"];
+  std::string td_algorithm = "TDMakerSupernovaAlgorithm";
+  if (config.contains("td_algorithm"))
+    td_algorithm = config["td_algorithm"];
+  size_t queue_size = 64;
+  if (config.contains("queue_size"))
+    queue_size = config["queue_size"];
+  if (queue_size == 0)
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+  nlohmann::json placement = config.contains("placement") ? config["placement"] : nlohmann::json::object();
+  m_ta_placement.configure(placement.contains("ta") ? placement["ta"] : nlohmann::json(), "pipeline-ta");
+  m_tc_placement.configure(placement.contains("tc") ? placement["tc"] : nlohmann::json(), "pipeline-tc");
+  m_td_placement.configure(placement.contains("td") ? placement["td"] : nlohmann::json(), "pipeline-td");
+
+  TLOG() << "[TP]: stages     : " << ta_algorithm << " -> " << tc_algorithm << " -> " << td_algorithm;
+  TLOG() << "[TP]: queue size : " << queue_size;
+
+  m_load_shedder.configure(config.contains("load_shedding") ? config["load_shedding"] : nlohmann::json::object());
+  m_drained.clear();
+  m_ended = false;
+  m_n_tps = 0;
+  m_n_tds = 0;
+  m_n_input_full = 0;
+  m_n_tas = 0;
+  m_n_tcs = 0;
+  m_n_stage_full = 0;
+
+  // Each stage thread builds its maker and its input queue once placed, so
+  // they are first touched on its NUMA node; the TD stage also allocates the
+  // queue it outputs to. The stages only start running once all of them are
+  // set up, so a bad configuration leaves no thread behind.
+  auto ta_factory = TriggerActivityFactory::get_instance();
+  auto tc_factory = TriggerCandidateFactory::get_instance();
+  auto td_factory = TriggerDecisionFactory::get_instance();
+  auto maker_config = [&config](const char* key) {
+    return config.contains(key) ? config[key] : nlohmann::json::object();
+  };
+  std::promise<bool> start;
+  std::shared_future<bool> started = start.get_future().share();
+  std::vector<std::future<void>> ready;
+  m_ta_thread = start_stage(
+    m_ta_placement,
+    [&] {
+      m_ta_maker = ta_factory->build_maker(ta_algorithm);
+      m_ta_maker->configure(maker_config("ta_config"));
+      m_tp_queue = std::make_unique<BatchQueue<TriggerPrimitive>>(queue_size);
+    },
+    &TriggerPipeline::run_ta_stage,
+    ready,
+    started);
+  m_tc_thread = start_stage(
+    m_tc_placement,
+    [&] {
+      m_tc_maker = tc_factory->build_maker(tc_algorithm);
+      m_tc_maker->configure(maker_config("tc_config"));
+      m_ta_queue = std::make_unique<BatchQueue<TriggerActivity>>(queue_size);
+    },
+    &TriggerPipeline::run_tc_stage,
+    ready,
+    started);
+  m_td_thread = start_stage(
+    m_td_placement,
+    [&] {
+      m_td_maker = td_factory->build_maker(td_algorithm);
+      m_td_maker->configure(maker_config("td_config"));
+      m_tc_queue = std::make_unique<BatchQueue<TriggerCandidate>>(queue_size);
+      m_td_queue = std::make_unique<BatchQueue<TriggerDecision>>(queue_size);
+    },
+    &TriggerPipeline::run_td_stage,
+    ready,
+    started);
+
+  std::exception_ptr error;
+  for (auto& stage_ready : ready) {
+    try {
+      stage_ready.get();
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  }
+  start.set_value(!error);
+  if (error) {
+    m_ta_thread.join();
+    m_tc_thread.join();
+    m_td_thread.join();
+    m_tp_queue.reset();
+    m_ta_queue.reset();
+    m_tc_queue.reset();
+    m_td_queue.reset();
+    std::rethrow_exception(error);
+  }
+}
+
+template<class Setup>
+std::thread
+TriggerPipeline::start_stage(const ThreadPlacement& placement,
+                             Setup&& setup,
+                             void (TriggerPipeline::*run)(),
+                             std::vector<std::future<void>>& ready,
+                             std::shared_future<bool> started)
+{
+  std::promise<void> set_up;
+  ready.push_back(set_up.get_future());
+  auto body = [this, &placement, setup = std::forward<Setup>(setup), run, set_up = std::move(set_up), started]() mutable {
+    placement.apply();
+    try {
+      setup();
+      set_up.set_value();
+    } catch (...) {
+      set_up.set_exception(std::current_exception());
+    }
+    if (started.get()) {
+      (this->*run)();
+    }
+  };
+  return std::thread(std::move(body));
+}
+
+void
+TriggerPipeline::push(span<const TriggerPrimitive> input_tps)
+{
+  check_running();
+  Batch<TriggerPrimitive> batch;
+  if (!make_batch(input_tps, batch)) {
+    return;
+  }
+  m_n_tps += input_tps.size();
+  send(std::move(batch));
+}
+
+bool
+TriggerPipeline::try_push(span<const TriggerPrimitive> input_tps)
+{
+  check_running();
+  Batch<TriggerPrimitive> batch;
+  if (!make_batch(input_tps, batch)) {
+    return true;
+  }
+  if (!m_tp_queue->try_push(std::move(batch))) {
+    ++m_n_input_full;
+    return false;
+  }
+  m_n_tps += input_tps.size();
+  return true;
+}
+
+bool
+TriggerPipeline::make_batch(span<const TriggerPrimitive> input_tps, Batch<TriggerPrimitive>& batch)
+{
+  if (input_tps.empty() || !m_load_shedder.admit(input_tps.size(), m_tp_queue->size_approx())) {
+    return false;
+  }
+  batch.objects.assign(input_tps.begin(), input_tps.end());
+  if (m_load_shedder.enabled()) {
+    batch.pushed = std::chrono::steady_clock::now();
+  }
+  return true;
+}
+
+void
+TriggerPipeline::heartbeat(timestamp_t until)
+{
+  check_running();
+  Batch<TriggerPrimitive> batch;
+  batch.watermark = until;
+  batch.heartbeat = true;
+  send(std::move(batch));
+}
+
+void
+TriggerPipeline::send(Batch<TriggerPrimitive>&& batch)
+{
+  if (m_tp_queue->try_push(std::move(batch))) {
+    return;
+  }
+  ++m_n_input_full;
+  // Take the TDs out meanwhile: the last stage may be waiting for room too.
+  do {
+    drain(m_drained);
+    std::this_thread::yield();
+  } while (!m_tp_queue->try_push(std::move(batch)));
+}
+
+template<class Object>
+void
+TriggerPipeline::forward(BatchQueue<Object>& queue, Batch<Object>&& batch)
+{
+  if (queue.try_push(std::move(batch))) {
+    return;
+  }
+  m_n_stage_full.fetch_add(1, std::memory_order_relaxed);
+  queue.push(std::move(batch));
+}
+
+// The heartbeat and end batches carry no object, so a stage's flush output
+// is never postprocessed along with the output of its batch processing.
+
+void
+TriggerPipeline::run_ta_stage()
+{
+  Batch<TriggerPrimitive> input;
+  Batch<TriggerActivity> output;
+  while (true) {
+    // Sleeps while the stage has no input
+    m_tp_queue->pop(input);
+
+    if (!input.objects.empty() && m_load_shedder.enabled()) {
+      auto latency = std::chrono::steady_clock::now() - input.pushed;
+      m_load_shedder.update(m_tp_queue->size_approx(),
+                            std::chrono::duration_cast<std::chrono::microseconds>(latency),
+                            *m_ta_maker);
+      m_load_shedder.shed(input.objects);
+    }
+    if (!input.objects.empty()) {
+      m_ta_maker->process_batch(input.objects, output.objects);
+    }
+    if (input.end) {
+      m_ta_maker->flush(std::numeric_limits<timestamp_t>::max(), output.objects);
+    } else if (input.heartbeat) {
+      m_ta_maker->flush(input.watermark, output.objects);
+    }
+
+    m_n_tas.fetch_add(output.objects.size(), std::memory_order_relaxed);
+    if (!output.objects.empty() || input.heartbeat || input.end) {
+      output.watermark = input.watermark;
+      output.heartbeat = input.heartbeat;
+      output.end = input.end;
+      forward(*m_ta_queue, std::move(output));
+      output = Batch<TriggerActivity>();
+    }
+    if (input.end) {
+      return;
+    }
+  }
+}
+
+void
+TriggerPipeline::run_tc_stage()
+{
+  Batch<TriggerActivity> input;
+  Batch<TriggerCandidate> output;
+  // The TC maker postprocesses all of the TCs in the vector it is given.
+  std::vector<TriggerCandidate> made;
+  while (true) {
+    // Sleeps while the stage has no input
+    m_ta_queue->pop(input);
+
+    for (TriggerActivity& input_ta : input.objects) {
+      (*m_tc_maker)(std::move(input_ta), made);
+      std::move(made.begin(), made.end(), std::back_inserter(output.objects));
+      made.clear();
+      // Back to the TA maker's pool, unless the TC maker kept its TPs
+      if (input_ta.inputs.capacity() > 0) {
+        m_ta_maker->recycle_from_any_thread(std::move(input_ta));
+      }
+    }
+    if (input.end) {
+      m_tc_maker->flush(std::numeric_limits<timestamp_t>::max(), made);
+    } else if (input.heartbeat) {
+      m_tc_maker->advance_watermark(input.watermark, made);
+    }
+    std::move(made.begin(), made.end(), std::back_inserter(output.objects));
+    made.clear();
+
+    m_n_tcs.fetch_add(output.objects.size(), std::memory_order_relaxed);
+    if (!output.objects.empty() || input.heartbeat || input.end) {
+      output.watermark = input.watermark;
+      output.heartbeat = input.heartbeat;
+      output.end = input.end;
+      forward(*m_tc_queue, std::move(output));
+      output = Batch<TriggerCandidate>();
+    }
+    if (input.end) {
+      return;
+    }
+  }
+}
+
+void
+TriggerPipeline::run_td_stage()
+{
+  Batch<TriggerCandidate> input;
+  Batch<TriggerDecision> output;
+  while (true) {
+    // Sleeps while the stage has no input
+    m_tc_queue->pop(input);
+
+    for (TriggerCandidate& input_tc : input.objects) {
+      (*m_td_maker)(input_tc, output.objects);
+      m_tc_maker->recycle_from_any_thread(std::move(input_tc));
+    }
+    if (input.end) {
+      m_td_maker->flush(output.objects);
+    }
+
+    if (!output.objects.empty() || input.end) {
+      output.end = input.end;
+      forward(*m_td_queue, std::move(output));
+      output = Batch<TriggerDecision>();
+    }
+    if (input.end) {
+      return;
+    }
+  }
+}
+
+void
+TriggerPipeline::drain(std::vector<TriggerDecision>& output_td)
+{
+  if (&output_td != &m_drained && !m_drained.empty()) {
+    std::move(m_drained.begin(), m_drained.end(), std::back_inserter(output_td));
+    m_drained.clear();
+  }
+  if (!m_td_queue) {
+    return;
+  }
+
+  Batch<TriggerDecision> batch;
+  while (m_td_queue->try_pop(batch)) {
+    receive(batch, output_td);
+  }
+}
+
+void
+TriggerPipeline::receive(Batch<TriggerDecision>& batch, std::vector<TriggerDecision>& output_td)
+{
+  m_n_tds += batch.objects.size();
+  std::move(batch.objects.begin(), batch.objects.end(), std::back_inserter(output_td));
+  m_ended |= batch.end;
+}
+
+void
+TriggerPipeline::stop(std::vector<TriggerDecision>& output_td)
+{
+  if (m_ta_thread.joinable()) {
+    Batch<TriggerPrimitive> batch;
+    batch.end = true;
+    send(std::move(batch));
+    drain(output_td);
+    Batch<TriggerDecision> output;
+    while (!m_ended) {
+      m_td_queue->pop(output);
+      receive(output, output_td);
+    }
+    m_ta_thread.join();
+    m_tc_thread.join();
+    m_td_thread.join();
+  }
+  drain(output_td);
+}
+
+void
+TriggerPipeline::check_running() const
+{
+  // Before configure() or after stop(), nothing would take the TPs off the queue.
+  if (!m_ta_thread.joinable())
+    throw BadConfiguration(ERS_HERE, TRACE_NAME);
+}
+
+void
+TriggerPipeline::stop_threads()
+{
+  std::vector<TriggerDecision> dropped;
+  stop(dropped);
+}
+
+TriggerPipeline::Stats
+TriggerPipeline::stats() const
+{
+  Stats stats;
+  stats.n_tps = m_n_tps;
+  stats.n_tas = m_n_tas.load(std::memory_order_relaxed);
+  stats.n_tcs = m_n_tcs.load(std::memory_order_relaxed);
+  stats.n_tds = m_n_tds;
+  stats.n_input_full = m_n_input_full;
+  stats.n_stage_full = m_n_stage_full.load(std::memory_order_relaxed);
+  if (m_ta_maker && m_tc_maker) {
+    stats.n_ta_reused = m_ta_maker->m_ta_pool.n_hits();
+    stats.n_tc_reused = m_tc_maker->m_tc_pool.n_hits();
+  }
+  stats.shedding = m_load_shedder.stats();
+  return stats;
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,73 @@
+/**
+ * @file WindowStats.cpp
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/WindowStats.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace triggeralgs::window_stats {
+
+void
+ChannelCounts::on_add(const TriggerActivity& ta, size_t position)
+{
+  ChannelSummary summary;
+  if (!m_spare_summaries.empty()) {
+    summary = std::move(m_spare_summaries.back());
+    m_spare_summaries.pop_back();
+  }
+  // Sort the TP channels, then merge the hits of each channel.
+  for (const TriggerPrimitive& tp : ta.inputs)
+    summary.push_back({ tp.channel, 1 });
+  std::sort(summary.begin(), summary.end(), [](const ChannelHits& a, const ChannelHits& b) {
+    return a.channel < b.channel;
+  });
+  size_t n_distinct = 0;
+  for (const ChannelHits& hits : summary) {
+    if (n_distinct > 0 && summary[n_distinct - 1].channel == hits.channel)
+      summary[n_distinct - 1].n_hits++;
+    else
+      summary[n_distinct++] = hits;
+  }
+  summary.resize(n_distinct);
+
+  for (const ChannelHits& hits : summary)
+    channel_states.add(hits.channel, hits.n_hits);
+
+  if (position == m_channel_summaries.size())
+    m_channel_summaries.push_back(std::move(summary));
+  else
+    m_channel_summaries.insert(m_channel_summaries.begin() + position, std::move(summary));
+}
+
+void
+ChannelCounts::on_expire(const TriggerActivity&)
+{
+  // TAs expire oldest first, as do their summaries.
+  remove_channels(m_channel_summaries.front());
+  m_channel_summaries.pop_front();
+}
+
+void
+ChannelCounts::on_clear(const WindowBuffer<TriggerActivity>&)
+{
+  for (ChannelSummary& summary : m_channel_summaries)
+    remove_channels(summary);
+  m_channel_summaries.clear();
+}
+
+void
+ChannelCounts::remove_channels(ChannelSummary& summary)
+{
+  for (const ChannelHits& hits : summary)
+    channel_states.remove(hits.channel, hits.n_hits);
+  summary.clear();
+  m_spare_summaries.push_back(std::move(summary));
+}
+
+} // namespace triggeralgs::window_stats
@@ -136,8 +136,10 @@ IncrementalDBSCAN::add_point(float time, float channel, std::vector<Cluster>* co
 void
 IncrementalDBSCAN::add_primitive(const triggeralgs::TriggerPrimitive& prim, std::vector<Cluster>* completed_clusters)
 {
-    if(m_first_prim_time==0){
+    // A TP at time 0 is a valid first TP, so don't use the time as the marker
+    if(!m_has_primitives){
         m_first_prim_time=prim.time_start;
+        m_has_primitives=true;
     }
     
     Hit& new_hit=m_hit_pool[m_pool_end];
@@ -261,7 +263,21 @@ IncrementalDBSCAN::add_hit(Hit* new_hit, std::vector<Cluster>* completed_cluster
         }
     }
 
+    remove_completed_clusters(completed_clusters);
+}
 
+//======================================================================
+void
+IncrementalDBSCAN::flush(float time, std::vector<Cluster>* completed_clusters)
+{
+    m_latest_time = std::max(m_latest_time, time);
+    remove_completed_clusters(completed_clusters);
+}
+
+//======================================================================
+void
+IncrementalDBSCAN::remove_completed_clusters(std::vector<Cluster>* completed_clusters)
+{
     // Delete any completed clusters from the list. Put them in the
     // `completed_clusters` vector, if that vector was passed
     auto clust_it = m_clusters.begin();
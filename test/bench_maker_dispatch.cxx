@@ -0,0 +1,201 @@
+/**
+ * @file bench_maker_dispatch.cxx
+ *
+ * Compares the TP throughput of the TA makers when driven through the
+ * factory-built polymorphic maker and through StaticTriggerActivityMaker,
+ * one TP at a time and in blocks of block_size TPs.
+ *
+ * Usage: bench_maker_dispatch [n_tps] [n_repeats] [block_size]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/StaticTriggerActivityMakers.hpp"
+#include "triggeralgs/TriggerActivityFactory.hpp"
+
+#include "triggeralgs/BundleN/TAMakerBundleNAlgorithm.hpp"
+#include "triggeralgs/MichelElectron/TAMakerMichelElectronAlgorithm.hpp"
+#include "triggeralgs/PlaneCoincidence/TAMakerPlaneCoincidenceAlgorithm.hpp"
+#include "triggeralgs/Prescale/TAMakerPrescaleAlgorithm.hpp"
+#include "triggeralgs/Supernova/TAMakerSupernovaAlgorithm.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace triggeralgs;
+
+namespace {
+
+std::vector<TriggerPrimitive>
+make_tps(size_t n_tps)
+{
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> channel(0, 2559);
+  std::uniform_int_distribution<int> tot(1, 40);
+  std::uniform_int_distribution<int> adc(20, 4000);
+
+  std::vector<TriggerPrimitive> tps(n_tps);
+  timestamp_t time = 1'000'000;
+  for (TriggerPrimitive& tp : tps) {
+    time += 1 + rng() % 8;
+    tp.type = TriggerPrimitive::Type::kTPC;
+    tp.algorithm = TriggerPrimitive::Algorithm::kSimpleThreshold;
+    tp.time_start = time;
+    tp.time_over_threshold = tot(rng) * 32;
+    tp.time_peak = time + tp.time_over_threshold / 2;
+    tp.adc_integral = adc(rng);
+    tp.adc_peak = tp.adc_integral / 4;
+    tp.channel = channel(rng);
+    tp.detid = 0;
+  }
+  return tps;
+}
+
+// Best-of-n_repeats TPs/s for one maker type, with a fresh maker per repeat.
+// run(maker, block, output_ta) feeds a block of TPs to the maker.
+template<class MakeMaker, class Run>
+double
+measure(MakeMaker make_maker,
+        Run run,
+        const std::vector<TriggerPrimitive>& tps,
+        size_t block_size,
+        size_t n_repeats,
+        size_t& n_tas)
+{
+  double best = 0;
+  for (size_t rep = 0; rep < n_repeats; ++rep) {
+    auto maker = make_maker();
+    maker->configure(nlohmann::json::object());
+    std::vector<TriggerActivity> output_ta;
+    n_tas = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < tps.size(); first += block_size) {
+      span<const TriggerPrimitive> block(tps.data() + first, std::min(block_size, tps.size() - first));
+      run(*maker, block, output_ta);
+      n_tas += output_ta.size();
+      output_ta.clear();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double rate = tps.size() / elapsed.count();
+    if (rate > best)
+      best = rate;
+  }
+  return best;
+}
+
+void
+print_row(const std::string& name,
+          const char* path,
+          double virtual_rate,
+          double static_rate,
+          size_t virtual_tas,
+          size_t static_tas)
+{
+  std::printf("%-36s %-6s %12.3e %12.3e %8.2fx %8zu %8zu%s\n",
+              name.c_str(),
+              path,
+              virtual_rate,
+              static_rate,
+              static_rate / virtual_rate,
+              virtual_tas,
+              static_tas,
+              virtual_tas == static_tas ? "" : "  MISMATCH");
+  std::fflush(stdout);
+}
+
+// The per-TP operator() paths, then the batch paths: the virtual
+// process_batch() against the static process_span()
+template<class Algorithm>
+void
+compare(const std::string& name, const std::vector<TriggerPrimitive>& tps, size_t n_repeats, size_t block_size)
+{
+  using StaticMaker = StaticTriggerActivityMaker<Algorithm>;
+  auto make_virtual = [&]() { return TriggerActivityFactory::get_instance()->build_maker(name); };
+  auto make_static = []() { return std::make_unique<StaticMaker>(); };
+
+  size_t virtual_tas = 0, static_tas = 0;
+  double virtual_rate = measure(
+    make_virtual,
+    [](TriggerActivityMaker& maker, span<const TriggerPrimitive> block, std::vector<TriggerActivity>& output_ta) {
+      for (const TriggerPrimitive& tp : block)
+        maker(tp, output_ta);
+    },
+    tps,
+    block_size,
+    n_repeats,
+    virtual_tas);
+  double static_rate = measure(
+    make_static,
+    [](StaticMaker& maker, span<const TriggerPrimitive> block, std::vector<TriggerActivity>& output_ta) {
+      for (const TriggerPrimitive& tp : block)
+        maker(tp, output_ta);
+    },
+    tps,
+    block_size,
+    n_repeats,
+    static_tas);
+  print_row(name, "per-TP", virtual_rate, static_rate, virtual_tas, static_tas);
+
+  virtual_rate = measure(
+    make_virtual,
+    [](TriggerActivityMaker& maker, span<const TriggerPrimitive> block, std::vector<TriggerActivity>& output_ta) {
+      maker.process_batch(block, output_ta);
+    },
+    tps,
+    block_size,
+    n_repeats,
+    virtual_tas);
+  static_rate = measure(
+    make_static,
+    [](StaticMaker& maker, span<const TriggerPrimitive> block, std::vector<TriggerActivity>& output_ta) {
+      maker.process_span(block, output_ta);
+    },
+    tps,
+    block_size,
+    n_repeats,
+    static_tas);
+  print_row(name, "batch", virtual_rate, static_rate, virtual_tas, static_tas);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t n_tps = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100'000;
+  size_t n_repeats = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+  size_t block_size = std::max<size_t>(1, argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1024);
+
+  std::vector<TriggerPrimitive> tps = make_tps(n_tps);
+
+  std::printf("%-36s %-6s %12s %12s %9s %8s %8s\n",
+              "algorithm",
+              "path",
+              "virtual TP/s",
+              "static TP/s",
+              "speedup",
+              "TAs",
+              "TAs");
+  compare<TAMakerADCSimpleWindowAlgorithm>("TAMakerADCSimpleWindowAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerBundleNAlgorithm>("TAMakerBundleNAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerChannelAdjacencyAlgorithm>("TAMakerChannelAdjacencyAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerChannelDistanceAlgorithm>("TAMakerChannelDistanceAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerDBSCANAlgorithm>("TAMakerDBSCANAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerHorizontalMuonAlgorithm>("TAMakerHorizontalMuonAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerMichelElectronAlgorithm>("TAMakerMichelElectronAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerPlaneCoincidenceAlgorithm>("TAMakerPlaneCoincidenceAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerPrescaleAlgorithm>("TAMakerPrescaleAlgorithm", tps, n_repeats, block_size);
+  compare<TAMakerSupernovaAlgorithm>("TAMakerSupernovaAlgorithm", tps, n_repeats, block_size);
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file bench_maker_scheduler.cxx
+ *
+ * Compares running many TA makers with uneven loads on MakerScheduler's
+ * worker pool against one thread per maker. A few of the makers get
+ * burst_factor times the TPs of the others, as when a cosmic shower hits a
+ * few links. Both modes process the same pre-made TP blocks.
+ *
+ * Usage: bench_maker_scheduler [n_makers] [n_workers] [burst_factor] [algorithm]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/MakerScheduler.hpp"
+#include "triggeralgs/TriggerActivityFactory.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace triggeralgs;
+
+namespace {
+
+constexpr size_t block_size = 1024;
+constexpr size_t n_quiet_blocks = 50;
+// One maker in n_busy_every is a busy one
+constexpr size_t n_busy_every = 8;
+
+using Blocks = std::vector<std::vector<TriggerPrimitive>>;
+
+Blocks
+make_blocks(unsigned seed, size_t n_blocks)
+{
+  std::mt19937 rng(seed);
+  Blocks blocks(n_blocks, std::vector<TriggerPrimitive>(block_size));
+  timestamp_t time = 1'000'000;
+  for (auto& block : blocks) {
+    for (TriggerPrimitive& tp : block) {
+      time += rng() % 8;
+      tp.type = TriggerPrimitive::Type::kTPC;
+      tp.algorithm = TriggerPrimitive::Algorithm::kSimpleThreshold;
+      tp.time_start = time;
+      tp.time_over_threshold = 32 * (1 + rng() % 20);
+      tp.adc_integral = 20 + rng() % 2000;
+      tp.channel = rng() % 2560;
+    }
+  }
+  return blocks;
+}
+
+std::vector<std::unique_ptr<TriggerActivityMaker>>
+make_makers(const std::string& algorithm, size_t n_makers)
+{
+  std::vector<std::unique_ptr<TriggerActivityMaker>> makers;
+  for (size_t idx = 0; idx < n_makers; ++idx) {
+    makers.push_back(TriggerActivityFactory::get_instance()->build_maker(algorithm));
+    makers.back()->configure(nlohmann::json::object());
+  }
+  return makers;
+}
+
+double
+run_thread_per_maker(const std::string& algorithm, const std::vector<Blocks>& inputs)
+{
+  auto makers = make_makers(algorithm, inputs.size());
+  std::vector<std::thread> threads;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t idx = 0; idx < inputs.size(); ++idx) {
+    threads.emplace_back([&, idx] {
+      std::vector<TriggerActivity> output_ta;
+      for (const auto& block : inputs[idx]) {
+        makers[idx]->process_batch(block, output_ta);
+        for (TriggerActivity& ta : output_ta)
+          makers[idx]->recycle(std::move(ta));
+        output_ta.clear();
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+double
+run_scheduler(const std::string& algorithm, const std::vector<Blocks>& inputs, size_t n_workers, MakerScheduler::Stats& stats)
+{
+  auto makers = make_makers(algorithm, inputs.size());
+  MakerScheduler scheduler;
+  scheduler.configure({ { "n_workers", n_workers }, { "mailbox_size", 16 } });
+
+  std::vector<CallbackSink<TriggerActivity, std::function<void(TriggerActivity&&)>>> sinks;
+  sinks.reserve(inputs.size());
+  for (auto& maker : makers) {
+    TriggerActivityMaker* maker_ptr = maker.get();
+    sinks.emplace_back([maker_ptr](TriggerActivity&& ta) { maker_ptr->recycle(std::move(ta)); });
+    scheduler.add_maker(*maker, sinks.back());
+  }
+  scheduler.start();
+
+  auto start = std::chrono::steady_clock::now();
+  size_t max_blocks = 0;
+  for (const auto& blocks : inputs)
+    max_blocks = std::max(max_blocks, blocks.size());
+  for (size_t block = 0; block < max_blocks; ++block) {
+    for (size_t idx = 0; idx < inputs.size(); ++idx) {
+      if (block >= inputs[idx].size())
+        continue;
+      std::vector<TriggerPrimitive> tps = inputs[idx][block];
+      while (!scheduler.submit(idx, std::move(tps)))
+        std::this_thread::yield();
+    }
+  }
+  scheduler.wait();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  stats = scheduler.stats();
+  return elapsed.count();
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t n_makers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+  size_t n_workers = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+  size_t burst_factor = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10;
+  std::string algorithm = argc > 4 ? argv[4] : "TAMakerChannelDistanceAlgorithm";
+  n_workers = std::max<size_t>(n_workers, 1);
+
+  std::vector<Blocks> inputs;
+  size_t n_tps = 0;
+  for (size_t idx = 0; idx < n_makers; ++idx) {
+    size_t n_blocks = idx % n_busy_every == 0 ? burst_factor * n_quiet_blocks : n_quiet_blocks;
+    inputs.push_back(make_blocks(idx, n_blocks));
+    n_tps += n_blocks * block_size;
+  }
+
+  std::printf("%s: %zu makers (1 in %zu with %zux the load), %zu TPs\n",
+              algorithm.c_str(),
+              n_makers,
+              n_busy_every,
+              burst_factor,
+              n_tps);
+
+  double seconds = run_thread_per_maker(algorithm, inputs);
+  std::printf("%-28s %14.3e TPs/s\n", "thread per maker", n_tps / seconds);
+
+  MakerScheduler::Stats stats;
+  seconds = run_scheduler(algorithm, inputs, n_workers, stats);
+  std::printf("%-20s %3zu wkr %14.3e TPs/s  (%lu runs, %lu steals)\n",
+              "scheduler",
+              n_workers,
+              n_tps / seconds,
+              static_cast<unsigned long>(stats.n_runs),
+              static_cast<unsigned long>(stats.n_steals));
+
+  return 0;
+}
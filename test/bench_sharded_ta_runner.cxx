@@ -0,0 +1,111 @@
+/**
+ * @file bench_sharded_ta_runner.cxx
+ *
+ * Measures how the TP throughput of a TA maker scales with the number of
+ * channel shards ShardedTARunner runs it on, from 1 shard up to one per
+ * core. The TPs are noise spread over 4 APAs, pushed in blocks as they
+ * would arrive in TP fragments, with the merged TAs drained after each
+ * block.
+ *
+ * Usage: bench_sharded_ta_runner [algorithm] [max_shards] [n_tps] [block_size]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/ShardedTARunner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace triggeralgs;
+
+namespace {
+
+constexpr size_t n_channels = 4 * 2560;
+
+std::vector<TriggerPrimitive>
+make_tps(size_t n_tps)
+{
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> channel(0, n_channels - 1);
+  std::uniform_int_distribution<int> tot(1, 40);
+  std::uniform_int_distribution<int> adc(20, 4000);
+
+  std::vector<TriggerPrimitive> tps(n_tps);
+  timestamp_t time = 1'000'000;
+  for (TriggerPrimitive& tp : tps) {
+    time += rng() % 4;
+    tp.type = TriggerPrimitive::Type::kTPC;
+    tp.algorithm = TriggerPrimitive::Algorithm::kSimpleThreshold;
+    tp.time_start = time;
+    tp.time_over_threshold = tot(rng) * 32;
+    tp.time_peak = time + tp.time_over_threshold / 2;
+    tp.adc_integral = adc(rng);
+    tp.adc_peak = tp.adc_integral / 4;
+    tp.channel = channel(rng);
+    tp.detid = 0;
+  }
+  return tps;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  std::string algorithm = argc > 1 ? argv[1] : "TAMakerChannelDistanceAlgorithm";
+  size_t max_shards = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+  size_t n_tps = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4'000'000;
+  size_t block_size = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 4096;
+  max_shards = std::max<size_t>(max_shards, 1);
+
+  auto tps = make_tps(n_tps);
+  std::vector<TriggerActivity> output_ta;
+
+  std::printf("%s, %zu TPs in blocks of %zu\n", algorithm.c_str(), n_tps, block_size);
+  std::printf("%8s %14s %10s %10s\n", "shards", "TPs/s", "speedup", "TAs");
+  // Powers of two, and max_shards itself
+  std::vector<size_t> shard_counts;
+  for (size_t n_shards = 1; n_shards < max_shards; n_shards *= 2)
+    shard_counts.push_back(n_shards);
+  shard_counts.push_back(max_shards);
+
+  double single_rate = 0;
+  for (size_t n_shards : shard_counts) {
+    ShardedTARunner runner;
+    runner.configure({ { "algorithm", algorithm }, { "n_shards", n_shards }, { "n_channels", n_channels } });
+    output_ta.clear();
+    size_t n_tas = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < n_tps; first += block_size) {
+      size_t count = std::min(block_size, n_tps - first);
+      runner.push(span<const TriggerPrimitive>(tps.data() + first, count));
+      runner.drain(output_ta);
+      // Done with the TAs: back to the shards' pools, as a consumer would
+      n_tas += output_ta.size();
+      for (TriggerActivity& ta : output_ta)
+        runner.recycle(std::move(ta));
+      output_ta.clear();
+    }
+    runner.stop(output_ta);
+    n_tas += output_ta.size();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double rate = n_tps / elapsed.count();
+    if (n_shards == 1)
+      single_rate = rate;
+    std::printf("%8zu %14.3e %10.2f %10zu\n", n_shards, rate, rate / single_rate, n_tas);
+    std::fflush(stdout);
+  }
+
+  return 0;
+}
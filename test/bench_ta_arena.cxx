@@ -0,0 +1,149 @@
+/**
+ * @file bench_ta_arena.cxx
+ *
+ * Compares TAMakerChannelDistanceAlgorithm making TriggerActivity objects,
+ * whose windows and copies each hold their own TPs, with it making
+ * SlicedTriggerActivity objects, whose TPs are appended once into the
+ * maker's TPArena and shared by every copy. Each TA made is copied n_copies
+ * times, as when it is held by a TC window and an output queue. Reports the
+ * TP throughput of both and the TP bytes copied per TA.
+ *
+ * Usage: bench_ta_arena [n_tps] [n_copies] [n_repeats] [block_size]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/ChannelDistance/TAMakerChannelDistanceAlgorithm.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+using namespace triggeralgs;
+
+namespace {
+
+std::vector<TriggerPrimitive>
+make_tps(size_t n_tps)
+{
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> channel(0, 2559);
+  std::uniform_int_distribution<int> tot(1, 40);
+  std::uniform_int_distribution<int> adc(20, 4000);
+
+  std::vector<TriggerPrimitive> tps(n_tps);
+  timestamp_t time = 1'000'000;
+  for (TriggerPrimitive& tp : tps) {
+    time += 1 + rng() % 8;
+    tp.type = TriggerPrimitive::Type::kTPC;
+    tp.algorithm = TriggerPrimitive::Algorithm::kSimpleThreshold;
+    tp.time_start = time;
+    tp.time_over_threshold = tot(rng) * 32;
+    tp.time_peak = time + tp.time_over_threshold / 2;
+    tp.adc_integral = adc(rng);
+    tp.adc_peak = tp.adc_integral / 4;
+    tp.channel = channel(rng);
+    tp.detid = 0;
+  }
+  return tps;
+}
+
+struct Result
+{
+  double rate = 0;
+  size_t n_tas = 0;
+  uint64_t adc_sum = 0;
+  // TP bytes copied into the TA copies, over one repeat
+  double copy_bytes = 0;
+};
+
+const nlohmann::json s_config = { { "min_tps", 10 }, { "window_length", 8000 }, { "max_channel_distance", 50 } };
+
+// Best-of-n_repeats TPs/s, with a fresh maker per repeat.
+template<class Output>
+Result
+measure(const std::vector<TriggerPrimitive>& tps, size_t n_copies, size_t n_repeats, size_t block_size)
+{
+  constexpr bool kSliced = std::is_same_v<Output, SlicedTriggerActivity>;
+  Result result;
+  for (size_t rep = 0; rep < n_repeats; ++rep) {
+    TAMakerChannelDistanceAlgorithm maker;
+    maker.configure(s_config);
+    std::vector<Output> output_tas;
+    std::vector<Output> copies;
+    result.n_tas = 0;
+    result.adc_sum = 0;
+    result.copy_bytes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < tps.size(); first += block_size) {
+      span<const TriggerPrimitive> block(tps.data() + first, std::min(block_size, tps.size() - first));
+      if constexpr (kSliced)
+        maker.process_batch_sliced(block, output_tas);
+      else
+        maker.process_batch(block, output_tas);
+
+      for (Output& ta : output_tas) {
+        for (size_t copy = 0; copy < n_copies; ++copy)
+          copies.push_back(ta);
+        if constexpr (!kSliced)
+          result.copy_bytes += n_copies * ta.inputs.size() * sizeof(TriggerPrimitive);
+        ++result.n_tas;
+        result.adc_sum += ta.adc_integral;
+      }
+      copies.clear();
+      // The TP buffers of the TriggerActivity path go back to the maker's pool.
+      if constexpr (!kSliced) {
+        for (Output& ta : output_tas)
+          maker.recycle(std::move(ta));
+      }
+      output_tas.clear();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double rate = tps.size() / elapsed.count();
+    if (rate > result.rate)
+      result.rate = rate;
+  }
+  return result;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t n_tps = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2'000'000;
+  size_t n_copies = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+  size_t n_repeats = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5;
+  size_t block_size = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1024;
+
+  std::vector<TriggerPrimitive> tps = make_tps(n_tps);
+
+  Result vectors = measure<TriggerActivity>(tps, n_copies, n_repeats, block_size);
+  Result sliced = measure<SlicedTriggerActivity>(tps, n_copies, n_repeats, block_size);
+
+  std::printf("%-24s %12s %8s %14s\n", "TA type", "TP/s", "TAs", "KiB copied/TA");
+  std::printf("%-24s %12.3e %8zu %14.2f\n",
+              "TriggerActivity",
+              vectors.rate,
+              vectors.n_tas,
+              vectors.n_tas > 0 ? vectors.copy_bytes / vectors.n_tas / 1024 : 0);
+  std::printf("%-24s %12.3e %8zu %14.2f%s\n",
+              "SlicedTriggerActivity",
+              sliced.rate,
+              sliced.n_tas,
+              sliced.n_tas > 0 ? sliced.copy_bytes / sliced.n_tas / 1024 : 0,
+              sliced.n_tas == vectors.n_tas && sliced.adc_sum == vectors.adc_sum ? "" : "  MISMATCH");
+  std::printf("speedup: %.2fx\n", sliced.rate / vectors.rate);
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file bench_thread_placement.cxx
+ *
+ * Measures what running a TA maker on the NUMA node of its input, or on
+ * another one, costs. A buffer of TPs is allocated and written from NUMA
+ * node 0, standing for the readout buffers next to the NIC. A thread
+ * placed with ThreadPlacement on node 0 (local), then on the last node
+ * (remote), streams through the buffer, then runs a TA maker over it.
+ *
+ * Usage: bench_thread_placement [buffer_mb] [algorithm]
+ *
+ * On a host with a single NUMA node only the local run is made.
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/ThreadPlacement.hpp"
+#include "triggeralgs/TriggerActivityFactory.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace triggeralgs;
+
+namespace {
+
+constexpr size_t block_size = 1024;
+constexpr int n_stream_passes = 5;
+
+ThreadPlacement
+placement_on(int node, const std::string& name)
+{
+  ThreadPlacement placement;
+  placement.configure({ { "numa_node", node } }, name);
+  return placement;
+}
+
+// Run function on a thread placed on node, returning its time in seconds
+template<class Function>
+double
+run_on(int node, const std::string& name, Function&& function)
+{
+  double seconds = 0;
+  std::thread thread([&] {
+    placement_on(node, name).apply();
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    seconds = elapsed.count();
+  });
+  thread.join();
+  return seconds;
+}
+
+void
+fill(std::vector<TriggerPrimitive>& tps)
+{
+  std::mt19937 rng(1234);
+  timestamp_t time = 1'000'000;
+  for (TriggerPrimitive& tp : tps) {
+    time += rng() % 8;
+    tp.type = TriggerPrimitive::Type::kTPC;
+    tp.algorithm = TriggerPrimitive::Algorithm::kSimpleThreshold;
+    tp.time_start = time;
+    tp.time_over_threshold = 32 * (1 + rng() % 20);
+    tp.adc_integral = 20 + rng() % 2000;
+    tp.channel = rng() % 2560;
+  }
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t buffer_mb = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 128;
+  std::string algorithm = argc > 2 ? argv[2] : "TAMakerChannelDistanceAlgorithm";
+
+  int n_nodes = ThreadPlacement::n_numa_nodes();
+  size_t n_tps = buffer_mb * 1024 * 1024 / sizeof(TriggerPrimitive);
+  std::printf("%d NUMA node(s), %zu MB buffer of %zu TPs on node 0\n", n_nodes, buffer_mb, n_tps);
+  std::vector<int> nodes = { 0 };
+  if (n_nodes > 1) {
+    nodes.push_back(n_nodes - 1);
+  } else {
+    std::printf("A single NUMA node: no remote run\n");
+  }
+
+  // Allocated and first touched from node 0, so its pages live there
+  std::vector<TriggerPrimitive> tps;
+  run_on(0, "bench-readout", [&] {
+    tps.resize(n_tps);
+    fill(tps);
+  });
+
+  for (int node : nodes) {
+    const char* where = node == 0 ? "local" : "remote";
+
+    uint64_t sum = 0;
+    double seconds = run_on(node, "bench-stream", [&] {
+      for (int pass = 0; pass < n_stream_passes; ++pass) {
+        for (const TriggerPrimitive& tp : tps) {
+          sum += tp.adc_integral;
+        }
+      }
+    });
+    double gbytes = static_cast<double>(n_stream_passes) * n_tps * sizeof(TriggerPrimitive) / 1e9;
+    std::printf("%-6s (node %d) stream %10.2f GB/s  (checksum %lu)\n",
+                where,
+                node,
+                gbytes / seconds,
+                static_cast<unsigned long>(sum));
+
+    size_t n_tas = 0;
+    seconds = run_on(node, "bench-ta", [&] {
+      auto maker = TriggerActivityFactory::get_instance()->build_maker(algorithm);
+      maker->configure(nlohmann::json::object());
+      std::vector<TriggerActivity> output_ta;
+      for (size_t first = 0; first < tps.size(); first += block_size) {
+        size_t n = std::min(block_size, tps.size() - first);
+        maker->process_batch(span<const TriggerPrimitive>(tps.data() + first, n), output_ta);
+        n_tas += output_ta.size();
+        for (TriggerActivity& ta : output_ta)
+          maker->recycle(std::move(ta));
+        output_ta.clear();
+      }
+    });
+    std::printf("%-6s (node %d) %-16s %10.3e TPs/s  (%zu TAs)\n", where, node, "maker", n_tps / seconds, n_tas);
+  }
+
+  return 0;
+}
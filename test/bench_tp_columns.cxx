@@ -0,0 +1,125 @@
+/**
+ * @file bench_tp_columns.cxx
+ *
+ * Reduces windows of TPs into TA attributes, as the TA makers do, from the
+ * TPs themselves and from their TPColumns, and copies out the channels of
+ * the window as the horizontal muon adjacency check does. Also slides a
+ * window with and without window_stats::Columns, to show what keeping the
+ * columns costs per TP.
+ *
+ * Usage: bench_tp_columns [n_repeats]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/SlidingWindow.hpp"
+#include "triggeralgs/TPColumns.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace triggeralgs;
+
+namespace {
+
+std::vector<TriggerPrimitive>
+make_tps(size_t n_tps)
+{
+  std::mt19937 rng(1234);
+  std::vector<TriggerPrimitive> tps(n_tps);
+  timestamp_t time = 1'000'000;
+  for (TriggerPrimitive& tp : tps) {
+    time += rng() % 8;
+    tp.time_start = time;
+    tp.time_over_threshold = 32 + rng() % 64;
+    tp.time_peak = time + 16;
+    tp.adc_integral = 20 + rng() % 2000;
+    tp.adc_peak = 10 + rng() % 200;
+    tp.channel = rng() % 2560;
+  }
+  return tps;
+}
+
+template<class Function>
+double
+ns_per_tp(size_t n_repeats, size_t n_tps, uint64_t& checksum, Function&& function)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (size_t repeat = 0; repeat < n_repeats; ++repeat)
+    checksum += function();
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (n_repeats * n_tps);
+}
+
+uint64_t
+fold(const TPReduction& reduction)
+{
+  return reduction.time_start_min + reduction.time_end_max + reduction.channel_max + reduction.adc_integral +
+         reduction.peak_index;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t n_repeats = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+  std::printf("%8s %16s %16s %16s %16s\n", "TPs", "reduce TPs", "reduce columns", "channels of TPs",
+              "channel column");
+  for (size_t n_tps : { 16, 64, 256, 1024, 4096 }) {
+    std::vector<TriggerPrimitive> tps = make_tps(n_tps);
+    TPColumns columns;
+    for (const TriggerPrimitive& tp : tps)
+      columns.push_back(tp);
+
+    uint64_t checksum = 0;
+    size_t repeats = n_repeats * 64 / n_tps + 1;
+    double tps_ns = ns_per_tp(repeats, n_tps, checksum, [&] { return fold(reduce(tps)); });
+    double columns_ns = ns_per_tp(repeats, n_tps, checksum, [&] { return fold(reduce(columns)); });
+    double tp_channels_ns = ns_per_tp(repeats, n_tps, checksum, [&] {
+      std::vector<int> channels;
+      for (const TriggerPrimitive& tp : tps)
+        channels.push_back(tp.channel);
+      return channels.back();
+    });
+    double column_channels_ns = ns_per_tp(repeats, n_tps, checksum, [&] {
+      std::vector<int> channels(columns.channel().begin(), columns.channel().end());
+      return channels.back();
+    });
+    std::printf("%8zu %13.2f ns %13.2f ns %13.2f ns %13.2f ns  (checksum %lu)\n",
+                n_tps,
+                tps_ns,
+                columns_ns,
+                tp_channels_ns,
+                column_channels_ns,
+                static_cast<unsigned long>(checksum));
+  }
+
+  // Sliding cost per TP, with a window of about 500 TPs
+  std::vector<TriggerPrimitive> tps = make_tps(2'000'000);
+  auto slide = [&](auto& window) {
+    uint64_t checksum = 0;
+    window.reset(tps.front());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t idx = 1; idx < tps.size(); ++idx) {
+      window.move(tps[idx], 2000);
+      checksum += window.adc_integral;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%.2f ns/TP (checksum %lu)\n", elapsed.count() / (tps.size() - 1), static_cast<unsigned long>(checksum));
+  };
+  SlidingWindow<TriggerPrimitive, window_stats::ADCSum> plain_window;
+  std::printf("%-28s ", "slide, no columns:");
+  slide(plain_window);
+  SlidingWindow<TriggerPrimitive, window_stats::ADCSum, window_stats::Columns> columns_window;
+  std::printf("%-28s ", "slide, with columns:");
+  slide(columns_window);
+
+  return 0;
+}
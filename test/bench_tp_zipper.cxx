@@ -0,0 +1,96 @@
+/**
+ * @file bench_tp_zipper.cxx
+ *
+ * Measures the TP rate TPZipper merges on one core, for a range of link
+ * counts. Each link's TPs are handed over in blocks, as they would arrive
+ * in TP fragments, and the output is drained after each block.
+ *
+ * Usage: bench_tp_zipper [n_tps] [block_size] [n_repeats]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/TPZipper.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace triggeralgs;
+
+namespace {
+
+// Per link, time ordered TPs at about the same mean rate on every link.
+std::vector<std::vector<TriggerPrimitive>>
+make_links(size_t n_links, size_t n_tps)
+{
+  std::mt19937 rng(1234);
+  std::vector<std::vector<TriggerPrimitive>> links(n_links);
+  for (size_t link = 0; link < n_links; ++link) {
+    timestamp_t time = 1'000'000;
+    links[link].resize(n_tps / n_links);
+    for (TriggerPrimitive& tp : links[link]) {
+      time += rng() % (2 * n_links);
+      tp.time_start = time;
+      tp.channel = link;
+    }
+  }
+  return links;
+}
+
+double
+measure(size_t n_links, size_t n_tps, size_t block_size, size_t n_repeats, uint64_t& n_out)
+{
+  auto links = make_links(n_links, n_tps);
+  size_t n_per_link = links[0].size();
+  double best = 0;
+  std::vector<TriggerPrimitive> output_tps;
+  output_tps.reserve(n_tps);
+
+  for (size_t rep = 0; rep < n_repeats; ++rep) {
+    TPZipper zipper(n_links);
+    zipper.configure({ { "max_lateness", 1'000'000 } });
+    output_tps.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < n_per_link; first += block_size) {
+      size_t count = std::min(block_size, n_per_link - first);
+      for (size_t link = 0; link < n_links; ++link) {
+        zipper.add(link, span<const TriggerPrimitive>(links[link].data() + first, count));
+      }
+      zipper.drain(output_tps);
+    }
+    zipper.flush(output_tps);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    n_out = output_tps.size();
+    double rate = n_out / elapsed.count();
+    if (rate > best)
+      best = rate;
+  }
+  return best;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t n_tps = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4'000'000;
+  size_t block_size = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+  size_t n_repeats = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5;
+
+  std::printf("%8s %14s %12s\n", "links", "TPs/s", "TPs out");
+  for (size_t n_links : { 1, 2, 4, 8, 16, 32, 64 }) {
+    uint64_t n_out = 0;
+    double rate = measure(n_links, n_tps, block_size, n_repeats, n_out);
+    std::printf("%8zu %14.3e %12lu\n", n_links, rate, static_cast<unsigned long>(n_out));
+    std::fflush(stdout);
+  }
+
+  return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file bench_window_occupancy.cxx
+ *
+ * Slides a TPWindow over a stream of TPs, and a TAWindow over a stream of
+ * TAs, keeping the channel hit counts in the ChannelOccupancy of the
+ * windows, sized from the channel range or grown as channels are seen, and
+ * in an unordered_map as the windows did before. Reports the time per
+ * object and the heap allocations per object once the windows have warmed
+ * up, which the ChannelOccupancy keeps at zero.
+ *
+ * Usage: bench_window_occupancy [n_tps] [n_channels] [window_length]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "triggeralgs/TAWindow.hpp"
+#include "triggeralgs/TPWindow.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> n_allocations = 0;
+
+} // namespace
+
+// The scalar and array forms, plain and sized, are all replaced together so
+// that every allocation is counted and every deallocation matches it.
+
+void*
+operator new(size_t size)
+{
+  n_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* pointer = std::malloc(size ? size : 1))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void*
+operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void
+operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void
+operator delete[](void* pointer) noexcept
+{
+  operator delete(pointer);
+}
+
+void
+operator delete(void* pointer, size_t) noexcept
+{
+  operator delete(pointer);
+}
+
+void
+operator delete[](void* pointer, size_t) noexcept
+{
+  operator delete(pointer);
+}
+
+using namespace triggeralgs;
+
+namespace {
+
+constexpr size_t n_tps_per_ta = 16;
+
+// TPWindow with the hit counts in an unordered_map, as it was
+struct HashedTPWindow
+{
+  void move(const TriggerPrimitive& input_tp, timestamp_t window_length)
+  {
+    size_t n_tps_to_erase = 0;
+    for (const TriggerPrimitive& tp : inputs) {
+      if (input_tp.time_start - tp.time_start < window_length)
+        break;
+      n_tps_to_erase++;
+      adc_integral -= tp.adc_integral;
+      auto channel_state = channel_states.find(tp.channel);
+      if (--channel_state->second == 0)
+        channel_states.erase(channel_state);
+    }
+    inputs.pop_front(n_tps_to_erase);
+    adc_integral += input_tp.adc_integral;
+    channel_states[input_tp.channel]++;
+    inputs.push_back(input_tp);
+  }
+
+  uint16_t n_channels_hit() const { return channel_states.size(); }
+
+  uint32_t adc_integral = 0;
+  std::unordered_map<channel_t, uint16_t> channel_states;
+  WindowBuffer<TriggerPrimitive> inputs;
+};
+
+std::vector<TriggerPrimitive>
+make_tps(size_t n_tps, uint32_t n_channels)
+{
+  std::mt19937 rng(1234);
+  std::vector<TriggerPrimitive> tps(n_tps);
+  timestamp_t time = 1'000'000;
+  for (TriggerPrimitive& tp : tps) {
+    time += rng() % 8;
+    tp.time_start = time;
+    tp.time_over_threshold = 64;
+    tp.adc_integral = 20 + rng() % 2000;
+    tp.channel = rng() % n_channels;
+  }
+  return tps;
+}
+
+// TAs of n_tps_per_ta consecutive TPs
+std::vector<TriggerActivity>
+make_tas(const std::vector<TriggerPrimitive>& tps)
+{
+  std::vector<TriggerActivity> tas(tps.size() / n_tps_per_ta);
+  for (size_t idx = 0; idx < tas.size(); ++idx) {
+    TriggerActivity& ta = tas[idx];
+    ta.inputs.assign(tps.begin() + idx * n_tps_per_ta, tps.begin() + (idx + 1) * n_tps_per_ta);
+    ta.time_start = ta.inputs.front().time_start;
+    for (const TriggerPrimitive& tp : ta.inputs)
+      ta.adc_integral += tp.adc_integral;
+  }
+  return tas;
+}
+
+struct Result
+{
+  double ns_per_object = 0;
+  double allocations_per_object = 0;
+  uint64_t checksum = 0;
+};
+
+// Slides the window over the first half of the objects, then times the second half
+template<class Function>
+Result
+measure(size_t n_objects, Function&& slide)
+{
+  Result result;
+  size_t half = n_objects / 2;
+  for (size_t idx = 0; idx < half; ++idx)
+    result.checksum += slide(idx);
+
+  uint64_t allocations_before = n_allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t idx = half; idx < n_objects; ++idx)
+    result.checksum += slide(idx);
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  uint64_t allocations = n_allocations.load() - allocations_before;
+
+  result.ns_per_object = elapsed.count() / (n_objects - half);
+  result.allocations_per_object = static_cast<double>(allocations) / (n_objects - half);
+  return result;
+}
+
+void
+print(const char* name, const Result& result)
+{
+  std::printf("%-28s %8.1f ns/object %10.4f allocations/object  (checksum %lu)\n",
+              name,
+              result.ns_per_object,
+              result.allocations_per_object,
+              static_cast<unsigned long>(result.checksum));
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  size_t n_tps = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2'000'000;
+  uint32_t n_channels = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2560;
+  timestamp_t window_length = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2000;
+
+  std::vector<TriggerPrimitive> tps = make_tps(n_tps, n_channels);
+  std::printf("%zu TPs over %u channels, window of %lu ticks\n",
+              n_tps,
+              n_channels,
+              static_cast<unsigned long>(window_length));
+
+  {
+    HashedTPWindow window;
+    window.move(tps.front(), window_length);
+    print("TPWindow, unordered_map", measure(tps.size() - 1, [&](size_t idx) {
+            window.move(tps[idx + 1], window_length);
+            return window.n_channels_hit();
+          }));
+  }
+  for (bool sized : { false, true }) {
+    TPWindow window;
+    if (sized)
+      window.set_channel_range(0, n_channels);
+    window.reset(tps.front());
+    print(sized ? "TPWindow, sized occupancy" : "TPWindow, grown occupancy", measure(tps.size() - 1, [&](size_t idx) {
+            window.move(tps[idx + 1], window_length);
+            return window.n_channels_hit();
+          }));
+  }
+
+  // The TAs are built up front and moved into the window, so that only
+  // the window itself allocates in the timed loop.
+  for (bool sized : { false, true }) {
+    std::vector<TriggerActivity> tas = make_tas(tps);
+    TAWindow window;
+    if (sized)
+      window.set_channel_range(0, n_channels);
+    window.reset(std::move(tas.front()));
+    print(sized ? "TAWindow, sized occupancy" : "TAWindow, grown occupancy", measure(tas.size() - 1, [&](size_t idx) {
+            window.move(std::move(tas[idx + 1]), window_length);
+            return window.n_channels_hit();
+          }));
+  }
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file test_dbscan_reorder.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_dbscan_reorder
+
+#include "triggeralgs/dbscan/TAMakerDBSCANAlgorithm.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+// Tracks of adjacent hits, 5000 ticks apart, in time order
+std::vector<TriggerPrimitive>
+make_tracks(size_t n_tracks)
+{
+  std::vector<TriggerPrimitive> tps;
+  for (size_t track = 0; track < n_tracks; ++track) {
+    for (channel_t idx = 0; idx < 10; ++idx) {
+      TriggerPrimitive tp;
+      tp.time_start = 10000 + 5000 * track + 20 * idx;
+      tp.channel = 100 + idx;
+      tp.adc_integral = 100;
+      tps.push_back(tp);
+    }
+  }
+  return tps;
+}
+
+std::vector<TriggerActivity>
+run(const nlohmann::json& config, const std::vector<TriggerPrimitive>& tps, TAMakerDBSCANAlgorithm& maker)
+{
+  maker.configure(config);
+  // The maker is given an empty vector each call, as the postprocessing expects
+  std::vector<TriggerActivity> output_ta, made;
+  for (const TriggerPrimitive& tp : tps) {
+    maker(tp, made);
+    std::move(made.begin(), made.end(), std::back_inserter(output_ta));
+    made.clear();
+  }
+  maker.flush(tps.back().time_start + 100000, made);
+  std::move(made.begin(), made.end(), std::back_inserter(output_ta));
+  return output_ta;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(reordered_input_gives_same_clusters)
+{
+  std::vector<TriggerPrimitive> ordered = make_tracks(20);
+
+  // Swap neighbouring TPs: each is at most 20 ticks out of order
+  std::vector<TriggerPrimitive> shuffled = ordered;
+  for (size_t idx = 0; idx + 1 < shuffled.size(); idx += 2)
+    std::swap(shuffled[idx], shuffled[idx + 1]);
+
+  TAMakerDBSCANAlgorithm reference, reordering, plain;
+  auto reference_tas = run({ { "eps", 10 }, { "min_pts", 3 } }, ordered, reference);
+  auto reordered_tas = run({ { "eps", 10 }, { "min_pts", 3 }, { "reorder_window", 100 } }, shuffled, reordering);
+
+  BOOST_REQUIRE(reference_tas.size() == 20u);
+  BOOST_REQUIRE(reordered_tas.size() == reference_tas.size());
+  for (size_t idx = 0; idx < reference_tas.size(); ++idx) {
+    BOOST_TEST(reordered_tas[idx].inputs.size() == reference_tas[idx].inputs.size());
+    BOOST_TEST(reordered_tas[idx].time_start == reference_tas[idx].time_start);
+  }
+  BOOST_TEST(reordering.reorder_stats().n_reordered == 100u);
+  BOOST_TEST(reordering.reorder_stats().n_dropped == 0u);
+  BOOST_TEST(reordering.reorder_stats().max_depth <= 7u);
+
+  // Without the reorder stage the out of order TPs are lost
+  run({ { "eps", 10 }, { "min_pts", 3 } }, shuffled, plain);
+  BOOST_TEST(plain.reorder_stats().n_dropped == 100u);
+}
+
+BOOST_AUTO_TEST_CASE(flush_from_time_zero)
+{
+  // One cluster of TPs all at time 0, only complete once flushed
+  std::vector<TriggerPrimitive> tps;
+  for (channel_t channel = 100; channel < 110; ++channel) {
+    TriggerPrimitive tp;
+    tp.time_start = 0;
+    tp.channel = channel;
+    tp.adc_integral = 100;
+    tps.push_back(tp);
+  }
+
+  TAMakerDBSCANAlgorithm maker;
+  auto output_ta = run({ { "eps", 10 }, { "min_pts", 3 }, { "reorder_window", 100 } }, tps, maker);
+  BOOST_REQUIRE(output_ta.size() == 1u);
+  BOOST_TEST(output_ta[0].inputs.size() == 10u);
+  BOOST_TEST(output_ta[0].time_start == 0u);
+
+  // The TAs made by flush() are postprocessed too
+  TAMakerDBSCANAlgorithm filtered;
+  output_ta = run({ { "eps", 10 }, { "min_pts", 3 }, { "reorder_window", 100 }, { "output_min_inputs", 11 } }, tps, filtered);
+  BOOST_TEST(output_ta.empty());
+}
+
+BOOST_AUTO_TEST_CASE(too_late_and_depth_limit)
+{
+  TAMakerDBSCANAlgorithm maker;
+  maker.configure({ { "reorder_window", 100 }, { "max_reorder_depth", 4 } });
+
+  std::vector<TriggerActivity> output_ta;
+  TriggerPrimitive tp;
+  for (timestamp_t time : { 1000, 1010, 1020, 1030, 1040, 1050 }) {
+    tp.time_start = time;
+    maker(tp, output_ta);
+  }
+  // The buffer only holds 4 TPs: the 2 earliest were clustered early
+  BOOST_TEST(maker.reorder_stats().n_forced == 2u);
+  BOOST_TEST(maker.reorder_stats().max_depth == 5u);
+
+  // Earlier than a clustered TP: dropped
+  tp.time_start = 1005;
+  maker(tp, output_ta);
+  BOOST_TEST(maker.reorder_stats().n_dropped == 1u);
+
+  // Within the window: put back in order
+  tp.time_start = 1025;
+  maker(tp, output_ta);
+  BOOST_TEST(maker.reorder_stats().n_reordered == 1u);
+  BOOST_TEST(maker.reorder_stats().n_dropped == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(tas_come_from_the_pool)
+{
+  TAMakerDBSCANAlgorithm maker;
+  TriggerActivity spare;
+  spare.inputs.reserve(64);
+  maker.recycle(std::move(spare));
+
+  auto tas = run({ { "eps", 10 }, { "min_pts", 3 } }, make_tracks(2), maker);
+  BOOST_REQUIRE(tas.size() == 2u);
+  BOOST_TEST(maker.m_ta_pool.n_hits() == 1u);
+  BOOST_TEST(maker.m_ta_pool.n_misses() == 1u);
+  BOOST_TEST(tas[0].inputs.capacity() >= 64u);
+}
+
+} // namespace triggeralgs
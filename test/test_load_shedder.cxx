@@ -0,0 +1,187 @@
+/**
+ * @file test_load_shedder.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_load_shedder
+
+#include "triggeralgs/LoadShedder.hpp"
+#include "triggeralgs/TriggerActivityFactory.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+using std::chrono::microseconds;
+
+// TPs every step ticks over [first, last)
+std::vector<TriggerPrimitive>
+make_tps(timestamp_t first, timestamp_t last, timestamp_t step = 10)
+{
+  std::vector<TriggerPrimitive> tps;
+  for (timestamp_t time = first; time < last; time += step) {
+    TriggerPrimitive tp;
+    tp.time_start = time;
+    tp.time_over_threshold = 100;
+    tp.adc_integral = 1000;
+    tps.push_back(tp);
+  }
+  return tps;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(no_policy_sheds_nothing)
+{
+  auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerPrescaleAlgorithm");
+  LoadShedder shedder;
+  shedder.configure({ { "max_queue_depth", 1 } });
+  BOOST_TEST(!shedder.enabled());
+
+  std::vector<TriggerPrimitive> tps = make_tps(0, 100);
+  BOOST_TEST(shedder.admit(tps.size(), 10));
+  shedder.update(10, microseconds(1000000), *maker);
+  shedder.shed(tps);
+  BOOST_TEST(tps.size() == 10u);
+  BOOST_TEST(!maker->is_degraded());
+}
+
+BOOST_AUTO_TEST_CASE(drop_newest_on_depth_and_latency)
+{
+  auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerPrescaleAlgorithm");
+  LoadShedder shedder;
+  shedder.configure({ { "policies", { "drop_newest" } }, { "max_queue_depth", 4 }, { "max_latency_us", 1000 } });
+  BOOST_TEST(shedder.enabled());
+
+  BOOST_TEST(shedder.admit(10, 3));
+  BOOST_TEST(!shedder.admit(10, 4));
+
+  // A slow batch overloads the input until the latency is back to half
+  shedder.update(0, microseconds(1000), *maker);
+  BOOST_TEST(shedder.overloaded());
+  BOOST_TEST(!shedder.admit(20, 0));
+  shedder.update(0, microseconds(600), *maker);
+  BOOST_TEST(shedder.overloaded());
+  shedder.update(0, microseconds(500), *maker);
+  BOOST_TEST(!shedder.overloaded());
+  BOOST_TEST(shedder.admit(10, 0));
+
+  auto stats = shedder.stats();
+  BOOST_TEST(stats.n_overloads == 1u);
+  BOOST_TEST(stats.n_batches_dropped == 2u);
+  BOOST_TEST(stats.n_tps_dropped == 30u);
+  BOOST_TEST(stats.n_tps_below_floor == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(adc_floor_only_while_overloaded)
+{
+  auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerPrescaleAlgorithm");
+  LoadShedder shedder;
+  shedder.configure({ { "policies", { "adc_floor" } },
+                      { "max_queue_depth", 2 },
+                      { "min_adc_integral", 500 },
+                      { "min_time_over_threshold", 50 } });
+
+  std::vector<TriggerPrimitive> tps = make_tps(0, 100);
+  tps[1].adc_integral = 100;
+  tps[2].time_over_threshold = 10;
+  tps[3].adc_integral = 499;
+
+  std::vector<TriggerPrimitive> quiet = tps;
+  shedder.update(1, microseconds(0), *maker);
+  shedder.shed(quiet);
+  BOOST_TEST(quiet.size() == 10u);
+
+  shedder.update(2, microseconds(0), *maker);
+  shedder.shed(tps);
+  BOOST_REQUIRE(tps.size() == 7u);
+  BOOST_TEST(tps[0].time_start == 0u);
+  BOOST_TEST(tps[1].time_start == 40u);
+  BOOST_TEST(shedder.admit(10, 5));
+  BOOST_TEST(shedder.stats().n_tps_below_floor == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(shed_slices_drops_whole_slices)
+{
+  auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerPrescaleAlgorithm");
+  LoadShedder shedder;
+  shedder.configure({ { "policies", { "shed_slices" } }, { "max_queue_depth", 2 }, { "slice_length", 100 } });
+
+  // First half of slice 0
+  std::vector<TriggerPrimitive> tps = make_tps(0, 50);
+  shedder.update(0, microseconds(0), *maker);
+  shedder.shed(tps);
+  BOOST_TEST(tps.size() == 5u);
+
+  // Overloaded from the middle of slice 0: only slice 1 is shed
+  tps = make_tps(50, 150);
+  shedder.update(2, microseconds(0), *maker);
+  shedder.shed(tps);
+  BOOST_REQUIRE(tps.size() == 5u);
+  BOOST_TEST(tps.back().time_start == 90u);
+
+  // Back to normal in the middle of slice 1: it is shed to its end
+  tps = make_tps(150, 250);
+  shedder.update(0, microseconds(0), *maker);
+  BOOST_TEST(!shedder.overloaded());
+  shedder.shed(tps);
+  BOOST_REQUIRE(tps.size() == 5u);
+  BOOST_TEST(tps.front().time_start == 200u);
+
+  auto stats = shedder.stats();
+  BOOST_TEST(stats.n_slices_shed == 1u);
+  BOOST_TEST(stats.n_tps_in_shed_slices == 10u);
+}
+
+BOOST_AUTO_TEST_CASE(degraded_horizontal_muon_skips_adjacency)
+{
+  const nlohmann::json hm_config = { { "window_length", 1000 },
+                                     { "trigger_on_adjacency", true },
+                                     { "adjacency_threshold", 10 } };
+
+  // A track over 30 adjacent channels, then a TP closing its window
+  std::vector<TriggerPrimitive> track;
+  for (channel_t channel = 0; channel < 30; ++channel) {
+    TriggerPrimitive tp;
+    tp.time_start = 10000 + 10 * channel;
+    tp.channel = 100 + channel;
+    tp.adc_integral = 1000;
+    track.push_back(tp);
+  }
+  TriggerPrimitive closing;
+  closing.time_start = 20000;
+  closing.channel = 1000;
+  track.push_back(closing);
+
+  LoadShedder shedder;
+  shedder.configure({ { "policies", { "degrade" } }, { "max_queue_depth", 2 } });
+  for (bool overloaded : { false, true }) {
+    auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerHorizontalMuonAlgorithm");
+    maker->configure(hm_config);
+    shedder.update(overloaded ? 2 : 0, microseconds(0), *maker);
+    BOOST_TEST(maker->is_degraded() == overloaded);
+
+    std::vector<TriggerActivity> output_ta;
+    maker->process_batch(track, output_ta);
+    BOOST_TEST(output_ta.size() == (overloaded ? 0u : 1u));
+  }
+  BOOST_TEST(shedder.stats().n_degraded_batches == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(bad_configuration)
+{
+  LoadShedder shedder;
+  BOOST_CHECK_THROW(shedder.configure({ { "policies", { "drop_oldest" } } }), BadConfiguration);
+  BOOST_CHECK_THROW(shedder.configure({ { "policies", { "shed_slices" } }, { "slice_length", 0 } }), BadConfiguration);
+}
+
+} // namespace triggeralgs
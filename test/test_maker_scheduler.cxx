@@ -0,0 +1,179 @@
+/**
+ * @file test_maker_scheduler.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_maker_scheduler
+
+#include "triggeralgs/MakerScheduler.hpp"
+#include "triggeralgs/TriggerActivityFactory.hpp"
+#include "triggeralgs/TriggerCandidateFactory.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+const nlohmann::json maker_config = { { "window_length", 1000 }, { "min_tps", 3 }, { "max_channel_distance", 5 } };
+
+// Time ordered blocks of TPs for one maker
+std::vector<std::vector<TriggerPrimitive>>
+make_blocks(unsigned seed, size_t n_blocks, size_t block_size)
+{
+  std::mt19937 rng(seed);
+  std::vector<std::vector<TriggerPrimitive>> blocks(n_blocks);
+  timestamp_t time = 100000;
+  for (auto& block : blocks) {
+    block.resize(block_size);
+    for (TriggerPrimitive& tp : block) {
+      time += 1 + rng() % 10;
+      tp.time_start = time;
+      tp.channel = rng() % 64;
+      tp.adc_integral = 100;
+    }
+  }
+  return blocks;
+}
+
+std::vector<TriggerActivity>
+run_serially(const std::vector<std::vector<TriggerPrimitive>>& blocks)
+{
+  auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerChannelDistanceAlgorithm");
+  maker->configure(maker_config);
+  std::vector<TriggerActivity> output_ta;
+  auto sink = make_callback_sink<TriggerActivity>([&](TriggerActivity&& ta) { output_ta.push_back(std::move(ta)); });
+  for (const auto& block : blocks)
+    maker->process_batch_to(block, sink);
+  std::vector<TriggerActivity> flushed;
+  maker->flush(std::numeric_limits<timestamp_t>::max(), flushed);
+  maker->emit_output(flushed, sink);
+  return output_ta;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(uneven_makers_give_serial_results)
+{
+  constexpr size_t n_makers = 16;
+
+  MakerScheduler scheduler;
+  scheduler.configure({ { "n_workers", 4 }, { "mailbox_size", 8 }, { "batch_budget", 2 } });
+
+  std::vector<std::unique_ptr<TriggerActivityMaker>> makers;
+  std::vector<std::vector<TriggerActivity>> outputs(n_makers);
+  std::vector<CallbackSink<TriggerActivity, std::function<void(TriggerActivity&&)>>> sinks;
+  sinks.reserve(n_makers);
+  std::vector<std::vector<std::vector<TriggerPrimitive>>> inputs;
+  for (size_t idx = 0; idx < n_makers; ++idx) {
+    makers.push_back(TriggerActivityFactory::get_instance()->build_maker("TAMakerChannelDistanceAlgorithm"));
+    makers.back()->configure(maker_config);
+    auto& output = outputs[idx];
+    sinks.emplace_back([&output](TriggerActivity&& ta) { output.push_back(std::move(ta)); });
+    BOOST_TEST(scheduler.add_maker(*makers.back(), sinks.back()) == idx);
+    // The first two makers get ten times the blocks of the others
+    inputs.push_back(make_blocks(idx, idx < 2 ? 200 : 20, 100));
+  }
+  scheduler.start();
+
+  size_t n_batches = 0;
+  for (size_t block = 0; block < 200; ++block) {
+    for (size_t idx = 0; idx < n_makers; ++idx) {
+      if (block >= inputs[idx].size())
+        continue;
+      std::vector<TriggerPrimitive> tps = inputs[idx][block];
+      while (!scheduler.submit(idx, std::move(tps)))
+        std::this_thread::yield();
+      ++n_batches;
+    }
+  }
+  for (size_t idx = 0; idx < n_makers; ++idx) {
+    while (!scheduler.submit_flush(idx, std::numeric_limits<timestamp_t>::max()))
+      std::this_thread::yield();
+    ++n_batches;
+  }
+  scheduler.wait();
+
+  for (size_t idx = 0; idx < n_makers; ++idx) {
+    std::vector<TriggerActivity> reference = run_serially(inputs[idx]);
+    BOOST_TEST(!reference.empty());
+    BOOST_REQUIRE(outputs[idx].size() == reference.size());
+    for (size_t ta_idx = 0; ta_idx < reference.size(); ++ta_idx) {
+      BOOST_TEST(outputs[idx][ta_idx].time_start == reference[ta_idx].time_start);
+      BOOST_TEST(outputs[idx][ta_idx].inputs.size() == reference[ta_idx].inputs.size());
+    }
+  }
+
+  auto stats = scheduler.stats();
+  BOOST_TEST(stats.n_batches == n_batches);
+  BOOST_TEST(stats.n_runs >= n_batches / 2);
+}
+
+BOOST_AUTO_TEST_CASE(tc_makers_and_misuse)
+{
+  MakerScheduler scheduler;
+  scheduler.configure({ { "n_workers", 2 } });
+
+  auto tc_maker = TriggerCandidateFactory::get_instance()->build_maker("TCMakerPrescaleAlgorithm");
+  auto ta_source = TriggerActivityFactory::get_instance()->build_maker("TAMakerPrescaleAlgorithm");
+  std::vector<TriggerCandidate> output_tc;
+  auto sink = make_callback_sink<TriggerCandidate>([&](TriggerCandidate&& tc) { output_tc.push_back(std::move(tc)); });
+  auto handle = scheduler.add_maker(*tc_maker, sink, ta_source.get());
+  scheduler.start();
+
+  for (timestamp_t time = 1000; time < 1100; time += 10) {
+    std::vector<TriggerActivity> tas(1);
+    tas[0].time_start = time;
+    tas[0].inputs.resize(4);
+    BOOST_TEST(scheduler.submit(handle, std::move(tas)));
+  }
+  scheduler.wait();
+  BOOST_REQUIRE(output_tc.size() == 10u);
+  BOOST_TEST(output_tc.back().time_start == 1090u);
+
+  // The TAs went back to the maker they came from
+  for (int idx = 0; idx < 10; ++idx)
+    ta_source->m_ta_pool.acquire();
+  BOOST_TEST(ta_source->m_ta_pool.n_hits() == 10u);
+
+  // TPs for a TC maker, or an unknown maker
+  BOOST_CHECK_THROW(scheduler.submit(handle, std::vector<TriggerPrimitive>(1)), BadConfiguration);
+  BOOST_CHECK_THROW(scheduler.submit(handle + 1, std::vector<TriggerActivity>(1)), BadConfiguration);
+  // A maker added once the workers run, or a second start
+  BOOST_CHECK_THROW(scheduler.add_maker(*tc_maker, sink), BadConfiguration);
+  BOOST_CHECK_THROW(scheduler.start(), BadConfiguration);
+  BOOST_TEST(scheduler.n_makers() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(configure_resets_the_defaults)
+{
+  MakerScheduler scheduler;
+  auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerPrescaleAlgorithm");
+  std::vector<TriggerActivity> output_ta;
+  auto sink = make_callback_sink<TriggerActivity>([&](TriggerActivity&& ta) { output_ta.push_back(std::move(ta)); });
+
+  // Not started: the batches stay in the mailbox
+  scheduler.configure({ { "n_workers", 1 }, { "mailbox_size", 1 } });
+  auto handle = scheduler.add_maker(*maker, sink);
+  BOOST_TEST(scheduler.submit(handle, std::vector<TriggerPrimitive>(1)));
+  BOOST_TEST(!scheduler.submit(handle, std::vector<TriggerPrimitive>(1)));
+
+  // Back to the default mailbox size without the key
+  scheduler.configure({ { "n_workers", 1 } });
+  handle = scheduler.add_maker(*maker, sink);
+  for (int idx = 0; idx < 64; ++idx)
+    BOOST_TEST(scheduler.submit(handle, std::vector<TriggerPrimitive>(1)));
+  BOOST_TEST(!scheduler.submit(handle, std::vector<TriggerPrimitive>(1)));
+}
+
+} // namespace triggeralgs
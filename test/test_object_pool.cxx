@@ -0,0 +1,91 @@
+/**
+ * @file test_object_pool.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_object_pool
+
+#include "triggeralgs/ObjectPool.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace triggeralgs {
+
+BOOST_AUTO_TEST_CASE(recycled_ta_is_reset_and_keeps_capacity)
+{
+  ObjectPool<TriggerActivity> pool;
+
+  TriggerActivity ta = pool.acquire();
+  BOOST_CHECK_EQUAL(pool.n_misses(), 1);
+  ta.time_start = 100;
+  ta.adc_integral = 5000;
+  ta.inputs.resize(50);
+  pool.release(std::move(ta));
+  BOOST_CHECK_EQUAL(pool.n_free(), 1);
+
+  TriggerActivity reused = pool.acquire();
+  BOOST_CHECK_EQUAL(pool.n_hits(), 1);
+  BOOST_CHECK_EQUAL(reused.time_start, 0);
+  BOOST_CHECK_EQUAL(reused.adc_integral, 0);
+  BOOST_CHECK(reused.inputs.empty());
+  BOOST_CHECK_GE(reused.inputs.capacity(), 50);
+}
+
+BOOST_AUTO_TEST_CASE(acquire_inputs_is_not_counted_as_an_object)
+{
+  ObjectPool<TriggerActivity> pool;
+  BOOST_CHECK(pool.acquire_inputs().capacity() == 0);
+
+  TriggerActivity ta;
+  ta.inputs.resize(20);
+  pool.release(std::move(ta));
+  std::vector<TriggerPrimitive> inputs = pool.acquire_inputs();
+  BOOST_CHECK(inputs.empty());
+  BOOST_CHECK_GE(inputs.capacity(), 20);
+  BOOST_CHECK_EQUAL(pool.n_free(), 0);
+  BOOST_CHECK_EQUAL(pool.n_hits(), 0);
+  BOOST_CHECK_EQUAL(pool.n_misses(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(release_respects_max_free)
+{
+  ObjectPool<TriggerCandidate> pool;
+  pool.set_max_free(2);
+  for (int i = 0; i < 5; ++i)
+    pool.release(TriggerCandidate());
+  BOOST_CHECK_EQUAL(pool.n_free(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(objects_returned_from_another_thread_are_reused)
+{
+  ObjectPool<TriggerCandidate> pool;
+  std::vector<TriggerCandidate> made;
+  for (int i = 0; i < 10; ++i) {
+    made.push_back(pool.acquire());
+    made.back().inputs.resize(3);
+  }
+  BOOST_CHECK_EQUAL(pool.n_misses(), 10);
+
+  std::thread consumer([&] {
+    for (auto& tc : made)
+      pool.release_from_any_thread(std::move(tc));
+  });
+  consumer.join();
+
+  for (int i = 0; i < 10; ++i) {
+    TriggerCandidate tc = pool.acquire();
+    BOOST_CHECK(tc.inputs.empty());
+    BOOST_CHECK_GE(tc.inputs.capacity(), 3);
+  }
+  BOOST_CHECK_EQUAL(pool.n_hits(), 10);
+  BOOST_CHECK_EQUAL(pool.n_misses(), 10);
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,139 @@
+/**
+ * @file test_output_sink.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_output_sink
+
+#include "triggeralgs/OutputSink.hpp"
+#include "triggeralgs/Prescale/TAMakerPrescaleAlgorithm.hpp"
+#include "triggeralgs/SPSCQueue.hpp"
+#include "triggeralgs/TriggerObjectOverlay.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+TriggerPrimitive
+make_tp(timestamp_t time_start, channel_t channel)
+{
+  TriggerPrimitive tp;
+  tp.time_start = time_start;
+  tp.channel = channel;
+  tp.adc_integral = 100;
+  return tp;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(queue_is_bounded_and_fifo)
+{
+  SPSCQueue<int> queue(3);
+  BOOST_TEST(queue.capacity() == 4u);
+  for (int idx = 0; idx < 4; ++idx)
+    BOOST_TEST(queue.try_push(int(idx)));
+  int rejected = 4;
+  BOOST_TEST(!queue.try_push(std::move(rejected)));
+
+  int value = -1;
+  for (int idx = 0; idx < 4; ++idx) {
+    BOOST_TEST(queue.try_pop(value));
+    BOOST_TEST(value == idx);
+  }
+  BOOST_TEST(!queue.try_pop(value));
+}
+
+BOOST_AUTO_TEST_CASE(queue_across_threads)
+{
+  constexpr int n_items = 100000;
+  SPSCQueue<int> queue(64);
+
+  std::thread producer([&] {
+    for (int idx = 0; idx < n_items; ++idx) {
+      while (!queue.try_push(int(idx)))
+        std::this_thread::yield();
+    }
+  });
+
+  int expected = 0;
+  int value = 0;
+  while (expected < n_items) {
+    if (queue.try_pop(value)) {
+      BOOST_REQUIRE_EQUAL(value, expected);
+      ++expected;
+    }
+  }
+  producer.join();
+}
+
+BOOST_AUTO_TEST_CASE(blocking_push_and_pop)
+{
+  constexpr int n_items = 10000;
+  SPSCQueue<int> queue(4);
+
+  // The consumer sleeps in pop() until the producer starts
+  std::thread producer([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (int idx = 0; idx < n_items; ++idx)
+      queue.push(int(idx));
+  });
+
+  int value = -1;
+  for (int idx = 0; idx < n_items; ++idx) {
+    queue.pop(value);
+    BOOST_REQUIRE_EQUAL(value, idx);
+  }
+  producer.join();
+  BOOST_TEST(!queue.try_pop(value));
+}
+
+BOOST_AUTO_TEST_CASE(maker_emits_into_sinks)
+{
+  TAMakerPrescaleAlgorithm maker;
+  std::vector<TriggerActivity> collected;
+  auto sink = make_callback_sink<TriggerActivity>([&](TriggerActivity&& ta) { collected.push_back(std::move(ta)); });
+
+  for (timestamp_t time = 0; time < 10; ++time)
+    maker(make_tp(time, 7), sink);
+  BOOST_REQUIRE_EQUAL(collected.size(), 10u);
+  BOOST_TEST(collected[9].time_start == 9u);
+
+  // A full queue refuses TAs, which are counted.
+  SPSCQueue<TriggerActivity> queue(4);
+  QueueSink<TriggerActivity> queue_sink(queue);
+  std::vector<TriggerPrimitive> tps;
+  for (timestamp_t time = 0; time < 6; ++time)
+    tps.push_back(make_tp(time, 3));
+  maker.process_batch_to(tps, queue_sink);
+  BOOST_TEST(queue.size_approx() == 4u);
+  BOOST_TEST(maker.m_n_output_rejected == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(overlay_sink_serialises)
+{
+  TAMakerPrescaleAlgorithm maker;
+  OverlaySink<TriggerActivity> sink;
+  for (timestamp_t time = 0; time < 3; ++time)
+    maker(make_tp(100 + time, 10 + time), sink);
+
+  BOOST_REQUIRE_EQUAL(sink.n_objects(), 3u);
+  for (size_t idx = 0; idx < 3; ++idx) {
+    BOOST_TEST(sink.offsets()[idx] % 8 == 0u);
+    TriggerActivity ta = read_overlay_from_buffer<TriggerActivity>(sink.data() + sink.offsets()[idx]);
+    BOOST_TEST(ta.time_start == 100 + idx);
+    BOOST_REQUIRE_EQUAL(ta.inputs.size(), 1u);
+    BOOST_TEST(ta.inputs[0].channel == channel_t(10 + idx));
+  }
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,79 @@
+/**
+ * @file test_post_processor.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_post_processor
+
+#include "triggeralgs/PostProcessor.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+TriggerActivity
+make_ta(timestamp_t time_start, timestamp_t time_end, uint64_t adc_integral, size_t n_tps)
+{
+  TriggerActivity ta;
+  ta.time_start = time_start;
+  ta.time_end = time_end;
+  ta.adc_integral = adc_integral;
+  ta.inputs.resize(n_tps);
+  return ta;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(prescale_keeps_every_nth_in_order)
+{
+  PostProcessor<TriggerActivity> post_processor;
+  post_processor.configure({ { "prescale", 3 } });
+
+  std::vector<TriggerActivity> output;
+  for (timestamp_t idx = 0; idx < 10; ++idx)
+    output.push_back(make_ta(idx, idx + 1, 100, 1));
+  post_processor(output);
+
+  BOOST_REQUIRE_EQUAL(output.size(), 3u);
+  BOOST_TEST(output[0].time_start == 2u);
+  BOOST_TEST(output[1].time_start == 5u);
+  BOOST_TEST(output[2].time_start == 8u);
+
+  // The prescale count carries over between calls.
+  output = { make_ta(10, 11, 100, 1) };
+  post_processor(output);
+  BOOST_TEST(output.size() == 0u);
+  output = { make_ta(11, 12, 100, 1) };
+  post_processor(output);
+  BOOST_TEST(output.size() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(quality_stages)
+{
+  PostProcessor<TriggerActivity> post_processor;
+  post_processor.configure(
+    { { "output_min_inputs", 2 }, { "output_min_adc_integral", 500 }, { "output_max_time_span", 100 } });
+
+  std::vector<TriggerActivity> output = {
+    make_ta(0, 50, 1000, 5),   // kept
+    make_ta(0, 50, 1000, 1),   // too few TPs
+    make_ta(0, 50, 100, 5),    // ADC too low
+    make_ta(0, 500, 1000, 5),  // too long
+    make_ta(10, 60, 2000, 2),  // kept
+  };
+  post_processor(output);
+
+  BOOST_REQUIRE_EQUAL(output.size(), 2u);
+  BOOST_TEST(output[0].inputs.size() == 5u);
+  BOOST_TEST(output[1].adc_integral == 2000u);
+}
+
+} // namespace triggeralgs
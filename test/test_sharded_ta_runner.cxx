@@ -0,0 +1,232 @@
+/**
+ * @file test_sharded_ta_runner.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_sharded_ta_runner
+
+#include "triggeralgs/ShardedTARunner.hpp"
+#include "triggeralgs/TriggerActivityFactory.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <limits>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+const nlohmann::json maker_config = { { "window_length", 1000 }, { "min_tps", 3 }, { "max_channel_distance", 5 } };
+
+// Noise on 1024 channels, plus short tracks of adjacent hits now and then
+std::vector<TriggerPrimitive>
+make_tps(size_t n_tps)
+{
+  std::mt19937 rng(42);
+  std::vector<TriggerPrimitive> tps;
+  timestamp_t time = 100000;
+  while (tps.size() < n_tps) {
+    time += 1 + rng() % 20;
+    TriggerPrimitive tp;
+    tp.time_start = time;
+    tp.adc_integral = 100;
+    if (rng() % 50 == 0) {
+      channel_t first = rng() % 1000;
+      for (channel_t idx = 0; idx < 8; ++idx) {
+        tp.channel = first + idx;
+        tps.push_back(tp);
+      }
+    } else {
+      tp.channel = rng() % 1024;
+      tps.push_back(tp);
+    }
+  }
+  return tps;
+}
+
+bool
+is_time_ordered(const std::vector<TriggerActivity>& tas)
+{
+  return std::is_sorted(
+    tas.begin(), tas.end(), [](const TriggerActivity& a, const TriggerActivity& b) { return a.time_start < b.time_start; });
+}
+
+std::vector<std::tuple<timestamp_t, channel_t, size_t>>
+summarise(const std::vector<TriggerActivity>& tas)
+{
+  std::vector<std::tuple<timestamp_t, channel_t, size_t>> summary;
+  for (const TriggerActivity& ta : tas)
+    summary.emplace_back(ta.time_start, ta.channel_start, ta.inputs.size());
+  std::sort(summary.begin(), summary.end());
+  return summary;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(same_tas_as_one_maker_per_shard)
+{
+  constexpr size_t n_shards = 4;
+  std::vector<TriggerPrimitive> tps = make_tps(50000);
+
+  ShardedTARunner runner;
+  runner.configure({ { "algorithm", "TAMakerChannelDistanceAlgorithm" },
+                     { "n_shards", n_shards },
+                     { "n_channels", 1024 },
+                     { "queue_size", 4 },
+                     { "maker", maker_config } });
+  BOOST_REQUIRE(runner.n_shards() == n_shards);
+
+  std::vector<TriggerActivity> sharded_tas;
+  for (size_t first = 0; first < tps.size(); first += 300) {
+    size_t count = std::min<size_t>(300, tps.size() - first);
+    runner.push(span<const TriggerPrimitive>(tps.data() + first, count));
+    runner.drain(sharded_tas);
+  }
+  runner.stop(sharded_tas);
+
+  // Reference: one maker per channel range, run one after the other
+  std::vector<TriggerActivity> reference_tas;
+  for (size_t shard = 0; shard < n_shards; ++shard) {
+    auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerChannelDistanceAlgorithm");
+    maker->configure(maker_config);
+    for (const TriggerPrimitive& tp : tps) {
+      if (runner.shard_of(tp.channel) == shard)
+        (*maker)(tp, reference_tas);
+    }
+    maker->flush(std::numeric_limits<timestamp_t>::max(), reference_tas);
+  }
+
+  BOOST_TEST(!reference_tas.empty());
+  BOOST_TEST(sharded_tas.size() == reference_tas.size());
+  BOOST_TEST(summarise(sharded_tas) == summarise(reference_tas));
+  BOOST_TEST(is_time_ordered(sharded_tas));
+  BOOST_TEST(runner.stats().n_tps == tps.size());
+  BOOST_TEST(runner.stats().n_tas == sharded_tas.size());
+  BOOST_TEST(runner.stats().n_late == 0u);
+  BOOST_TEST(runner.stats().n_out_of_range == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(heartbeat_lets_tas_out)
+{
+  ShardedTARunner runner;
+  // No merge lag, so a TA made before the flush would be let out by drain()
+  runner.configure({ { "algorithm", "TAMakerChannelDistanceAlgorithm" },
+                     { "n_shards", 2 },
+                     { "n_channels", 1024 },
+                     { "merge_lag", 0 },
+                     { "maker", maker_config } });
+
+  std::vector<TriggerPrimitive> tps;
+  TriggerPrimitive tp;
+  for (channel_t channel : { 10, 11, 12, 600, 601, 602 }) {
+    tp.time_start = 5000 + channel;
+    tp.channel = channel;
+    tps.push_back(tp);
+  }
+  std::sort(tps.begin(), tps.end(), [](const TriggerPrimitive& a, const TriggerPrimitive& b) {
+    return a.time_start < b.time_start;
+  });
+  runner.push(tps);
+
+  // Once both shards have processed the TPs, the windows are still open:
+  // nothing out until the makers are flushed
+  std::vector<TriggerActivity> output_ta;
+  for (int attempt = 0; attempt < 1000 && runner.watermark() < tps.back().time_start; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    runner.drain(output_ta);
+  }
+  BOOST_REQUIRE(runner.watermark() == tps.back().time_start);
+  BOOST_TEST(output_ta.empty());
+
+  runner.heartbeat(100000);
+  for (int attempt = 0; attempt < 1000 && output_ta.size() < 2; ++attempt) {
+    std::this_thread::yield();
+    runner.drain(output_ta);
+  }
+  BOOST_REQUIRE(output_ta.size() == 2u);
+  BOOST_TEST(output_ta[0].time_start == 5010u);
+  BOOST_TEST(output_ta[1].time_start == 5600u);
+
+  runner.stop(output_ta);
+  BOOST_TEST(output_ta.size() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(idle_shards_sleep)
+{
+  ShardedTARunner runner;
+  runner.configure({ { "algorithm", "TAMakerChannelDistanceAlgorithm" }, { "n_shards", 4 }, { "n_channels", 1024 } });
+
+  // Process CPU time: four spinning shards would use about four times the wall time
+  std::clock_t cpu_start = std::clock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  double cpu_seconds = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  BOOST_TEST(cpu_seconds < 0.05);
+
+  // And they still wake up for the next input
+  std::vector<TriggerActivity> output_ta;
+  runner.heartbeat(1000);
+  for (int attempt = 0; attempt < 1000 && runner.watermark() < 1000; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    runner.drain(output_ta);
+  }
+  BOOST_TEST(runner.watermark() == 1000u);
+}
+
+BOOST_AUTO_TEST_CASE(shard_tables)
+{
+  ShardedTARunner runner;
+  runner.configure({ { "algorithm", "TAMakerPrescaleAlgorithm" }, { "n_shards", 4 }, { "n_channels", 1000 } });
+  BOOST_TEST(runner.shard_of(0) == 0u);
+  BOOST_TEST(runner.shard_of(249) == 0u);
+  BOOST_TEST(runner.shard_of(250) == 1u);
+  BOOST_TEST(runner.shard_of(999) == 3u);
+  BOOST_TEST(runner.shard_of(1000) == 0u);
+  BOOST_TEST(runner.shard_of(-1) == 0u);
+
+  runner.configure({ { "algorithm", "TAMakerPrescaleAlgorithm" },
+                     { "n_shards", 2 },
+                     { "n_channels", 4 * 2560 },
+                     { "shard_by", "apa" } });
+  BOOST_TEST(runner.shard_of(2559) == 0u);
+  BOOST_TEST(runner.shard_of(2560) == 1u);
+  BOOST_TEST(runner.shard_of(2 * 2560) == 0u);
+  BOOST_TEST(runner.shard_of(3 * 2560 + 5) == 1u);
+
+  BOOST_CHECK_THROW(runner.configure({ { "algorithm", "TAMakerPrescaleAlgorithm" },
+                                       { "n_channels", 100 },
+                                       { "shard_by", "wire" } }),
+                    BadConfiguration);
+  BOOST_CHECK_THROW(runner.configure({ { "algorithm", "TAMakerPrescaleAlgorithm" } }), BadConfiguration);
+  // Sharding by plane needs the channel map
+  BOOST_CHECK_THROW(runner.configure({ { "algorithm", "TAMakerPrescaleAlgorithm" },
+                                       { "n_channels", 100 },
+                                       { "shard_by", "plane" } }),
+                    BadConfiguration);
+
+  // The shard threads build the makers: their errors reach the caller, and
+  // the runner can be configured again
+  BOOST_CHECK_THROW(
+    runner.configure({ { "algorithm", "TAMakerNoSuchAlgorithm" }, { "n_shards", 3 }, { "n_channels", 100 } }),
+    FactoryNotFound);
+  BOOST_TEST(runner.n_shards() == 0u);
+  runner.configure({ { "algorithm", "TAMakerPrescaleAlgorithm" }, { "n_shards", 3 }, { "n_channels", 100 } });
+  std::vector<TriggerPrimitive> tps(1);
+  tps[0].time_start = 1000;
+  runner.push(tps);
+  std::vector<TriggerActivity> output_ta;
+  runner.stop(output_ta);
+  BOOST_TEST(output_ta.size() == 1u);
+}
+
+} // namespace triggeralgs
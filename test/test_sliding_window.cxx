@@ -0,0 +1,265 @@
+/**
+ * @file test_sliding_window.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_sliding_window
+
+#include "triggeralgs/SlidingWindow.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+using FullTPWindow = SlidingWindow<TriggerPrimitive,
+                                   window_stats::ADCSum,
+                                   window_stats::ToTSum,
+                                   window_stats::PeakADC,
+                                   window_stats::ChannelExtent,
+                                   window_stats::ChannelCounts>;
+using FullTAWindow = SlidingWindow<TriggerActivity,
+                                   window_stats::ADCSum,
+                                   window_stats::ToTSum,
+                                   window_stats::PeakADC,
+                                   window_stats::ChannelExtent,
+                                   window_stats::ChannelCounts>;
+
+TriggerPrimitive
+make_tp(timestamp_t time_start, channel_t channel, uint32_t adc_peak = 10, timestamp_t time_over_threshold = 4)
+{
+  TriggerPrimitive tp;
+  tp.time_start = time_start;
+  tp.channel = channel;
+  tp.adc_peak = adc_peak;
+  tp.adc_integral = 3 * adc_peak;
+  tp.time_over_threshold = time_over_threshold;
+  return tp;
+}
+
+TriggerActivity
+make_ta(timestamp_t time_start, const std::vector<TriggerPrimitive>& tps)
+{
+  TriggerActivity ta;
+  ta.time_start = time_start;
+  ta.channel_start = tps.front().channel;
+  ta.channel_end = tps.front().channel;
+  for (const TriggerPrimitive& tp : tps) {
+    ta.adc_integral += tp.adc_integral;
+    ta.adc_peak = std::max<uint32_t>(ta.adc_peak, tp.adc_peak);
+    ta.channel_start = std::min(ta.channel_start, tp.channel);
+    ta.channel_end = std::max(ta.channel_end, tp.channel);
+    ta.inputs.push_back(tp);
+  }
+  return ta;
+}
+
+const std::vector<TriggerPrimitive>&
+tps_of(const TriggerActivity& ta)
+{
+  return ta.inputs;
+}
+
+std::vector<TriggerPrimitive>
+tps_of(const TriggerPrimitive& tp)
+{
+  return { tp };
+}
+
+// Every statistic of the window against a recount of its elements
+template<class Window>
+void
+check_stats(const Window& window)
+{
+  uint64_t adc_integral = 0;
+  timestamp_t time_over_threshold = 0;
+  uint32_t adc_peak = 0;
+  channel_t channel_min = 0;
+  channel_t channel_max = 0;
+  std::map<channel_t, int> hits;
+  for (const auto& element : window.inputs) {
+    adc_integral += element.adc_integral;
+    adc_peak = std::max<uint32_t>(adc_peak, element.adc_peak);
+    if (&element == &window.inputs.front()) {
+      channel_min = window_stats::first_channel_of(element);
+      channel_max = window_stats::last_channel_of(element);
+    }
+    channel_min = std::min(channel_min, window_stats::first_channel_of(element));
+    channel_max = std::max(channel_max, window_stats::last_channel_of(element));
+    for (const TriggerPrimitive& tp : tps_of(element)) {
+      time_over_threshold += tp.time_over_threshold;
+      hits[tp.channel]++;
+    }
+  }
+  BOOST_TEST(window.adc_integral == adc_integral);
+  BOOST_TEST(window.time_over_threshold == time_over_threshold);
+  BOOST_TEST(window.adc_peak == adc_peak);
+  BOOST_TEST(window.channel_min == channel_min);
+  BOOST_TEST(window.channel_max == channel_max);
+  BOOST_TEST(window.n_channels_hit() == hits.size());
+  for (const auto& [channel, n_hits] : hits)
+    BOOST_TEST(window.channel_states.count(channel) == n_hits);
+}
+
+template<class Window, class MakeElement>
+void
+slide_random_stream(MakeElement make_element, unsigned seed)
+{
+  std::mt19937 rng(seed);
+  Window window;
+  timestamp_t time = 10000;
+  for (size_t idx = 0; idx < 3000; ++idx) {
+    time += rng() % 50;
+    // Now and then an element that is late by up to 100 ticks
+    timestamp_t time_start = rng() % 10 == 0 ? time - rng() % 100 : time;
+    auto element = make_element(rng, time_start);
+
+    if (window.is_empty())
+      window.reset(std::move(element));
+    else
+      window.move(std::move(element), 400);
+
+    BOOST_REQUIRE(std::is_sorted(window.inputs.begin(), window.inputs.end(), [](const auto& a, const auto& b) {
+      return a.time_start < b.time_start;
+    }));
+    BOOST_REQUIRE(window.time_start == window.inputs.front().time_start);
+    check_stats(window);
+
+    if (idx % 1000 == 999) {
+      window.clear();
+      check_stats(window);
+    }
+  }
+}
+
+// The TPWindow before it was a SlidingWindow: a vector appended to, and
+// erased from the front
+struct LegacyTPWindow
+{
+  void move(const TriggerPrimitive& input, timestamp_t window_length)
+  {
+    size_t n_to_erase = 0;
+    for (const TriggerPrimitive& tp : inputs) {
+      if (input.time_start - tp.time_start < window_length)
+        break;
+      adc_integral -= tp.adc_integral;
+      n_to_erase++;
+    }
+    inputs.erase(inputs.begin(), inputs.begin() + n_to_erase);
+    if (inputs.empty()) {
+      reset(input);
+      return;
+    }
+    time_start = inputs.front().time_start;
+    inputs.push_back(input);
+    adc_integral += input.adc_integral;
+  }
+  void reset(const TriggerPrimitive& input)
+  {
+    inputs = { input };
+    time_start = input.time_start;
+    adc_integral = input.adc_integral;
+  }
+
+  timestamp_t time_start = 0;
+  uint64_t adc_integral = 0;
+  std::vector<TriggerPrimitive> inputs;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(tp_stats_match_recount)
+{
+  slide_random_stream<FullTPWindow>(
+    [](std::mt19937& rng, timestamp_t time_start) {
+      return make_tp(time_start, rng() % 40, 1 + rng() % 200, 1 + rng() % 20);
+    },
+    3);
+}
+
+BOOST_AUTO_TEST_CASE(ta_stats_match_recount)
+{
+  slide_random_stream<FullTAWindow>(
+    [](std::mt19937& rng, timestamp_t time_start) {
+      std::vector<TriggerPrimitive> tps(1 + rng() % 8);
+      for (TriggerPrimitive& tp : tps)
+        tp = make_tp(time_start, rng() % 40, 1 + rng() % 200, 1 + rng() % 20);
+      return make_ta(time_start, tps);
+    },
+    5);
+}
+
+BOOST_AUTO_TEST_CASE(stats_follow_their_extremes)
+{
+  FullTPWindow window;
+  window.reset(make_tp(0, 20, 100));
+  window.add(make_tp(10, 5, 50));
+  window.add(make_tp(20, 30, 10));
+  BOOST_TEST(window.adc_peak == 100u);
+  BOOST_TEST(window.channel_min == 5);
+  BOOST_TEST(window.channel_max == 30);
+
+  // The peak expires: the next highest takes over
+  window.expire(100, 95);
+  BOOST_TEST(window.adc_peak == 50u);
+  BOOST_TEST(window.channel_min == 5);
+  // Then the lowest channel
+  window.expire(110, 95);
+  BOOST_TEST(window.adc_peak == 10u);
+  BOOST_TEST(window.channel_min == 30);
+  BOOST_TEST(window.channel_max == 30);
+  check_stats(window);
+}
+
+BOOST_AUTO_TEST_CASE(windows_pay_only_for_their_stats)
+{
+  using ADCWindow = SlidingWindow<TriggerPrimitive, window_stats::ADCSum>;
+  BOOST_TEST(sizeof(ADCWindow) < sizeof(FullTPWindow));
+
+  ADCWindow window;
+  window.reset(make_tp(0, 1));
+  window.add(make_tp(5, 2));
+  BOOST_TEST(window.adc_integral == 60u);
+  std::vector<TriggerPrimitive> taken;
+  window.take_inputs(taken);
+  BOOST_TEST(taken.size() == 2u);
+  BOOST_TEST(window.is_empty());
+  BOOST_TEST(window.adc_integral == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(in_order_stream_matches_legacy_window)
+{
+  std::mt19937 rng(7);
+  SlidingWindow<TriggerPrimitive, window_stats::ADCSum> window;
+  LegacyTPWindow legacy;
+  timestamp_t time = 0;
+  for (size_t idx = 0; idx < 5000; ++idx) {
+    // Gaps now and then longer than the window, which empty it
+    time += rng() % 100 == 0 ? 1000 : rng() % 40;
+    TriggerPrimitive tp = make_tp(time, rng() % 40, 1 + rng() % 200);
+    if (idx == 0) {
+      window.reset(tp);
+      legacy.reset(tp);
+    } else {
+      window.move(tp, 300);
+      legacy.move(tp, 300);
+    }
+    BOOST_REQUIRE(window.inputs.size() == legacy.inputs.size());
+    BOOST_TEST(window.time_start == legacy.time_start);
+    BOOST_TEST(window.adc_integral == legacy.adc_integral);
+    BOOST_TEST(window.inputs.front().time_start == legacy.inputs.front().time_start);
+    BOOST_TEST(window.inputs.back().time_start == legacy.inputs.back().time_start);
+  }
+}
+
+} // namespace triggeralgs
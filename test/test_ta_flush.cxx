@@ -0,0 +1,236 @@
+/**
+ * @file test_ta_flush.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_ta_flush
+
+#include "triggeralgs/ADCSimpleWindow/TAMakerADCSimpleWindowAlgorithm.hpp"
+#include "triggeralgs/BundleN/TAMakerBundleNAlgorithm.hpp"
+#include "triggeralgs/ChannelAdjacency/TAMakerChannelAdjacencyAlgorithm.hpp"
+#include "triggeralgs/ChannelDistance/TAMakerChannelDistanceAlgorithm.hpp"
+#include "triggeralgs/HorizontalMuon/TAMakerHorizontalMuonAlgorithm.hpp"
+#include "triggeralgs/MichelElectron/TAMakerMichelElectronAlgorithm.hpp"
+#include "triggeralgs/PlaneCoincidence/TAMakerPlaneCoincidenceAlgorithm.hpp"
+#include "triggeralgs/dbscan/TAMakerDBSCANAlgorithm.hpp"
+
+#include "detchannelmaps/TPCChannelMap.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+TriggerPrimitive
+make_tp(timestamp_t time_start, channel_t channel, uint32_t adc_integral = 100)
+{
+  TriggerPrimitive tp;
+  tp.time_start = time_start;
+  tp.channel = channel;
+  tp.adc_integral = adc_integral;
+  return tp;
+}
+
+// A short track followed by silence on the input
+std::vector<TriggerPrimitive>
+make_track(channel_t first_channel = 100)
+{
+  std::vector<TriggerPrimitive> tps;
+  for (channel_t idx = 0; idx < 20; ++idx)
+    tps.push_back(make_tp(1000 + 10 * idx, first_channel + idx));
+  return tps;
+}
+
+// A track steep at its start, with a charge bump, as the Michel electron checks look for
+std::vector<TriggerPrimitive>
+make_michel_track()
+{
+  std::vector<TriggerPrimitive> tps;
+  timestamp_t time = 1000;
+  for (channel_t idx = 0; idx < 30; ++idx) {
+    time += idx < 4 ? 1 : 10;
+    tps.push_back(make_tp(time, 100 + idx, idx >= 20 && idx < 25 ? 1000 : 100));
+  }
+  return tps;
+}
+
+// First of n_channels consecutive collection channels in the channel map
+channel_t
+find_collection_channels(const std::string& channel_map_name, channel_t n_channels)
+{
+  auto channel_map = dunedaq::detchannelmaps::make_map(channel_map_name);
+  channel_t first = 0;
+  for (channel_t channel = 0; channel < 100000; ++channel) {
+    if (channel_map->get_plane_from_offline_channel(channel) != 2) {
+      first = channel + 1;
+    } else if (channel - first + 1 == n_channels) {
+      return first;
+    }
+  }
+  BOOST_FAIL("no collection channels in " << channel_map_name);
+  return 0;
+}
+
+/**
+ * Flushing one maker up to until must output the same TAs as another,
+ * identically configured, maker outputs when the next TP is at until.
+ */
+template<class Maker>
+void
+check_flush_matches_next_tp(const nlohmann::json& config,
+                            timestamp_t until,
+                            size_t n_expected,
+                            const std::vector<TriggerPrimitive>& track = make_track(),
+                            channel_t next_channel = 5000)
+{
+  Maker flushed, fed;
+  flushed.configure(config);
+  fed.configure(config);
+
+  std::vector<TriggerActivity> flushed_tas, fed_tas;
+  for (const TriggerPrimitive& tp : track) {
+    flushed(tp, flushed_tas);
+    fed(tp, fed_tas);
+  }
+  BOOST_TEST(flushed_tas.empty());
+
+  // Nothing is complete yet one tick after the last TP
+  flushed.flush(track.back().time_start + 1, flushed_tas);
+  BOOST_TEST(flushed_tas.empty());
+
+  flushed.flush(until, flushed_tas);
+  fed(make_tp(until, next_channel), fed_tas);
+
+  BOOST_REQUIRE(flushed_tas.size() == n_expected);
+  BOOST_REQUIRE(fed_tas.size() == n_expected);
+  for (size_t idx = 0; idx < n_expected; ++idx) {
+    BOOST_TEST(flushed_tas[idx].time_start == fed_tas[idx].time_start);
+    BOOST_TEST(flushed_tas[idx].time_end == fed_tas[idx].time_end);
+    BOOST_TEST(flushed_tas[idx].adc_integral == fed_tas[idx].adc_integral);
+    BOOST_TEST(flushed_tas[idx].inputs.size() == fed_tas[idx].inputs.size());
+  }
+
+  // A second flush has nothing left to output
+  flushed_tas.clear();
+  flushed.flush(until, flushed_tas);
+  BOOST_TEST(flushed_tas.empty());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(adc_simple_window)
+{
+  nlohmann::json config = { { "window_length", 1000 }, { "adc_threshold", 1000 } };
+  check_flush_matches_next_tp<TAMakerADCSimpleWindowAlgorithm>(config, 3000, 1);
+}
+
+BOOST_AUTO_TEST_CASE(horizontal_muon)
+{
+  nlohmann::json config = { { "window_length", 1000 },
+                            { "trigger_on_adc", false },
+                            { "trigger_on_n_channels", false },
+                            { "trigger_on_adjacency", true },
+                            { "adjacency_threshold", 10 },
+                            { "adjacency_tolerance", 1 } };
+  check_flush_matches_next_tp<TAMakerHorizontalMuonAlgorithm>(config, 3000, 1);
+}
+
+BOOST_AUTO_TEST_CASE(channel_distance)
+{
+  nlohmann::json config = { { "window_length", 1000 }, { "min_tps", 10 }, { "max_channel_distance", 5 } };
+  check_flush_matches_next_tp<TAMakerChannelDistanceAlgorithm>(config, 3000, 1);
+}
+
+BOOST_AUTO_TEST_CASE(channel_adjacency)
+{
+  nlohmann::json config = { { "window_length", 1000 }, { "adjacency_threshold", 10 }, { "adjacency_tolerance", 1 } };
+  check_flush_matches_next_tp<TAMakerChannelAdjacencyAlgorithm>(config, 3000, 1);
+}
+
+BOOST_AUTO_TEST_CASE(michel_electron)
+{
+  nlohmann::json config = { { "window_length", 1000 }, { "adjacency_threshold", 15 }, { "adjacency_tolerance", 1 } };
+  check_flush_matches_next_tp<TAMakerMichelElectronAlgorithm>(config, 3000, 1, make_michel_track());
+}
+
+BOOST_AUTO_TEST_CASE(plane_coincidence)
+{
+  // The windows are per plane: the track, and the next TP, have to be on collection channels.
+  channel_t first_channel = find_collection_channels("VDColdboxChannelMap", 40);
+  nlohmann::json config = { { "window_length", 1000 },
+                            { "adc_threshold", 1000 },
+                            { "adjacency_threshold", 10 },
+                            { "adjacency_tolerance", 1 } };
+  check_flush_matches_next_tp<TAMakerPlaneCoincidenceAlgorithm>(
+    config, 3000, 1, make_track(first_channel), first_channel + 39);
+}
+
+BOOST_AUTO_TEST_CASE(dbscan_clusters)
+{
+  nlohmann::json config = { { "eps", 10 }, { "min_pts", 3 } };
+  check_flush_matches_next_tp<TAMakerDBSCANAlgorithm>(config, 10000, 1);
+}
+
+BOOST_AUTO_TEST_CASE(incomplete_window_is_kept)
+{
+  TAMakerADCSimpleWindowAlgorithm maker;
+  maker.configure({ { "window_length", 1000 }, { "adc_threshold", 1000 } });
+
+  std::vector<TriggerActivity> output_ta;
+  for (const TriggerPrimitive& tp : make_track())
+    maker(tp, output_ta);
+
+  // The window started at 1000, so is not complete before 2000
+  maker.flush(1999, output_ta);
+  BOOST_TEST(output_ta.empty());
+  maker.flush(2000, output_ta);
+  BOOST_REQUIRE(output_ta.size() == 1u);
+  BOOST_TEST(output_ta[0].inputs.size() == 20u);
+}
+
+BOOST_AUTO_TEST_CASE(bundle_n_keeps_partial_bundle)
+{
+  TAMakerBundleNAlgorithm maker;
+  maker.configure({ { "bundle_size", 8 } });
+
+  std::vector<TriggerActivity> output_ta;
+  for (const TriggerPrimitive& tp : make_track())
+    maker(tp, output_ta);
+  BOOST_TEST(output_ta.size() == 2u);
+
+  // The four TPs left over could still be joined by later ones
+  output_ta.clear();
+  maker.flush(1191, output_ta);
+  maker.flush(100000, output_ta);
+  BOOST_TEST(output_ta.empty());
+}
+
+BOOST_AUTO_TEST_CASE(bundle_n_sends_partial_bundle_if_configured)
+{
+  TAMakerBundleNAlgorithm maker;
+  maker.configure({ { "bundle_size", 8 }, { "flush_partial_bundles", true } });
+
+  std::vector<TriggerActivity> output_ta;
+  for (const TriggerPrimitive& tp : make_track())
+    maker(tp, output_ta);
+  BOOST_TEST(output_ta.size() == 2u);
+
+  // The last TP is at 1190: the four TPs left over are only sent once they are all older than until
+  output_ta.clear();
+  maker.flush(1190, output_ta);
+  BOOST_TEST(output_ta.empty());
+  maker.flush(1191, output_ta);
+  BOOST_REQUIRE(output_ta.size() == 1u);
+  BOOST_TEST(output_ta[0].inputs.size() == 4u);
+  BOOST_TEST(output_ta[0].time_start == 1160u);
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,136 @@
+/**
+ * @file test_ta_window.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_ta_window
+
+#include "triggeralgs/TAWindow.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+TriggerActivity
+make_ta(timestamp_t time_start, std::vector<channel_t> channels)
+{
+  TriggerActivity ta;
+  ta.time_start = time_start;
+  for (channel_t channel : channels) {
+    TriggerPrimitive tp;
+    tp.time_start = time_start;
+    tp.channel = channel;
+    tp.adc_integral = 10;
+    ta.inputs.push_back(tp);
+    ta.adc_integral += tp.adc_integral;
+  }
+  return ta;
+}
+
+// Channels hit, and ADC, of the TAs in the window counted from scratch
+void
+check_counts(const TAWindow& window)
+{
+  std::map<channel_t, int> hits;
+  uint64_t adc_integral = 0;
+  for (const TriggerActivity& ta : window.inputs) {
+    adc_integral += ta.adc_integral;
+    for (const TriggerPrimitive& tp : ta.inputs)
+      hits[tp.channel]++;
+  }
+  BOOST_TEST(window.n_channels_hit() == hits.size());
+  BOOST_TEST(window.adc_integral == adc_integral);
+  for (const auto& [channel, n_hits] : hits)
+    BOOST_TEST(window.channel_states.count(channel) == n_hits);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(insertion_keeps_time_order)
+{
+  TAWindow window;
+  window.reset(make_ta(100, { 1, 2, 2 }));
+  window.add(make_ta(300, { 3 }));
+  window.add(make_ta(200, { 2, 4 }));
+  window.add(make_ta(50, { 5 }));
+  // Same time_start: after the ones already there
+  TriggerActivity same = make_ta(200, { 6 });
+  same.channel_start = 6;
+  window.add(std::move(same));
+
+  std::vector<timestamp_t> times;
+  for (const TriggerActivity& ta : window.inputs)
+    times.push_back(ta.time_start);
+  BOOST_TEST(times == (std::vector<timestamp_t>{ 50, 100, 200, 200, 300 }));
+  BOOST_TEST(window.inputs[3].channel_start == 6);
+  BOOST_TEST(window.n_channels_hit() == 6);
+  check_counts(window);
+
+  // The TAs at 50 and 100 expire, taking channels 1 and 5 with them
+  window.expire(250, 150);
+  BOOST_TEST(window.inputs.size() == 3u);
+  BOOST_TEST(window.time_start == 200u);
+  BOOST_TEST(window.channel_states.count(1) == 0);
+  BOOST_TEST(window.channel_states.count(2) == 1);
+  check_counts(window);
+
+  window.clear();
+  BOOST_TEST(window.is_empty());
+  BOOST_TEST(window.n_channels_hit() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(more_tas_than_a_uint16_index)
+{
+  // Insertion used a uint16_t index, which wrapped past 65535 TAs
+  constexpr size_t n_tas = 70000;
+  TAWindow window;
+  window.reset(make_ta(0, { 0 }));
+  for (size_t idx = 1; idx < n_tas; ++idx)
+    window.add(make_ta(2 * idx, { static_cast<channel_t>(idx % 100) }));
+
+  window.add(make_ta(2 * 66000 + 1, { 7 }));
+  BOOST_TEST(window.inputs.size() == n_tas + 1);
+  BOOST_TEST(window.inputs[66000].time_start == 2 * 66000u);
+  BOOST_TEST(window.inputs[66001].time_start == 2 * 66000u + 1);
+  BOOST_TEST(window.inputs[66002].time_start == 2 * 66001u);
+}
+
+BOOST_AUTO_TEST_CASE(sliding_matches_recount)
+{
+  std::mt19937 rng(11);
+  TAWindow window;
+  timestamp_t time = 10000;
+  for (size_t idx = 0; idx < 3000; ++idx) {
+    time += rng() % 50;
+    std::vector<channel_t> channels(1 + rng() % 8);
+    for (channel_t& channel : channels)
+      channel = rng() % 40;
+    // Now and then a TA that is late by up to 100 ticks
+    timestamp_t time_start = rng() % 10 == 0 && time > 100 ? time - rng() % 100 : time;
+    TriggerActivity ta = make_ta(time_start, channels);
+
+    if (window.is_empty())
+      window.reset(std::move(ta));
+    else
+      window.move(std::move(ta), 400);
+
+    BOOST_REQUIRE(std::is_sorted(
+      window.inputs.begin(), window.inputs.end(), [](const TriggerActivity& a, const TriggerActivity& b) {
+        return a.time_start < b.time_start;
+      }));
+    check_counts(window);
+  }
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,173 @@
+/**
+ * @file test_tc_flush.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_tc_flush
+
+#include "triggeralgs/HorizontalMuon/TCMakerHorizontalMuonAlgorithm.hpp"
+#include "triggeralgs/MichelElectron/TCMakerMichelElectronAlgorithm.hpp"
+#include "triggeralgs/TAWindow.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+TriggerActivity
+make_ta(timestamp_t time_start, uint64_t adc_integral, channel_t channel = 0)
+{
+  TriggerActivity ta;
+  ta.time_start = time_start;
+  ta.time_end = time_start + 100;
+  ta.adc_integral = adc_integral;
+  TriggerPrimitive tp;
+  tp.time_start = time_start;
+  tp.channel = channel;
+  ta.inputs.push_back(tp);
+  return ta;
+}
+
+const nlohmann::json s_me_config = { { "trigger_on_adc", true },
+                                     { "trigger_on_n_channels", false },
+                                     { "adc_threshold", 1000 },
+                                     { "window_length", 1000 } };
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(flush_matches_next_ta)
+{
+  TCMakerMichelElectronAlgorithm flushed, fed;
+  flushed.configure(s_me_config);
+  fed.configure(s_me_config);
+
+  std::vector<TriggerCandidate> flushed_tcs, fed_tcs;
+  for (timestamp_t time : { 1000, 1200, 1400 }) {
+    flushed(make_ta(time, 400), flushed_tcs);
+    fed(make_ta(time, 400), fed_tcs);
+  }
+  BOOST_TEST(flushed_tcs.empty());
+
+  // The window started at 1000, so is not complete before 2000
+  flushed.flush(1999, flushed_tcs);
+  BOOST_TEST(flushed_tcs.empty());
+
+  flushed.flush(2000, flushed_tcs);
+  fed(make_ta(2000, 400), fed_tcs);
+  BOOST_REQUIRE(flushed_tcs.size() == 1u);
+  BOOST_REQUIRE(fed_tcs.size() == 1u);
+  BOOST_TEST(flushed_tcs[0].time_start == fed_tcs[0].time_start);
+  BOOST_TEST(flushed_tcs[0].time_end == fed_tcs[0].time_end);
+  BOOST_TEST(flushed_tcs[0].inputs.size() == 3u);
+
+  // No duplicate: the flushed window is gone
+  flushed_tcs.clear();
+  flushed.flush(5000, flushed_tcs);
+  BOOST_TEST(flushed_tcs.empty());
+}
+
+BOOST_AUTO_TEST_CASE(below_threshold_window_moves_on)
+{
+  TCMakerMichelElectronAlgorithm flushed, fed;
+  flushed.configure(s_me_config);
+  fed.configure(s_me_config);
+
+  std::vector<TriggerCandidate> flushed_tcs, fed_tcs;
+  for (timestamp_t time : { 1000, 1500, 1900 }) {
+    flushed(make_ta(time, 300), flushed_tcs);
+    fed(make_ta(time, 300), fed_tcs);
+  }
+
+  // Below threshold: only the TA at 1000 is dropped, as the next TA would
+  flushed.flush(2100, flushed_tcs);
+  BOOST_TEST(flushed_tcs.empty());
+
+  // Both makers then see the same window
+  flushed(make_ta(2100, 300), flushed_tcs);
+  fed(make_ta(2100, 300), fed_tcs);
+  for (timestamp_t time : { 2200, 2600 }) {
+    flushed(make_ta(time, 300), flushed_tcs);
+    fed(make_ta(time, 300), fed_tcs);
+  }
+  BOOST_REQUIRE(flushed_tcs.size() == fed_tcs.size());
+  BOOST_REQUIRE(fed_tcs.size() == 1u);
+  BOOST_TEST(flushed_tcs[0].time_start == fed_tcs[0].time_start);
+  BOOST_TEST(flushed_tcs[0].inputs.size() == 4u);
+}
+
+BOOST_AUTO_TEST_CASE(watermark_lag)
+{
+  TCMakerMichelElectronAlgorithm maker;
+  nlohmann::json config = s_me_config;
+  config["watermark_lag"] = 500;
+  maker.configure(config);
+
+  std::vector<TriggerCandidate> output_tc;
+  maker(make_ta(1000, 600), output_tc);
+  maker(make_ta(1100, 600), output_tc);
+
+  // Flushes up to 2499 - 500, short of the end of the window
+  maker.advance_watermark(2499, output_tc);
+  BOOST_TEST(output_tc.empty());
+  maker.advance_watermark(2500, output_tc);
+  BOOST_REQUIRE(output_tc.size() == 1u);
+
+  // The watermark never moves backwards
+  maker(make_ta(2100, 600), output_tc);
+  maker(make_ta(2200, 600), output_tc);
+  maker.advance_watermark(3000, output_tc);
+  BOOST_TEST(output_tc.size() == 1u);
+  maker.advance_watermark(3600, output_tc);
+  BOOST_TEST(output_tc.size() == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(eager_maker_only_expires)
+{
+  TCMakerHorizontalMuonAlgorithm maker;
+  maker.configure({ { "trigger_on_adc", true },
+                    { "trigger_on_n_channels", false },
+                    { "adc_threshold", 1000 },
+                    { "window_length", 1000 } });
+
+  std::vector<TriggerCandidate> output_tc;
+  maker(make_ta(1000, 400), output_tc);
+  maker(make_ta(1500, 400), output_tc);
+  maker.flush(2200, output_tc);
+  BOOST_TEST(output_tc.empty());
+
+  // The TA at 1000 was dropped, so this one does not cross the threshold
+  maker(make_ta(2300, 400), output_tc);
+  BOOST_TEST(output_tc.empty());
+  maker(make_ta(2400, 400), output_tc);
+  BOOST_TEST(output_tc.size() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(window_expire)
+{
+  TAWindow window;
+  window.reset(make_ta(1000, 10, 1));
+  window.add(make_ta(1200, 20, 2));
+  window.add(make_ta(1400, 30, 2));
+
+  window.expire(2100, 1000);
+  BOOST_TEST(window.inputs.size() == 2u);
+  BOOST_TEST(window.time_start == 1200u);
+  BOOST_TEST(window.adc_integral == 50u);
+  BOOST_TEST(window.n_channels_hit() == 1u);
+
+  // A time before the window start expires nothing
+  window.expire(500, 1000);
+  BOOST_TEST(window.inputs.size() == 2u);
+
+  window.expire(5000, 1000);
+  BOOST_TEST(window.is_empty());
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,172 @@
+/**
+ * @file test_thread_placement.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_thread_placement
+
+#include "triggeralgs/Issues.hpp"
+#include "triggeralgs/MakerScheduler.hpp"
+#include "triggeralgs/ShardedTARunner.hpp"
+#include "triggeralgs/ThreadPlacement.hpp"
+#include "triggeralgs/TriggerActivityFactory.hpp"
+#include "triggeralgs/TriggerPipeline.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+std::string
+thread_name()
+{
+  char name[16] = {};
+  pthread_getname_np(pthread_self(), name, sizeof(name));
+  return name;
+}
+
+// Records the threads it is built and configured on
+class TAMakerRecordThread : public TriggerActivityMaker
+{
+public:
+  TAMakerRecordThread() { record(); }
+
+  void process(const TriggerPrimitive& /* input_tp */, std::vector<TriggerActivity>& /* output_ta */) override {}
+
+  void configure(const nlohmann::json& config) override
+  {
+    TriggerActivityMaker::configure(config);
+    record();
+  }
+
+  static std::vector<std::string> take_threads()
+  {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::vector<std::string> threads;
+    threads.swap(s_threads);
+    std::sort(threads.begin(), threads.end());
+    return threads;
+  }
+
+private:
+  static void record()
+  {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_threads.push_back(thread_name());
+  }
+
+  static std::mutex s_mutex;
+  static std::vector<std::string> s_threads;
+};
+
+std::mutex TAMakerRecordThread::s_mutex;
+std::vector<std::string> TAMakerRecordThread::s_threads;
+
+REGISTER_TRIGGER_ACTIVITY_MAKER("TAMakerRecordThread", TAMakerRecordThread)
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(pins_and_names_the_thread)
+{
+  ThreadPlacement placement;
+  placement.configure({ { "cpus", { 0 } } }, "a-long-thread-name");
+  BOOST_TEST(placement.name() == "a-long-thread-n");
+
+  // Checked from the test thread, as Boost.Test is not thread safe
+  bool applied = false;
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  char name[16] = {};
+  std::thread thread([&] {
+    applied = placement.apply();
+    sched_getaffinity(0, sizeof(cpu_set), &cpu_set);
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+  });
+  thread.join();
+
+  BOOST_TEST(applied);
+  BOOST_TEST(CPU_COUNT(&cpu_set) == 1);
+  BOOST_TEST(CPU_ISSET(0, &cpu_set));
+  BOOST_TEST(std::string(name) == "a-long-thread-n");
+}
+
+BOOST_AUTO_TEST_CASE(numa_node_gives_its_cpus)
+{
+  BOOST_TEST(ThreadPlacement::n_numa_nodes() >= 1);
+
+  ThreadPlacement placement;
+  placement.configure({ { "numa_node", 0 } }, "node-0");
+  BOOST_TEST(placement.numa_node() == 0);
+  BOOST_TEST(placement.cpus() == ThreadPlacement::cpus_of_node(0));
+
+  // Given CPUs take precedence over the node's
+  placement.configure({ { "numa_node", 0 }, { "cpus", { 0 } } }, "node-0");
+  BOOST_TEST(placement.cpus() == std::vector<int>{ 0 });
+
+  placement.configure(nlohmann::json(), "none");
+  BOOST_TEST(placement.cpus().empty());
+  BOOST_TEST(placement.numa_node() == -1);
+  BOOST_TEST(placement.name() == "none");
+}
+
+BOOST_AUTO_TEST_CASE(makers_built_on_their_threads)
+{
+  // Built and configured once each, by the placed thread
+  ShardedTARunner runner;
+  runner.configure({ { "algorithm", "TAMakerRecordThread" },
+                     { "n_shards", 2 },
+                     { "n_channels", 64 },
+                     { "placement", { { { "name", "shard-a" } }, { { "name", "shard-b" } } } } });
+  std::vector<TriggerActivity> output_ta;
+  runner.stop(output_ta);
+  BOOST_TEST(TAMakerRecordThread::take_threads() ==
+             (std::vector<std::string>{ "shard-a", "shard-a", "shard-b", "shard-b" }));
+
+  TriggerPipeline pipeline;
+  pipeline.configure({ { "ta_algorithm", "TAMakerRecordThread" },
+                       { "tc_algorithm", "TCMakerPrescaleAlgorithm" },
+                       { "placement", { { "ta", { { "name", "stage-ta" } } } } } });
+  std::vector<TriggerDecision> output_td;
+  pipeline.stop(output_td);
+  BOOST_TEST(TAMakerRecordThread::take_threads() == (std::vector<std::string>{ "stage-ta", "stage-ta" }));
+
+  // The scheduler's makers are the caller's, but its workers are placed
+  MakerScheduler scheduler;
+  scheduler.configure({ { "n_workers", 1 }, { "placement", { { { "name", "worker" } } } } });
+  auto maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerPrescaleAlgorithm");
+  std::string worker_name;
+  auto sink = make_callback_sink<TriggerActivity>([&](TriggerActivity&&) { worker_name = thread_name(); });
+  auto handle = scheduler.add_maker(*maker, sink);
+  scheduler.start();
+  BOOST_TEST(scheduler.submit(handle, std::vector<TriggerPrimitive>(1)));
+  scheduler.wait();
+  BOOST_TEST(worker_name == "worker");
+}
+
+BOOST_AUTO_TEST_CASE(bad_configuration)
+{
+  ThreadPlacement placement;
+  BOOST_CHECK_THROW(placement.configure({ { "cpus", { -1 } } }, "bad"), BadConfiguration);
+
+  ShardedTARunner runner;
+  BOOST_CHECK_THROW(runner.configure({ { "algorithm", "TAMakerPrescaleAlgorithm" },
+                                       { "n_channels", 64 },
+                                       { "placement", { { "cpus", { 0 } } } } }),
+                    BadConfiguration);
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,171 @@
+/**
+ * @file test_tp_arena.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_tp_arena
+
+#include "triggeralgs/ChannelDistance/TAMakerChannelDistanceAlgorithm.hpp"
+#include "triggeralgs/SlicedTriggerActivity.hpp"
+#include "triggeralgs/TPArena.hpp"
+#include "triggeralgs/TriggerObjectOverlay.hpp"
+#include "triggeralgs/Types.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+std::vector<TriggerPrimitive>
+make_tps(size_t n_tps, timestamp_t first_time)
+{
+  std::vector<TriggerPrimitive> tps(n_tps);
+  for (size_t idx = 0; idx < n_tps; ++idx) {
+    tps[idx].time_start = first_time + idx;
+    tps[idx].channel = idx;
+    tps[idx].adc_integral = 10 * idx;
+  }
+  return tps;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(slices_are_contiguous_and_outlive_their_block)
+{
+  TPArena arena(8);
+  std::vector<TriggerPrimitive> tps = make_tps(6, 100);
+
+  TPSlice first = arena.append(tps);
+  // Does not fit the room left in the first block, so starts a new one.
+  TPSlice second = arena.append(tps);
+  TPSlice copy = first;
+  BOOST_TEST(arena.n_blocks() == 2u);
+  BOOST_TEST(arena.n_appended() == 12u);
+
+  // Longer than a block: gets a block of its own.
+  std::vector<TriggerPrimitive> long_run = make_tps(20, 200);
+  TPSlice third = arena.append(long_run);
+  BOOST_TEST(arena.n_blocks() == 3u);
+
+  BOOST_REQUIRE_EQUAL(copy.size(), 6u);
+  BOOST_TEST(copy.data() == first.data());
+  BOOST_TEST(second.data() != first.data());
+  for (size_t idx = 0; idx < 6; ++idx) {
+    BOOST_TEST(copy[idx].time_start == tps[idx].time_start);
+    BOOST_TEST(second[idx].adc_integral == tps[idx].adc_integral);
+  }
+  BOOST_REQUIRE_EQUAL(third.size(), 20u);
+  BOOST_TEST(third.back().time_start == 219u);
+}
+
+BOOST_AUTO_TEST_CASE(open_run_stays_contiguous)
+{
+  TPArena arena(8);
+  std::vector<TriggerPrimitive> tps = make_tps(12, 100);
+
+  for (size_t idx = 0; idx < 5; ++idx)
+    arena.push(tps[idx]);
+  TPSlice first = arena.take_run();
+
+  // Dropped: the next run reuses its room.
+  arena.push(tps[5]);
+  arena.drop_run();
+  BOOST_TEST(arena.run().empty());
+
+  // Outgrows the room left, so is moved to a new block.
+  for (size_t idx = 5; idx < 12; ++idx)
+    arena.push(tps[idx]);
+  BOOST_TEST(arena.run().size() == 7u);
+  BOOST_TEST(arena.n_blocks() == 2u);
+  BOOST_TEST(arena.n_moved() == 3u);
+  TPSlice second = arena.take_run();
+
+  BOOST_REQUIRE_EQUAL(first.size(), 5u);
+  BOOST_REQUIRE_EQUAL(second.size(), 7u);
+  for (size_t idx = 0; idx < 5; ++idx)
+    BOOST_TEST(first[idx].time_start == tps[idx].time_start);
+  for (size_t idx = 0; idx < 7; ++idx)
+    BOOST_TEST(second[idx].time_start == tps[5 + idx].time_start);
+}
+
+BOOST_AUTO_TEST_CASE(channel_distance_sliced_matches_vectors)
+{
+  // Bursts of nearby channels, well separated in time, with a far channel
+  // in each that the window skips.
+  std::vector<TriggerPrimitive> tps;
+  for (size_t burst = 0; burst < 10; ++burst) {
+    for (size_t idx = 0; idx < 30; ++idx) {
+      TriggerPrimitive tp;
+      tp.time_start = 1'000'000 + burst * 20'000 + idx * 100;
+      tp.channel = idx % 7 == 6 ? 2000 : 100 + (idx * 13) % 60;
+      tp.adc_integral = 100 + idx;
+      tp.adc_peak = 10 + idx % 5;
+      tp.time_peak = tp.time_start + 10;
+      tps.push_back(tp);
+    }
+  }
+
+  // A small arena block makes the open windows move between blocks.
+  nlohmann::json config = { { "min_tps", 10 }, { "arena_block_size", 64 } };
+  TAMakerChannelDistanceAlgorithm vector_maker;
+  TAMakerChannelDistanceAlgorithm sliced_maker;
+  vector_maker.configure(config);
+  sliced_maker.configure(config);
+
+  std::vector<TriggerActivity> vector_tas;
+  std::vector<SlicedTriggerActivity> sliced_tas;
+  vector_maker.process_batch(tps, vector_tas);
+  sliced_maker.process_batch_sliced(tps, sliced_tas);
+  vector_maker.flush(tps.back().time_start + 10'000, vector_tas);
+  sliced_maker.flush_sliced(tps.back().time_start + 10'000, sliced_tas);
+
+  BOOST_TEST(sliced_maker.tp_arena().n_moved() > 0u);
+  BOOST_REQUIRE_EQUAL(vector_tas.size(), 10u);
+  BOOST_REQUIRE_EQUAL(sliced_tas.size(), vector_tas.size());
+  for (size_t idx = 0; idx < vector_tas.size(); ++idx) {
+    TriggerActivity converted = sliced_tas[idx].to_trigger_activity();
+    BOOST_TEST(converted.time_start == vector_tas[idx].time_start);
+    BOOST_TEST(converted.time_end == vector_tas[idx].time_end);
+    BOOST_TEST(converted.adc_integral == vector_tas[idx].adc_integral);
+    BOOST_TEST(converted.channel_peak == vector_tas[idx].channel_peak);
+    BOOST_REQUIRE_EQUAL(converted.inputs.size(), vector_tas[idx].inputs.size());
+    for (size_t tp_idx = 0; tp_idx < converted.inputs.size(); ++tp_idx)
+      BOOST_TEST(converted.inputs[tp_idx].time_start == vector_tas[idx].inputs[tp_idx].time_start);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sliced_ta_converts_on_demand)
+{
+  TPArena arena;
+  std::vector<TriggerPrimitive> tps = make_tps(5, 1000);
+
+  SlicedTriggerActivity sliced;
+  sliced.time_start = 1000;
+  sliced.time_end = 1004;
+  sliced.adc_integral = 100;
+  sliced.inputs = arena.append(tps);
+
+  TriggerActivity ta = sliced.to_trigger_activity();
+  BOOST_TEST(ta.time_start == 1000u);
+  BOOST_TEST(ta.adc_integral == 100u);
+  BOOST_REQUIRE_EQUAL(ta.inputs.size(), 5u);
+  BOOST_TEST(ta.inputs[4].channel == 4);
+
+  std::vector<char> buffer(get_overlay_nbytes(sliced));
+  write_overlay(sliced, buffer.data());
+  TriggerActivity read = read_overlay_from_buffer<TriggerActivity>(buffer.data());
+  BOOST_TEST(read.time_end == 1004u);
+  BOOST_REQUIRE_EQUAL(read.inputs.size(), 5u);
+  BOOST_TEST(read.inputs[3].time_start == 1003u);
+}
+
+} // namespace triggeralgs
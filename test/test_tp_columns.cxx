@@ -0,0 +1,137 @@
+/**
+ * @file test_tp_columns.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_tp_columns
+
+#include "triggeralgs/SlidingWindow.hpp"
+#include "triggeralgs/TPColumns.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+TriggerPrimitive
+random_tp(std::mt19937_64& rng, timestamp_t time_start)
+{
+  TriggerPrimitive tp;
+  tp.time_start = time_start;
+  tp.time_over_threshold = rng() % 100;
+  tp.time_peak = time_start + tp.time_over_threshold / 2;
+  tp.channel = static_cast<channel_t>(rng() % 3000) - 100;
+  tp.adc_integral = rng() % 100000;
+  // Few distinct peaks, so that the first of equal peaks is exercised
+  tp.adc_peak = rng() % 16;
+  return tp;
+}
+
+void
+check_equal(const TPReduction& reduction, const TPReduction& expected)
+{
+  BOOST_TEST(reduction.time_start_min == expected.time_start_min);
+  BOOST_TEST(reduction.time_start_max == expected.time_start_max);
+  BOOST_TEST(reduction.time_end_max == expected.time_end_max);
+  BOOST_TEST(reduction.channel_min == expected.channel_min);
+  BOOST_TEST(reduction.channel_max == expected.channel_max);
+  BOOST_TEST(reduction.adc_integral == expected.adc_integral);
+  BOOST_TEST(reduction.adc_peak == expected.adc_peak);
+  BOOST_TEST(reduction.peak_index == expected.peak_index);
+}
+
+// Reduction of the TPs, written out as the makers used to
+TPReduction
+reference_reduction(const std::vector<TriggerPrimitive>& tps)
+{
+  TPReduction reduction;
+  for (size_t idx = 0; idx < tps.size(); ++idx) {
+    reduction.time_start_min = std::min(reduction.time_start_min, tps[idx].time_start);
+    reduction.time_start_max = std::max(reduction.time_start_max, tps[idx].time_start);
+    reduction.time_end_max = std::max(reduction.time_end_max, tps[idx].time_start + tps[idx].time_over_threshold);
+    reduction.channel_min = std::min(reduction.channel_min, tps[idx].channel);
+    reduction.channel_max = std::max(reduction.channel_max, tps[idx].channel);
+    reduction.adc_integral += tps[idx].adc_integral;
+    if (tps[idx].adc_peak > reduction.adc_peak) {
+      reduction.adc_peak = tps[idx].adc_peak;
+      reduction.peak_index = idx;
+    }
+  }
+  return reduction;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(reductions_match_reference)
+{
+  std::mt19937_64 rng(17);
+  // Every tail length, around and beyond a block of 8
+  for (size_t n_tps = 0; n_tps < 100; ++n_tps) {
+    std::vector<TriggerPrimitive> tps;
+    TPColumns columns;
+    for (size_t idx = 0; idx < n_tps; ++idx) {
+      tps.push_back(random_tp(rng, 1000 + rng() % 5000));
+      columns.push_back(tps.back());
+    }
+    TPReduction expected = reference_reduction(tps);
+    check_equal(reduce(columns), expected);
+    check_equal(reduce(tps), expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(times_above_63_bits)
+{
+  // The vector path compares 64-bit times as unsigned
+  std::mt19937_64 rng(5);
+  std::vector<TriggerPrimitive> tps;
+  TPColumns columns;
+  for (size_t idx = 0; idx < 37; ++idx) {
+    timestamp_t time_start = (idx % 2 ? std::numeric_limits<timestamp_t>::max() - 1000 : 0) + rng() % 500;
+    tps.push_back(random_tp(rng, time_start));
+    columns.push_back(tps.back());
+  }
+  TPReduction reduction = reduce(columns);
+  check_equal(reduction, reference_reduction(tps));
+  BOOST_TEST(reduction.time_start_min < 500u);
+  BOOST_TEST(reduction.time_start_max > std::numeric_limits<timestamp_t>::max() - 1000);
+}
+
+BOOST_AUTO_TEST_CASE(window_columns_follow_inputs)
+{
+  using Window = SlidingWindow<TriggerPrimitive, window_stats::Columns>;
+  std::mt19937_64 rng(23);
+  Window window;
+  timestamp_t time = 10000;
+  for (size_t idx = 0; idx < 2000; ++idx) {
+    time += rng() % 30;
+    // Now and then a TP that is late by up to 100 ticks
+    timestamp_t time_start = rng() % 10 == 0 ? time - rng() % 100 : time;
+    window.move(random_tp(rng, time_start), 500);
+
+    const TPColumns& columns = window.tp_columns;
+    BOOST_REQUIRE(columns.size() == window.inputs.size());
+    for (size_t position = 0; position < columns.size(); ++position) {
+      BOOST_REQUIRE(columns.time_start()[position] == window.inputs[position].time_start);
+      BOOST_REQUIRE(columns.channel()[position] == window.inputs[position].channel);
+      BOOST_REQUIRE(columns.adc_peak()[position] == window.inputs[position].adc_peak);
+    }
+    std::vector<TriggerPrimitive> tps(window.inputs.begin(), window.inputs.end());
+    check_equal(reduce(columns), reference_reduction(tps));
+  }
+
+  std::vector<TriggerPrimitive> taken;
+  window.take_inputs(taken);
+  BOOST_TEST(window.tp_columns.empty());
+}
+
+} // namespace triggeralgs
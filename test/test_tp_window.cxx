@@ -0,0 +1,196 @@
+/**
+ * @file test_tp_window.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_tp_window
+
+#include "triggeralgs/ChannelOccupancy.hpp"
+#include "triggeralgs/TPWindow.hpp"
+#include "triggeralgs/WindowBuffer.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <random>
+#include <set>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+// The window as it was computed before: a vector erased from the front
+struct ReferenceWindow
+{
+  void reset(const TriggerPrimitive& input_tp)
+  {
+    inputs.assign(1, input_tp);
+    time_start = input_tp.time_start;
+  }
+
+  void move(const TriggerPrimitive& input_tp, timestamp_t window_length)
+  {
+    size_t n_erase = 0;
+    while (n_erase < inputs.size() && input_tp.time_start - inputs[n_erase].time_start >= window_length)
+      ++n_erase;
+    inputs.erase(inputs.begin(), inputs.begin() + n_erase);
+    if (inputs.empty()) {
+      reset(input_tp);
+    } else {
+      time_start = inputs.front().time_start;
+      inputs.push_back(input_tp);
+    }
+  }
+
+  uint32_t adc_integral() const
+  {
+    uint32_t adc = 0;
+    for (const TriggerPrimitive& tp : inputs)
+      adc += tp.adc_integral;
+    return adc;
+  }
+
+  size_t n_channels_hit() const
+  {
+    std::set<channel_t> channels;
+    for (const TriggerPrimitive& tp : inputs)
+      channels.insert(tp.channel);
+    return channels.size();
+  }
+
+  timestamp_t time_start = 0;
+  std::vector<TriggerPrimitive> inputs;
+};
+
+void
+check_same(const TPWindow& window, const ReferenceWindow& reference)
+{
+  BOOST_REQUIRE(window.inputs.size() == reference.inputs.size());
+  BOOST_TEST(window.time_start == reference.time_start);
+  BOOST_TEST(window.adc_integral == reference.adc_integral());
+  BOOST_TEST(window.n_channels_hit() == reference.n_channels_hit());
+  for (size_t idx = 0; idx < reference.inputs.size(); ++idx)
+    BOOST_TEST(window.inputs[idx].time_start == reference.inputs[idx].time_start);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(window_buffer_expiry)
+{
+  WindowBuffer<int> buffer;
+  for (int value = 0; value < 10; ++value)
+    buffer.push_back(value);
+
+  buffer.pop_front(3);
+  BOOST_TEST(buffer.size() == 7u);
+  BOOST_TEST(buffer.front() == 3);
+  BOOST_TEST(buffer.back() == 9);
+  BOOST_TEST(buffer[1] == 4);
+
+  // Expired values outnumber the live ones: the buffer is compacted
+  buffer.pop_front(4);
+  BOOST_TEST(buffer.storage() == (std::vector<int>{ 7, 8, 9 }));
+
+  buffer.pop_front(1);
+  std::vector<int> taken;
+  taken.swap(buffer.storage());
+  BOOST_TEST(taken == (std::vector<int>{ 8, 9 }));
+  BOOST_TEST(buffer.empty());
+
+  buffer.push_back(42);
+  buffer.pop_front();
+  BOOST_TEST(buffer.empty());
+  BOOST_TEST((buffer.begin() == buffer.end()));
+}
+
+BOOST_AUTO_TEST_CASE(channel_occupancy_counts)
+{
+  ChannelOccupancy occupancy;
+  occupancy.set_range(100, 10);
+  occupancy.add(100);
+  occupancy.add(100);
+  occupancy.add(109);
+  BOOST_TEST(occupancy.n_channels_hit() == 2u);
+  BOOST_TEST(occupancy.count(100) == 2);
+
+  // Channels outside the range grow it, keeping the counts
+  occupancy.add(5);
+  occupancy.add(1000);
+  BOOST_TEST(occupancy.first_channel() <= 5);
+  BOOST_TEST(occupancy.first_channel() + static_cast<channel_t>(occupancy.n_channels()) > 1000);
+  BOOST_TEST(occupancy.n_channels_hit() == 4u);
+  BOOST_TEST(occupancy.count(100) == 2);
+  BOOST_TEST(occupancy.count(109) == 1);
+
+  occupancy.remove(100);
+  BOOST_TEST(occupancy.n_channels_hit() == 4u);
+  occupancy.remove(100);
+  occupancy.remove(5);
+  BOOST_TEST(occupancy.n_channels_hit() == 2u);
+  BOOST_TEST(occupancy.count(100) == 0);
+  BOOST_TEST(occupancy.count(-50000) == 0);
+
+  occupancy.clear();
+  BOOST_TEST(occupancy.n_channels_hit() == 0u);
+  BOOST_TEST(occupancy.count(1000) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(take_inputs_empties_the_window)
+{
+  TPWindow window;
+  window.set_channel_range(0, 16);
+  TriggerPrimitive tp;
+  tp.time_start = 100;
+  tp.channel = 3;
+  window.reset(tp);
+  tp.channel = 4;
+  window.add(tp);
+  BOOST_TEST(window.n_channels_hit() == 2);
+
+  std::vector<TriggerPrimitive> taken;
+  window.take_inputs(taken);
+  BOOST_TEST(taken.size() == 2u);
+  BOOST_TEST(window.is_empty());
+  BOOST_TEST(window.n_channels_hit() == 0);
+
+  window.reset(tp);
+  BOOST_TEST(window.n_channels_hit() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(move_matches_reference)
+{
+  constexpr timestamp_t window_length = 500;
+  std::mt19937 rng(7);
+
+  TPWindow window;
+  ReferenceWindow reference;
+  timestamp_t time = 10000;
+  for (size_t idx = 0; idx < 5000; ++idx) {
+    // Dense stretches, and gaps emptying the window now and then
+    time += rng() % 100 == 0 ? 1000 : rng() % 20;
+    TriggerPrimitive tp;
+    tp.time_start = time;
+    tp.channel = rng() % 32;
+    tp.adc_integral = 1 + rng() % 1000;
+
+    if (window.is_empty()) {
+      window.reset(tp);
+      reference.reset(tp);
+    } else if (rng() % 500 == 0) {
+      window.clear();
+      reference.inputs.clear();
+      BOOST_TEST(window.n_channels_hit() == 0);
+      continue;
+    } else {
+      window.move(tp, window_length);
+      reference.move(tp, window_length);
+    }
+    check_same(window, reference);
+  }
+}
+
+} // namespace triggeralgs
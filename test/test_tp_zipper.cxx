@@ -0,0 +1,147 @@
+/**
+ * @file test_tp_zipper.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_tp_zipper
+
+#include "triggeralgs/TPZipper.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+TriggerPrimitive
+make_tp(timestamp_t time_start, channel_t channel = 0)
+{
+  TriggerPrimitive tp;
+  tp.time_start = time_start;
+  tp.channel = channel;
+  return tp;
+}
+
+bool
+is_time_ordered(const std::vector<TriggerPrimitive>& tps)
+{
+  return std::is_sorted(
+    tps.begin(), tps.end(), [](const TriggerPrimitive& a, const TriggerPrimitive& b) { return a.time_start < b.time_start; });
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(merges_links_in_time_order)
+{
+  constexpr size_t n_links = 8;
+  TPZipper zipper(n_links);
+  zipper.configure({ { "max_lateness", 1'000'000 } });
+
+  std::mt19937 rng(42);
+  std::vector<timestamp_t> link_time(n_links, 1000);
+  std::vector<TriggerPrimitive> output_tps;
+  size_t n_added = 0;
+  for (size_t idx = 0; idx < 100000; ++idx) {
+    size_t link = rng() % n_links;
+    link_time[link] += rng() % 50;
+    zipper.add(link, make_tp(link_time[link], link));
+    ++n_added;
+    if (idx % 100 == 0)
+      zipper.drain(output_tps);
+  }
+  zipper.drain(output_tps);
+  BOOST_TEST(output_tps.size() + zipper.n_buffered() == n_added);
+  zipper.flush(output_tps);
+
+  BOOST_TEST(output_tps.size() == n_added);
+  BOOST_TEST(is_time_ordered(output_tps));
+  BOOST_TEST(zipper.stats().n_dropped == 0u);
+  BOOST_TEST(zipper.stats().n_forced == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(waits_for_every_link)
+{
+  TPZipper zipper(2);
+  std::vector<TriggerPrimitive> output_tps;
+
+  zipper.add(0, make_tp(100));
+  zipper.add(0, make_tp(200));
+  zipper.drain(output_tps);
+  BOOST_TEST(output_tps.empty());
+
+  // Link 1 has reached 150: the TP at 200 has to wait
+  zipper.add(1, make_tp(150));
+  zipper.drain(output_tps);
+  BOOST_REQUIRE(output_tps.size() == 2u);
+  BOOST_TEST(output_tps[0].time_start == 100u);
+  BOOST_TEST(output_tps[1].time_start == 150u);
+
+  // A heartbeat lets the rest out
+  zipper.heartbeat(1, 300);
+  zipper.drain(output_tps);
+  BOOST_REQUIRE(output_tps.size() == 3u);
+  BOOST_TEST(output_tps[2].time_start == 200u);
+}
+
+BOOST_AUTO_TEST_CASE(max_lateness_and_drops)
+{
+  TPZipper zipper(2);
+  zipper.configure({ { "max_lateness", 1000 } });
+  std::vector<TriggerPrimitive> output_tps;
+
+  // Link 1 is quiet: TPs of link 0 go out once more than 1000 ticks behind
+  zipper.add(0, make_tp(100));
+  zipper.add(0, make_tp(1100));
+  zipper.drain(output_tps);
+  BOOST_TEST(output_tps.empty());
+  zipper.add(0, make_tp(1101));
+  zipper.drain(output_tps);
+  BOOST_REQUIRE(output_tps.size() == 1u);
+  BOOST_TEST(zipper.stats().n_forced == 1u);
+
+  // Link 1 then sends a TP earlier than what was output: it is dropped
+  BOOST_TEST(!zipper.add(1, make_tp(50)));
+  BOOST_TEST(zipper.stats().n_dropped == 1u);
+  BOOST_TEST(zipper.add(1, make_tp(1200)));
+}
+
+BOOST_AUTO_TEST_CASE(late_tps_within_a_link_are_reordered)
+{
+  TPZipper zipper(1);
+  std::vector<TriggerPrimitive> output_tps;
+
+  for (timestamp_t time : { 10, 30, 20, 5, 40 })
+    zipper.add(0, make_tp(time));
+  BOOST_TEST(zipper.stats().n_late == 2u);
+
+  zipper.drain(output_tps);
+  BOOST_REQUIRE(output_tps.size() == 5u);
+  BOOST_TEST(is_time_ordered(output_tps));
+  BOOST_TEST(output_tps.front().time_start == 5u);
+}
+
+BOOST_AUTO_TEST_CASE(flush_on_timeout)
+{
+  TPZipper zipper(2);
+  zipper.configure({ { "timeout_ms", 10 } });
+  std::vector<TriggerPrimitive> output_tps;
+
+  zipper.add(0, make_tp(100));
+  auto now = std::chrono::steady_clock::now();
+  BOOST_TEST(!zipper.flush_on_timeout(output_tps, now));
+  BOOST_TEST(!zipper.flush_on_timeout(output_tps, now + std::chrono::milliseconds(5)));
+  BOOST_TEST(zipper.flush_on_timeout(output_tps, now + std::chrono::milliseconds(10)));
+  BOOST_TEST(output_tps.size() == 1u);
+  BOOST_TEST(zipper.stats().n_timeouts == 1u);
+}
+
+} // namespace triggeralgs
@@ -0,0 +1,214 @@
+/**
+ * @file test_trigger_pipeline.cxx
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+// NOLINTNEXTLINE(build/define_used)
+#define BOOST_TEST_MODULE test_trigger_pipeline
+
+#include "triggeralgs/TriggerActivityFactory.hpp"
+#include "triggeralgs/TriggerCandidateFactory.hpp"
+#include "triggeralgs/TriggerDecisionFactory.hpp"
+#include "triggeralgs/TriggerPipeline.hpp"
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace triggeralgs {
+
+namespace {
+
+const nlohmann::json ta_config = { { "window_length", 2000 }, { "adc_threshold", 30000 } };
+
+std::vector<TriggerPrimitive>
+make_tps(size_t n_tps)
+{
+  std::mt19937 rng(42);
+  std::vector<TriggerPrimitive> tps(n_tps);
+  timestamp_t time = 100000;
+  for (TriggerPrimitive& tp : tps) {
+    time += 1 + rng() % 10;
+    tp.time_start = time;
+    tp.channel = rng() % 2560;
+    tp.adc_integral = 50 + rng() % 200;
+  }
+  return tps;
+}
+
+// The same chain run serially on the calling thread
+std::vector<TriggerDecision>
+run_serially(const std::vector<TriggerPrimitive>& tps, size_t block_size)
+{
+  auto ta_maker = TriggerActivityFactory::get_instance()->build_maker("TAMakerADCSimpleWindowAlgorithm");
+  auto tc_maker = TriggerCandidateFactory::get_instance()->build_maker("TCMakerADCSimpleWindowAlgorithm");
+  auto td_maker = TriggerDecisionFactory::get_instance()->build_maker("TDMakerSupernovaAlgorithm");
+  ta_maker->configure(ta_config);
+
+  std::vector<TriggerActivity> tas;
+  for (size_t first = 0; first < tps.size(); first += block_size) {
+    std::vector<TriggerActivity> block_tas;
+    ta_maker->process_batch(
+      span<const TriggerPrimitive>(tps.data() + first, std::min(block_size, tps.size() - first)), block_tas);
+    std::move(block_tas.begin(), block_tas.end(), std::back_inserter(tas));
+  }
+  ta_maker->flush(std::numeric_limits<timestamp_t>::max(), tas);
+
+  std::vector<TriggerCandidate> tcs;
+  for (const TriggerActivity& ta : tas) {
+    std::vector<TriggerCandidate> made;
+    (*tc_maker)(ta, made);
+    std::move(made.begin(), made.end(), std::back_inserter(tcs));
+  }
+  tc_maker->flush(std::numeric_limits<timestamp_t>::max(), tcs);
+
+  std::vector<TriggerDecision> tds;
+  for (const TriggerCandidate& tc : tcs)
+    (*td_maker)(tc, tds);
+  td_maker->flush(tds);
+  return tds;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(same_output_as_serial_chain)
+{
+  constexpr size_t block_size = 500;
+  std::vector<TriggerPrimitive> tps = make_tps(200000);
+
+  TriggerPipeline pipeline;
+  // Small queues, so the stages do get held back
+  pipeline.configure({ { "ta_algorithm", "TAMakerADCSimpleWindowAlgorithm" },
+                       { "tc_algorithm", "TCMakerADCSimpleWindowAlgorithm" },
+                       { "ta_config", ta_config },
+                       { "queue_size", 2 } });
+
+  std::vector<TriggerDecision> tds;
+  for (size_t first = 0; first < tps.size(); first += block_size) {
+    pipeline.push(span<const TriggerPrimitive>(tps.data() + first, std::min(block_size, tps.size() - first)));
+    if (first % (10 * block_size) == 0)
+      pipeline.drain(tds);
+  }
+  pipeline.stop(tds);
+
+  std::vector<TriggerDecision> reference = run_serially(tps, block_size);
+  BOOST_TEST(!reference.empty());
+  BOOST_REQUIRE(tds.size() == reference.size());
+  for (size_t idx = 0; idx < tds.size(); ++idx) {
+    BOOST_TEST(tds[idx].time_start == reference[idx].time_start);
+    BOOST_TEST(tds[idx].time_end == reference[idx].time_end);
+  }
+
+  auto stats = pipeline.stats();
+  BOOST_TEST(stats.n_tps == tps.size());
+  BOOST_TEST(stats.n_tds == tds.size());
+  BOOST_TEST(stats.n_tas >= stats.n_tcs);
+}
+
+BOOST_AUTO_TEST_CASE(heartbeat_flushes_the_stages)
+{
+  TriggerPipeline pipeline;
+  pipeline.configure({ { "ta_algorithm", "TAMakerADCSimpleWindowAlgorithm" },
+                       { "tc_algorithm", "TCMakerADCSimpleWindowAlgorithm" },
+                       { "ta_config", ta_config } });
+
+  // One window over threshold, which only closes on a later TP or a flush
+  std::vector<TriggerPrimitive> tps(10);
+  for (size_t idx = 0; idx < tps.size(); ++idx) {
+    tps[idx].time_start = 1000 + idx;
+    tps[idx].adc_integral = 5000;
+  }
+  pipeline.push(tps);
+
+  std::vector<TriggerDecision> tds;
+  pipeline.heartbeat(10000);
+  for (int attempt = 0; attempt < 100000 && tds.empty(); ++attempt) {
+    std::this_thread::yield();
+    pipeline.drain(tds);
+  }
+  BOOST_REQUIRE(tds.size() == 1u);
+  BOOST_TEST(tds[0].time_start == 1000u);
+
+  pipeline.stop(tds);
+  BOOST_TEST(tds.size() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(consumed_objects_go_back_to_their_maker)
+{
+  // One batch in flight per stage, so the TA stage makes most of its TAs
+  // after the TC stage gave earlier ones back
+  TriggerPipeline pipeline;
+  pipeline.configure({ { "ta_algorithm", "TAMakerPrescaleAlgorithm" },
+                       { "tc_algorithm", "TCMakerPrescaleAlgorithm" },
+                       { "queue_size", 1 } });
+  std::vector<TriggerPrimitive> tps = make_tps(1000);
+  for (size_t first = 0; first < tps.size(); first += 10)
+    pipeline.push(span<const TriggerPrimitive>(tps.data() + first, 10));
+  std::vector<TriggerDecision> tds;
+  pipeline.stop(tds);
+
+  auto stats = pipeline.stats();
+  BOOST_TEST(stats.n_tas == tps.size());
+  BOOST_TEST(stats.n_ta_reused > 0u);
+}
+
+BOOST_AUTO_TEST_CASE(idle_stages_sleep)
+{
+  TriggerPipeline pipeline;
+  pipeline.configure({ { "ta_algorithm", "TAMakerPrescaleAlgorithm" }, { "tc_algorithm", "TCMakerPrescaleAlgorithm" } });
+
+  // Process CPU time: three spinning stages would use about three times the wall time
+  std::clock_t cpu_start = std::clock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  double cpu_seconds = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  BOOST_TEST(cpu_seconds < 0.05);
+
+  // And they still wake up for the end of the input
+  std::vector<TriggerPrimitive> tps = make_tps(100);
+  pipeline.push(tps);
+  std::vector<TriggerDecision> tds;
+  pipeline.stop(tds);
+  BOOST_TEST(pipeline.stats().n_tas == tps.size());
+}
+
+BOOST_AUTO_TEST_CASE(try_push_and_bad_configuration)
+{
+  TriggerPipeline pipeline;
+  std::vector<TriggerPrimitive> tps = make_tps(100);
+  // Nothing runs the stages yet
+  BOOST_CHECK_THROW(pipeline.push(tps), BadConfiguration);
+  BOOST_CHECK_THROW(pipeline.try_push(tps), BadConfiguration);
+  BOOST_CHECK_THROW(pipeline.heartbeat(1000), BadConfiguration);
+
+  BOOST_CHECK_THROW(pipeline.configure({ { "ta_algorithm", "TAMakerPrescaleAlgorithm" } }), BadConfiguration);
+  // The stage threads build the makers: their errors reach the caller
+  BOOST_CHECK_THROW(pipeline.configure({ { "ta_algorithm", "TAMakerPrescaleAlgorithm" },
+                                         { "tc_algorithm", "TCMakerNoSuchAlgorithm" } }),
+                    FactoryNotFound);
+
+  pipeline.configure({ { "ta_algorithm", "TAMakerPrescaleAlgorithm" },
+                       { "tc_algorithm", "TCMakerPrescaleAlgorithm" },
+                       { "queue_size", 1 } });
+  size_t n_taken = 0;
+  for (int idx = 0; idx < 100; ++idx)
+    n_taken += pipeline.try_push(tps);
+
+  std::vector<TriggerDecision> tds;
+  pipeline.stop(tds);
+  BOOST_TEST(pipeline.stats().n_tps == n_taken * tps.size());
+  BOOST_TEST(n_taken >= 1u);
+  // stop() may also have had to wait for room
+  BOOST_TEST(pipeline.stats().n_input_full >= 100 - n_taken);
+  BOOST_CHECK_THROW(pipeline.push(tps), BadConfiguration);
+}
+
+} // namespace triggeralgs